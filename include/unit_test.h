@@ -1,5 +1,8 @@
 #ifndef __UNIT_TEST_H
 #define __UNIT_TEST_H
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
 /*
 *   This unit_test.h header file is responsible for defining the 
 *   functions which will be implemented in unit_test.c. The purpose
@@ -46,14 +49,287 @@
 *   @author Brennan Hurst
 *   @version 10/07/2021
 */
+struct unit_test_shard;
+struct unit_test_sites;
+struct unit_test_stress_result;
+struct unit_test_differential_result;
+struct unit_test_benchmark_result;
+struct unit_test_histogram;
+struct unit_test_stream_result;
+struct unit_test_fixture;
+
+enum {
+    UNIT_TEST_STATUS_NOT_RUN,
+    UNIT_TEST_STATUS_PASSED,
+    UNIT_TEST_STATUS_FAILED,
+    UNIT_TEST_STATUS_ABORTED,
+    UNIT_TEST_STATUS_SKIPPED,
+    UNIT_TEST_STATUS_CRASHED,
+    UNIT_TEST_STATUS_OUT_OF_TIME,
+    UNIT_TEST_STATUS_FILTERED
+};
+
 struct unit_test {
     char* name;
-    int num_passed;
-    int num_failed;
+    long long num_passed;
+    long long num_failed;
+    int status;
+    int owner;
+    struct unit_test_shard *shards;
+    struct unit_test_sites *sites;
+    struct unit_test_stress_result *stress;
+    struct unit_test_fixture **fixtures;
+    int fixture_count;
+    void (*start)();
+    void (*print)();
+    int tier;
+    const char *tags;
+    double cost;
+    double duration;
+    unsigned int recent_failures;
+    struct unit_test_differential_result *differentials;
+    struct unit_test_benchmark_result *benchmarks;
+    const char **files;
+    int file_count;
+    struct unit_test_histogram *histograms;
+    struct unit_test_stream_result *streams;
+};
+
+/*
+*   The unit_test_run struct configures a call to unit_test_run_all. Every
+*   field may be left as 0 or NULL.
+*
+*   budget - time budget in seconds, or 0 for no budget.
+*   max_tier - highest tier to run, or 0 to run every tier.
+*   tags - comma separated tags; only tests with one of them are run.
+*   history - file recording past run times and failures of each test.
+*   jobs - number of tests to run at once in worker processes, or 0 or 1
+*       to run them one at a time.
+*   trace - file to write a timeline of the run to, as with
+*       unit_test_set_trace, or NULL.
+*   watch - comma separated directories for unit_test_watch to watch.
+*   journal - file to record each finished test in, or NULL.
+*   resume - if non-zero, tests already recorded in the journal are not
+*       run again, and keep their recorded results.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_run {
+    double budget;
+    int max_tier;
+    const char *tags;
+    const char *history;
+    int jobs;
+    const char *trace;
+    const char *watch;
+    const char *journal;
+    int resume;
+};
+
+/*
+*   The unit_test_repeat struct configures a call to unit_test_repeat.
+*
+*   iterations - the most times to run the test; must be positive.
+*   until_failure - if non-zero, stops once an iteration has failed and
+*       every iteration before it has finished.
+*   jobs - number of worker processes running iterations at once, or 0 or
+*       1 for one.
+*   seed - base seed, mixed with the iteration number to give each
+*       iteration's seed.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_repeat {
+    long iterations;
+    int until_failure;
+    int jobs;
+    unsigned long long seed;
+};
+
+/*
+*   The unit_test_mock struct records the calls made to a mock. calls
+*   counts every call, and ring holds the arguments of the last capacity
+*   of them, the call numbered n in slot n % capacity. result is returned
+*   from each call. first_sequence orders the first calls of all mocks.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+#define UNIT_TEST_MOCK_ARGS 4
+
+struct unit_test_mock_call {
+    long long args[UNIT_TEST_MOCK_ARGS];
+};
+
+struct unit_test_mock {
+    const char *name;
+    long long calls;
+    long long result;
+    unsigned long long first_sequence;
+    int capacity;
+    struct unit_test_mock_call *ring;
+};
+
+/*
+*   The unit_test_differential struct configures a call to
+*   unit_test_assert_differential. Each input is an array of input_length
+*   elements of type input_type, and each output an array of output_length
+*   elements of type output_type, where the types are UNIT_TEST_ELEMENT_*.
+*
+*   name - name of the function being checked, printed in the summary.
+*   generate - fills in input number index, which must depend only on
+*       index and seed.
+*   reference - the simple implementation. It is given count inputs laid
+*       out one after another and writes count outputs the same way.
+*   candidate - the optimized implementation, called the same way.
+*   count - total number of inputs to check.
+*   batch - inputs per call to reference and candidate, or 0 for 4096.
+*   tolerance - for float and double outputs, the largest difference
+*       allowed relative to the larger of the two values, or 0 to require
+*       them to be equal.
+*   seed - passed to generate.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+enum {
+    UNIT_TEST_ELEMENT_CHAR,
+    UNIT_TEST_ELEMENT_INT,
+    UNIT_TEST_ELEMENT_LONG,
+    UNIT_TEST_ELEMENT_FLOAT,
+    UNIT_TEST_ELEMENT_DOUBLE
+};
+
+struct unit_test_differential {
+    const char *name;
+    int input_type;
+    size_t input_length;
+    int output_type;
+    size_t output_length;
+    void (*generate)(void *input, long long index, unsigned long long seed);
+    void (*reference)(const void *inputs, void *outputs, size_t count);
+    void (*candidate)(const void *inputs, void *outputs, size_t count);
+    long long count;
+    size_t batch;
+    double tolerance;
+    unsigned long long seed;
+};
+
+/*
+*   The unit_test_stream struct is one side of a call to
+*   unit_test_assert_stream_equals: a source of bytes read a chunk at a
+*   time. Make one with unit_test_stream_file, unit_test_stream_fd or
+*   unit_test_stream_callback.
+*
+*   name - name of the stream, printed by failed assertions.
+*   read - fills buffer with up to size bytes from source and returns how
+*       many it wrote, 0 at the end, or -1 with errno set on an error.
+*   source - passed to read.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_stream {
+    const char *name;
+    long long (*read)(void *source, void *buffer, size_t size);
+    void *source;
+};
+
+/*
+*   The unit_test_fixture struct holds an expensive piece of setup which
+*   is shared between the tests that declare it. It is built the first
+*   time one of them asks for it and torn down after the last of them
+*   finishes. build_time is the total time spent in setup.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+enum {
+    UNIT_TEST_FIXTURE_UNBUILT,
+    UNIT_TEST_FIXTURE_BUILDING,
+    UNIT_TEST_FIXTURE_BUILT
+};
+
+struct unit_test_fixture {
+    char *name;
+    void *(*setup)();
+    void (*teardown)(void *data);
+    void *data;
+    int state;
+    int users;
+    int finished;
+    int builds;
+    double build_time;
+    const char *snapshot_path;
+    size_t snapshot_size;
+    void (*snapshot_build)(void *base, size_t size);
+    pthread_mutex_t lock;
+    pthread_cond_t built;
+};
+
+/*
+*   The unit_test_stress struct configures a call to unit_test_stress.
+*
+*   threads - number of threads to run the body on.
+*   iterations - iterations per thread, or 0 to run until duration expires.
+*   duration - time budget in seconds, or 0 for no budget.
+*   pin_threads - if non-zero, pins each thread to a distinct core.
+*   random_yields - if non-zero, threads yield at random between
+*       iterations to shake out more interleavings.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_stress {
+    int threads;
+    long iterations;
+    double duration;
+    int pin_threads;
+    int random_yields;
+};
+
+/*
+*   The unit_test_benchmark struct configures a call to unit_test_benchmark.
+*
+*   name - name of the benchmark, printed in the summary.
+*   samples - number of timed samples, or 0 for 30.
+*   iterations - calls of the body per sample, or 0 for 1.
+*   warmup - number of untimed samples to run first.
+*   pin_cpu - if non-zero, runs the benchmark on CPU cpu only.
+*   cpu - the CPU to pin to.
+*   cache - what to do to the caches before each sample:
+*       UNIT_TEST_CACHE_KEEP leaves them, UNIT_TEST_CACHE_FLUSH evicts
+*       everything from them, and UNIT_TEST_CACHE_WARM calls the body once
+*       untimed.
+*   max_cv - largest coefficient of variation of the samples for the
+*       measurement to count as stable, or 0 for 0.05 (5%).
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+enum {
+    UNIT_TEST_CACHE_KEEP,
+    UNIT_TEST_CACHE_FLUSH,
+    UNIT_TEST_CACHE_WARM
+};
+
+struct unit_test_benchmark {
+    const char *name;
+    int samples;
+    long iterations;
+    int warmup;
+    int pin_cpu;
+    int cpu;
+    int cache;
+    double max_cv;
 };
 
 extern struct unit_test **tests;
 extern int test_count;
+extern struct unit_test_fixture **fixtures;
+extern int fixture_count;
 /*
 *   This function initializes a new unit test with a given name.
 *   
@@ -66,6 +342,26 @@ extern int test_count;
 */
 struct unit_test* unit_test_init(char* name);
 
+/*
+*   This function folds the results of assertions made from threads other
+*   than the owning thread back into num_passed and num_failed, and prints
+*   any failures those threads recorded in the order they occurred. It is
+*   called by the summary functions, and only needs to be called directly
+*   when reading the counters of a multi-threaded test by hand.
+*
+*   Assertions are safe to make from any number of threads. The thread 
+*   which called unit_test_init (or unit_test_start) owns the test and 
+*   prints its results as they happen; other threads count into per-thread
+*   shards and only record their failures, which are printed when the test
+*   is merged.
+*
+*   @param *test - the unit_test you wish to merge.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_merge(struct unit_test *test);
+
 /*
 *   This function starts a unit test and is responsible for executing
 *   and printing out the unit test.
@@ -83,6 +379,494 @@ struct unit_test* unit_test_init(char* name);
 */
 void unit_test_start(struct unit_test *test, void (*start)(), void (*print)());
 
+/*
+*   This function turns asynchronous reporting on or off. While it is on,
+*   an assertion on the thread which owns its test only records a compact
+*   event, and a background thread formats the results and writes them to
+*   standard output in large batches. This keeps formatting and I/O off
+*   the test thread. Results are always flushed before a header or summary
+*   is printed, when the process exits, and when it is killed by a signal.
+*   Anything the test itself prints may come out ahead of results which
+*   have not been flushed yet.
+*
+*   @param enabled - non-zero to turn asynchronous reporting on.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_set_async_reporting(int enabled);
+
+/*
+*   This function turns bulk mode on or off. Bulk mode is meant for
+*   assertions inside loops over large amounts of data. While it is on,
+*   passing assertions are counted but not printed, and failures are
+*   grouped by the file and line they were made from. For each of those
+*   call sites only the first few failures are kept, along with a count of
+*   all of them, and they are printed once with the test's summary.
+*
+*   @param examples - number of failures to keep for each call site, or 0
+*       to turn bulk mode off.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_set_bulk_mode(int examples);
+
+/*
+*   This function configures fail-fast behaviour for unit_test_start and
+*   unit_test_start_forked. Both settings are off by default.
+*
+*   @param abort_suite - if non-zero, the first failed assertion in a test
+*       jumps straight back out of its start function, skipping the rest of
+*       the test. Only failures on the thread running the test abort it.
+*       The start function does not get a chance to clean up.
+*   @param max_failed_suites - if positive, once this many tests have
+*       failed every test started afterwards is skipped.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_set_fail_fast(int abort_suite, int max_failed_suites);
+
+/*
+*   This function turns in-process crash recovery on or off. It is off by
+*   default. While it is on, a SIGSEGV, SIGBUS, SIGFPE or SIGABRT raised on
+*   the thread running a test's start function jumps back to
+*   unit_test_start, which marks the test as crashed and lets the program
+*   carry on with the next test. The crash is reported along with the last
+*   assertion the thread made before it. This is much faster than running
+*   every test with unit_test_start_forked, but gives up its isolation:
+*   memory the crashed test corrupted, and any locks or resources it held,
+*   stay as they are. Crashes on other threads still end the program.
+*
+*   @param enabled - non-zero to turn crash recovery on.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_set_crash_recovery(int enabled);
+
+/*
+*   This function turns recording of a timeline of the run on or off. While
+*   it is on, the start and length of every test, fixture setup, stress run
+*   and death test, and the time, file and line of every failed assertion
+*   are recorded along with the thread they happened on. The timeline is
+*   written to a file in Chrome's trace event format, which can be opened
+*   in Perfetto (ui.perfetto.dev) or chrome://tracing, when the program
+*   exits or tracing is turned off.
+*
+*   Recording an event takes one atomic add and a few stores into a buffer
+*   shared with forked child processes, so tests run by
+*   unit_test_start_forked, parallel runs and repeated tests are recorded
+*   too. Names are recorded as pointers, so they must have existed before
+*   the child was forked. Parallel workers are shown as rows named
+*   "Worker 1", "Worker 2" and so on. The buffer holds about a million
+*   events; any beyond that are counted but not kept.
+*
+*   @param *path - the file to write the timeline to, or NULL to turn
+*       recording off and write the file for the current recording.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_set_trace(const char *path);
+
+/*
+*   This function creates a unit test which is run later by
+*   unit_test_run_all rather than straight away. It is placed in tier 1,
+*   has no tags and no cost estimate until unit_test_set_schedule is
+*   called.
+*
+*   @param *name - name of the unit test.
+*   @param start - the function which runs the test, as for unit_test_start.
+*   @param print - the summary function, or NULL, as for unit_test_start.
+*
+*   @return the new unit test.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test *unit_test_register(char *name, void (*start)(), void (*print)());
+
+/*
+*   This function sets how unit_test_run_all schedules a registered test.
+*
+*   @param *test - the unit test to schedule.
+*   @param tier - the test's tier, from 1 for the most important tests.
+*   @param *tags - comma separated tags, such as "db,slow", or NULL.
+*   @param cost - estimated run time in seconds, or 0 if unknown. Once the
+*       history file has timings for the test they are used instead.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_set_schedule(struct unit_test *test, int tier, const char *tags, double cost);
+
+/*
+*   This function runs every test made with unit_test_register which has
+*   not run yet. Tests can be limited to a tier and to tags. If a history
+*   file is given, the tests which failed most recently run first, then
+*   tests in lower tiers, then the cheapest ones, using the timings from
+*   earlier runs as their cost. With a time budget, a test is only started
+*   if its estimated cost fits in the time remaining; the tests which do
+*   not fit are listed as out of time by unit_test_print_total_summary.
+*   The history is updated with this run's timings and failures.
+*
+*   With more than one job, tests run in that many worker processes at
+*   once. If a history file is given they are started longest first, so
+*   the long tests are spread over the workers instead of one of them
+*   finishing last; without one they start in the order they were
+*   registered. The predicted and actual length of the run and how busy
+*   each worker was are printed at the end.
+*
+*   With a journal, each test's name, counts, status and duration are
+*   appended to it as soon as the test finishes. If the run is killed, a
+*   new run with resume set gives the tests recorded in the journal their
+*   recorded results instead of running them, so the total summary covers
+*   both halves, and carries on with the rest.
+*
+*   @param *options - the run's budget, filters, jobs and history file, or NULL
+*       to run every registered test in the order they were registered.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_run_all(struct unit_test_run *options);
+
+/*
+*   This function fills in a unit_test_run from command line arguments, so
+*   that a test program can be asked to run only part of its tests:
+*
+*       --budget=SECONDS   stop starting tests after this much time
+*       --tier=N           only run tests in tiers 1 to N
+*       --tags=a,b         only run tests with one of these tags
+*       --history=FILE     order tests by, and record, their history
+*       --jobs=N           run N tests at once
+*       --trace=FILE       write a timeline of the run to FILE
+*       --watch=DIRS       rerun affected tests when files in DIRS change
+*       --journal=FILE     record each finished test in FILE
+*       --resume           skip the tests already recorded in the journal
+*
+*   @param argc - argument count, as passed to main.
+*   @param **argv - arguments, as passed to main.
+*   @param *options - the options to fill in.
+*
+*   @return 0, or -1 after printing a usage message if an argument was not
+*       understood.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+int unit_test_parse_args(int argc, char **argv, struct unit_test_run *options);
+
+/*
+*   This function loads tests from a shared object, or from every shared
+*   object (file ending in .so) in a directory, into this process. Tests
+*   are registered in the same list as those made by unit_test_init and
+*   unit_test_register, so unit_test_run_all runs them and
+*   unit_test_print_total_summary reports them alongside every other test.
+*   This lets a whole project's tests run in one process, paying for
+*   process startup and dynamic linking once instead of once per test
+*   program.
+*
+*   A module registers its tests with unit_test_register, either from a
+*   function named unit_test_plugin, which is called once the module is
+*   loaded, or from a constructor. Modules are built with -shared -fPIC
+*   and leave the library's functions undefined, so that they use the copy
+*   the loading program is linked to; linking each one against its own
+*   copy would give it its own list of tests. Modules stay loaded until
+*   the process exits, since their tests are run after they are loaded.
+*
+*   @param *path - a shared object, or a directory of them.
+*
+*   @return the number of tests registered, or -1 if a module could not be
+*       loaded; the rest of a directory is still loaded.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+int unit_test_load_plugin(const char *path);
+
+/*
+*   This function runs the registered tests, then watches for changes and
+*   reruns the tests they affect, until the process is stopped. The
+*   directories given in options->watch (comma separated, not including
+*   their subdirectories), the directories of loaded test modules and the
+*   directory of the program itself are watched.
+*
+*   A changed source file is mapped to the tests whose assertions were
+*   made from a file of the same name, or whose file names contain its
+*   name, as test_parser.c does for parser.c. Source which cannot be
+*   mapped, such as a header, affects every test. The affected tests are
+*   rerun as soon as the code they are in is rebuilt. When a module loaded
+*   with unit_test_load_plugin is rebuilt, the new copy is loaded into this
+*   process, and fixtures stay built from one round to the next, since
+*   they are not torn down while watching. When the program itself is
+*   rebuilt it is restarted, and only runs the affected tests; the other
+*   tests keep their earlier results in the total summary. A rebuild with
+*   no changed source before it reruns everything it contains.
+*
+*   @param *options - the options to run the tests with, as for
+*       unit_test_run_all, with watch set.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_watch(struct unit_test_run *options);
+
+/*
+*   This function runs a test over and over to catch failures which only
+*   happen some of the time. It reuses the start and print functions the
+*   test was given by unit_test_start, unit_test_start_forked or
+*   unit_test_register, resetting num_passed and num_failed before every
+*   iteration. Iterations run in worker processes with their output thrown
+*   away; each gets its own seed, returned by unit_test_seed, which does
+*   not depend on the worker running it.
+*
+*   Afterwards the number of failing iterations is printed along with how
+*   often each assertion failed, and the first failing iteration is run
+*   again with its seed and its output shown, using
+*   unit_test_start_forked. The test's results are those of that iteration,
+*   or the totals over every iteration if none failed. An iteration which
+*   crashes its worker is counted as failing and a new worker carries on.
+*
+*   @param *test - the unit_test to repeat. It must have a start function.
+*   @param *options - the number of iterations, whether to stop at the
+*       first failure, the number of worker processes and the base seed.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_repeat(struct unit_test *test, struct unit_test_repeat *options);
+
+/*
+*   This function repeats every test which has a start function and has
+*   not been filtered out of a run, one after the other, with
+*   unit_test_repeat.
+*
+*   @param *options - the options passed to unit_test_repeat for each test.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_repeat_all(struct unit_test_repeat *options);
+
+/*
+*   This function returns the seed of the iteration being run by
+*   unit_test_repeat. Tests which make random choices should draw them from
+*   this seed so that a failing iteration can be run again exactly. Outside
+*   unit_test_repeat it returns the same fixed seed every time.
+*
+*   @return the current iteration's seed.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+unsigned long long unit_test_seed();
+
+/*
+*   This function creates a new fixture: shared setup which is built lazily
+*   the first time a test asks for it, shared read-only by every test which
+*   declares it, and torn down once the last of those tests has finished.
+*   Setup time is reported separately in the total summary.
+*
+*   @param name - char* array representing the name of the fixture.
+*   @param void *(*setup)() - function pointer which builds the fixture and
+*       returns its data.
+*   @param void (*teardown)(void *data) - function pointer which releases
+*       the fixture's data. May be NULL.
+*   @returns unit_test_fixture* pointer representing the new fixture.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_fixture* unit_test_fixture_init(char *name, void *(*setup)(), void (*teardown)(void *data));
+
+/*
+*   This function creates a fixture whose data lives in a memory mapping
+*   rather than on the heap. It is meant for tests run with
+*   unit_test_start_forked: the fixture is built once in the parent, and
+*   every child maps it copy-on-write, so each child starts from pristine
+*   data however much the previous one scribbled over it.
+*
+*   If path is not NULL the snapshot is also saved to that file, and later
+*   runs map the file instead of building the data again. Data in a file
+*   snapshot may be mapped at a different address on each run, so it must
+*   refer to itself with offsets rather than pointers.
+*
+*   @param name - char* array representing the name of the fixture.
+*   @param *path - file to keep the snapshot in, or NULL for none.
+*   @param size - number of bytes of data in the snapshot.
+*   @param void (*build)(void *base, size_t size) - function pointer which
+*       fills in the data at base.
+*   @returns unit_test_fixture* pointer representing the new fixture.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_fixture* unit_test_fixture_init_snapshot(char *name, const char *path, size_t size,
+    void (*build)(void *base, size_t size));
+
+/*
+*   This function declares that a test uses a fixture. Declare every user
+*   of a fixture before running any of them, so the fixture is kept alive
+*   until the last one has finished.
+*
+*   @param *test - the unit_test which uses the fixture.
+*   @param *fixture - the fixture it uses.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_use_fixture(struct unit_test *test, struct unit_test_fixture *fixture);
+
+/*
+*   This function returns a fixture's data, building it first if no test
+*   has used it yet. It is safe to call from several threads at once: only
+*   one of them builds the fixture and the others wait for it. The returned
+*   data is shared and must be treated as read-only.
+*
+*   @param *test - the unit_test asking for the fixture. It should have
+*       declared the fixture with unit_test_use_fixture beforehand.
+*   @param *fixture - the fixture you want.
+*   @returns void* pointer to the data returned by the fixture's setup.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void *unit_test_fixture_get(struct unit_test *test, struct unit_test_fixture *fixture);
+
+/*
+*   This function runs a test body concurrently on a number of threads to
+*   stress code which must be safe under contention. Every thread is held at
+*   a spin barrier until all of them are running, then released at once.
+*   Each thread calls body repeatedly until it has completed the requested
+*   number of iterations or the time budget runs out, whichever comes first.
+*   Failures report the thread and iteration they happened on, and the
+*   throughput of the run is printed with the test's summary.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param void (*body)() - function pointer called for every iteration with
+*       the test, the thread index and the iteration number.
+*   @param *options - the stress configuration. threads must be positive,
+*       and at least one of iterations or duration must be set.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_stress(struct unit_test *test, void (*body)(struct unit_test *test, int thread, long iteration),
+    struct unit_test_stress *options);
+
+/*
+*   This function measures how long body takes to run, taking steps to
+*   keep the measurement from changing from run to run. The body is run
+*   for warmup untimed samples and then samples timed ones, each of
+*   iterations calls, optionally on a single core and with the caches
+*   flushed or warmed before every sample. Before starting, the CPU
+*   frequency governor, turbo boost and the number of other running tasks
+*   are checked, and anything likely to disturb the timings is listed in
+*   the test's summary.
+*
+*   The summary gives the mean, median and fastest time per call and the
+*   coefficient of variation (standard deviation over mean) of the
+*   samples. Measurements whose coefficient of variation is above max_cv
+*   are marked unstable, so that they are not trusted by mistake.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *body - the code to measure, called with the test and the
+*       number of the call within its sample.
+*   @param *options - the benchmark configuration.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_benchmark(struct unit_test *test, void (*body)(struct unit_test *test, long iteration),
+    struct unit_test_benchmark *options);
+
+/*
+*   This function starts a unit test in a child process, so that a crash or
+*   stray write in the test cannot affect the tests which run after it.
+*   Fixtures declared by the test are built in the parent before forking,
+*   which means snapshot fixtures are built once and mapped copy-on-write
+*   into every child. The child's results are sent back to the parent and
+*   counted against the test as usual. A child which dies is counted as a
+*   failure.
+*
+*   @param *test - unit_test structure representing the test you will be
+*       running.
+*   @param void (*start)() - function pointer representing the start funciton
+*       for the unit test.
+*   @param void (*print)() - function pointer representing the print
+*       function for the unit test. If NULL, the print function defaults to
+*       the built-in print funciton.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_start_forked(struct unit_test *test, void (*start)(), void (*print)());
+
+/*
+*   This function queues a test to be run as a coroutine by
+*   unit_test_run_async, so that many tests which spend their time waiting
+*   for I/O can run at once on one thread. Inside the test, waiting must be
+*   done with unit_test_await_fd and unit_test_await_sleep, which let the
+*   other tests run in the meantime. Assertions are counted as usual; the
+*   test's results are printed together once it finishes.
+*
+*   @param *test - unit_test structure representing the test you will be
+*       running.
+*   @param void (*start)() - function pointer representing the start
+*       function for the unit test.
+*   @param void (*print)() - function pointer representing the print
+*       function for the unit test. If NULL, the print function defaults to
+*       the built-in print funciton.
+*   @param deadline - seconds the test may take, or 0 for no limit. A test
+*       still waiting at its deadline fails and is ended. The deadline is
+*       only checked while the test waits.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_start_async(struct unit_test *test, void (*start)(), void (*print)(), double deadline);
+
+/*
+*   This function runs every test queued with unit_test_start_async,
+*   concurrently on the calling thread, and returns once all of them have
+*   finished. Each test's results are printed as it finishes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_run_async();
+
+/*
+*   This function waits until a file descriptor is ready, letting other
+*   async tests run in the meantime. Outside an async test it simply
+*   blocks in poll().
+*
+*   @param fd - the file descriptor to wait for.
+*   @param events - the events to wait for, such as POLLIN or POLLOUT.
+*   @param timeout - seconds to wait at most, or 0 to wait as long as it
+*       takes.
+*
+*   @return the events which are ready, or 0 if the timeout passed first.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+int unit_test_await_fd(int fd, int events, double timeout);
+
+/*
+*   This function waits for a number of seconds, letting other async tests
+*   run in the meantime. Outside an async test it simply sleeps.
+*
+*   @param seconds - how long to wait.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_await_sleep(double seconds);
+
 /*
 *   This function takes two pointers and tests if they point to the same memory
 *   address. 
@@ -290,4 +1074,736 @@ void unit_test_assert_long_array_equals(struct unit_test *test, const char *fnam
 *   @version 10/09/2021
 */
 void unit_test_assert_char_array_equals(struct unit_test *test, const char *fname, int lineno, char *a, int asize, char *b, int bsize);
+
+/*
+*   This function determines if two float arrays hold the same elements,
+*   each the same number of times, in any order. It runs in linear time
+*   by radix sorting both arrays, so it is suitable for very large arrays.
+*   On failure the elements missing from b and the extra elements in b
+*   are listed with how many of each there were.
+*   Values are compared by their bits, so 0.0 and -0.0 differ and a NaN
+*   matches an identical NaN.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the expected float array.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the float array being checked.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_float_array_unordered_equals(struct unit_test *test, const char *fname, int lineno,
+    const float *a, size_t asize, const float *b, size_t bsize);
+
+/*
+*   This function determines if two integer arrays hold the same elements,
+*   each the same number of times, in any order. It runs in linear time
+*   by radix sorting both arrays, so it is suitable for very large arrays.
+*   On failure the elements missing from b and the extra elements in b
+*   are listed with how many of each there were.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the expected integer array.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the integer array being checked.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_int_array_unordered_equals(struct unit_test *test, const char *fname, int lineno,
+    const int *a, size_t asize, const int *b, size_t bsize);
+
+/*
+*   This function determines if two double arrays hold the same elements,
+*   each the same number of times, in any order. It runs in linear time
+*   by radix sorting both arrays, so it is suitable for very large arrays.
+*   On failure the elements missing from b and the extra elements in b
+*   are listed with how many of each there were.
+*   Values are compared by their bits, so 0.0 and -0.0 differ and a NaN
+*   matches an identical NaN.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the expected double array.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the double array being checked.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_double_array_unordered_equals(struct unit_test *test, const char *fname, int lineno,
+    const double *a, size_t asize, const double *b, size_t bsize);
+
+/*
+*   This function determines if two long arrays hold the same elements,
+*   each the same number of times, in any order. It runs in linear time
+*   by radix sorting both arrays, so it is suitable for very large arrays.
+*   On failure the elements missing from b and the extra elements in b
+*   are listed with how many of each there were.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the expected long array.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the long array being checked.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_long_array_unordered_equals(struct unit_test *test, const char *fname, int lineno,
+    const long *a, size_t asize, const long *b, size_t bsize);
+
+/*
+*   This function determines if two char arrays hold the same elements,
+*   each the same number of times, in any order. It runs in linear time
+*   by radix sorting both arrays, so it is suitable for very large arrays.
+*   On failure the elements missing from b and the extra elements in b
+*   are listed with how many of each there were.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the expected char array.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the char array being checked.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_char_array_unordered_equals(struct unit_test *test, const char *fname, int lineno,
+    const char *a, size_t asize, const char *b, size_t bsize);
+
+/*
+*   This function determines if every element of a float array a also
+*   appears in b, counting repeated elements: an element which appears
+*   three times in a must appear at least three times in b. It runs in
+*   linear time. On failure the elements of a missing from b are listed.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the float array which should be contained in b.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the float array which should contain a.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_float_array_subset(struct unit_test *test, const char *fname, int lineno,
+    const float *a, size_t asize, const float *b, size_t bsize);
+
+/*
+*   This function determines if every element of a integer array a also
+*   appears in b, counting repeated elements: an element which appears
+*   three times in a must appear at least three times in b. It runs in
+*   linear time. On failure the elements of a missing from b are listed.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the integer array which should be contained in b.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the integer array which should contain a.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_int_array_subset(struct unit_test *test, const char *fname, int lineno,
+    const int *a, size_t asize, const int *b, size_t bsize);
+
+/*
+*   This function determines if every element of a double array a also
+*   appears in b, counting repeated elements: an element which appears
+*   three times in a must appear at least three times in b. It runs in
+*   linear time. On failure the elements of a missing from b are listed.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the double array which should be contained in b.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the double array which should contain a.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_double_array_subset(struct unit_test *test, const char *fname, int lineno,
+    const double *a, size_t asize, const double *b, size_t bsize);
+
+/*
+*   This function determines if every element of a long array a also
+*   appears in b, counting repeated elements: an element which appears
+*   three times in a must appear at least three times in b. It runs in
+*   linear time. On failure the elements of a missing from b are listed.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the long array which should be contained in b.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the long array which should contain a.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_long_array_subset(struct unit_test *test, const char *fname, int lineno,
+    const long *a, size_t asize, const long *b, size_t bsize);
+
+/*
+*   This function determines if every element of a char array a also
+*   appears in b, counting repeated elements: an element which appears
+*   three times in a must appear at least three times in b. It runs in
+*   linear time. On failure the elements of a missing from b are listed.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the char array which should be contained in b.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the char array which should contain a.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_char_array_subset(struct unit_test *test, const char *fname, int lineno,
+    const char *a, size_t asize, const char *b, size_t bsize);
+
+/*
+*   This function determines if a float array is sorted in non-decreasing
+*   order. On failure it reports the first element which is out of order
+*   and how many were out of order in total.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the float array to check.
+*   @param asize - the size of array a in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_float_array_sorted(struct unit_test *test, const char *fname, int lineno,
+    const float *a, size_t asize);
+
+/*
+*   This function determines if a integer array is sorted in non-decreasing
+*   order. On failure it reports the first element which is out of order
+*   and how many were out of order in total.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the integer array to check.
+*   @param asize - the size of array a in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_int_array_sorted(struct unit_test *test, const char *fname, int lineno,
+    const int *a, size_t asize);
+
+/*
+*   This function determines if a double array is sorted in non-decreasing
+*   order. On failure it reports the first element which is out of order
+*   and how many were out of order in total.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the double array to check.
+*   @param asize - the size of array a in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_double_array_sorted(struct unit_test *test, const char *fname, int lineno,
+    const double *a, size_t asize);
+
+/*
+*   This function determines if a long array is sorted in non-decreasing
+*   order. On failure it reports the first element which is out of order
+*   and how many were out of order in total.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the long array to check.
+*   @param asize - the size of array a in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_long_array_sorted(struct unit_test *test, const char *fname, int lineno,
+    const long *a, size_t asize);
+
+/*
+*   This function determines if a char array is sorted in non-decreasing
+*   order. On failure it reports the first element which is out of order
+*   and how many were out of order in total.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the char array to check.
+*   @param asize - the size of array a in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_char_array_sorted(struct unit_test *test, const char *fname, int lineno,
+    const char *a, size_t asize);
+
+/*
+*   This function determines if a integer array of n elements is a permutation
+*   of 0 to n - 1, that is, holds each of those values exactly once, as
+*   an array of indices produced by a shuffle or a sort should. On failure
+*   it reports how many values were out of range, repeated or missing.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the integer array to check.
+*   @param asize - the size of array a in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_int_array_permutation(struct unit_test *test, const char *fname, int lineno,
+    const int *a, size_t asize);
+
+/*
+*   This function determines if a long array of n elements is a permutation
+*   of 0 to n - 1, that is, holds each of those values exactly once, as
+*   an array of indices produced by a shuffle or a sort should. On failure
+*   it reports how many values were out of range, repeated or missing.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the long array to check.
+*   @param asize - the size of array a in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_long_array_permutation(struct unit_test *test, const char *fname, int lineno,
+    const long *a, size_t asize);
+
+/*
+*   This function takes two strings and determines if they are equal. The
+*   strings are compared sixteen bytes at a time. On failure, short strings
+*   are printed in full along with where they first differ, and longer
+*   ones are printed as a diff of the changed lines, with a character
+*   level diff of lines which were changed in place.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the expected string.
+*   @param *b - the string being checked.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_string_equals(struct unit_test *test, const char *fname, int lineno,
+    const char *a, const char *b);
+
+/*
+*   This function determines if a string contains another string.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *haystack - the string being searched.
+*   @param *needle - the string which should appear in haystack.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_string_contains(struct unit_test *test, const char *fname, int lineno,
+    const char *haystack, const char *needle);
+
+/*
+*   This function determines if a string starts with another string. Only
+*   as much of the string as the prefix's length is read.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *prefix - the expected start of the string.
+*   @param *b - the string being checked.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_string_prefix(struct unit_test *test, const char *fname, int lineno,
+    const char *prefix, const char *b);
+
+/*
+*   This function forks the zygote process which death tests are run from.
+*   Calling it is optional, as the first death test starts the zygote if it
+*   is not already running. Call it once the program has done any setup
+*   which death tests rely on, such as loading data, and before starting
+*   threads, so that every death test starts from that state.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_zygote_start();
+
+/*
+*   This function runs body(arg) in a child process and asserts that the child
+*   is killed by a signal, as it is when it crashes, calls abort() or fails
+*   an assert(). The child is forked from the zygote process (see
+*   unit_test_zygote_start()), so it starts from the state the program was
+*   in when the zygote was started, not its current state. Because of this
+*   the argument is copied to the child by value: arg_size bytes starting
+*   at arg. Pointers inside it must point to memory which already existed
+*   when the zygote was started.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param body - the function expected to die.
+*   @param *arg - the argument copied to body, or NULL.
+*   @param arg_size - the size of the argument in bytes.
+*   @param signal_number - the signal expected to kill the child, or 0 for
+*       any signal.
+*   @param *message - text which must appear in the child's standard
+*       error, or NULL.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_death(struct unit_test *test, const char *fname, int lineno, void (*body)(void *arg),
+    const void *arg, size_t arg_size, int signal_number, const char *message);
+
+/*
+*   This function runs body(arg) in a child process, like
+*   unit_test_assert_death(), and asserts that the child exits with the
+*   given status, for example by calling exit() after rejecting its input.
+*   A body which returns normally exits with status 0.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param body - the function expected to exit.
+*   @param *arg - the argument copied to body, or NULL.
+*   @param arg_size - the size of the argument in bytes.
+*   @param exit_code - the status the child is expected to exit with.
+*   @param *message - text which must appear in the child's standard
+*       error, or NULL.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_exit_code(struct unit_test *test, const char *fname, int lineno, void (*body)(void *arg),
+    const void *arg, size_t arg_size, int exit_code, const char *message);
+/*
+*   This function creates a mock: a stand-in for a function which records
+*   how it was called. The code under test reaches the mock through a
+*   function pointer it is given, or through a wrapper made with the
+*   linker's --wrap option, and the stand-in calls unit_test_mock_record.
+*
+*   @param *name - name of the mock, printed by failed assertions.
+*   @param capacity - the number of most recent calls to keep the
+*       arguments of. It is rounded up to a power of two.
+*
+*   @return a pointer to the new mock.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_mock *unit_test_mock_init(const char *name, int capacity);
+
+/*
+*   This function frees a mock made by unit_test_mock_init.
+*
+*   @param *mock - the mock to free.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_mock_free(struct unit_test_mock *mock);
+
+/*
+*   This function forgets every call a mock has recorded. The value it
+*   returns is kept.
+*
+*   @param *mock - the mock to reset.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_mock_reset(struct unit_test_mock *mock);
+
+/*
+*   This function sets the value unit_test_mock_record returns, for mocks
+*   of functions which return something.
+*
+*   @param *mock - the mock.
+*   @param value - the value to return from every call.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_mock_returns(struct unit_test_mock *mock, long long value);
+
+/*
+*   This function records a call to a mock. It is called by the stand-in
+*   function with the arguments it was given, cast to long long; unused
+*   arguments should be 0. It can be called from any thread, and is cheap
+*   enough to leave in hot loops: it makes one atomic add and a few
+*   stores, and never allocates or takes a lock.
+*
+*   @param *mock - the mock being called.
+*   @param a - the first argument.
+*   @param b - the second argument.
+*   @param c - the third argument.
+*   @param d - the fourth argument.
+*
+*   @return the value set with unit_test_mock_returns, or 0.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+long long unit_test_mock_record(struct unit_test_mock *mock, long long a, long long b, long long c, long long d);
+
+/*
+*   This function tests if a mock was called at least min and at most max
+*   times.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *mock - the mock.
+*   @param min - the fewest calls allowed.
+*   @param max - the most calls allowed.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_mock_calls(struct unit_test *test, const char *fname, int lineno,
+    struct unit_test_mock *mock, long long min, long long max);
+
+/*
+*   This function tests the arguments of one call to a mock. Only the
+*   calls still held in the mock's ring can be checked.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *mock - the mock.
+*   @param call - which call to check, counting from 0 for the first, or
+*       from -1 for the most recent backwards.
+*   @param *args - the arguments the call is expected to have had.
+*   @param count - the number of arguments to compare, at most 4.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_mock_called_with(struct unit_test *test, const char *fname, int lineno,
+    struct unit_test_mock *mock, long long call, const long long *args, int count);
+
+/*
+*   This function tests that a mock was first called before another mock
+*   was first called. Both must have been called.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *first - the mock expected to be called first.
+*   @param *second - the mock expected to be called after it.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_mock_order(struct unit_test *test, const char *fname, int lineno,
+    struct unit_test_mock *first, struct unit_test_mock *second);
+
+/*
+*   This function checks an optimized implementation of a function against
+*   a simple reference implementation of it. Both are run over count
+*   generated inputs, batch inputs per call, and their outputs compared.
+*   Batches alternate which implementation runs first, so that neither
+*   always gets the inputs from a warm cache, and each call is timed; the
+*   speedup of the candidate over the reference is printed with the test's
+*   summary. The harness only reads the clock three times per batch and compares
+*   matching outputs with one memcmp, so with large batches nearly all of
+*   the time is spent in the two implementations.
+*
+*   The check stops at the first input on which the outputs differ. That
+*   input is shrunk toward zero, one element at a time, for as long as the
+*   implementations still disagree on it, and the assertion fails showing
+*   the shrunk input, both outputs for it, and the index of the original
+*   input.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *options - the implementations, input generator and types.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_differential(struct unit_test *test, const char *fname, int lineno,
+    struct unit_test_differential *options);
+
+/*
+*   This function creates a latency histogram attached to a unit test. Its
+*   percentiles are printed in the test's summary, and can be checked with
+*   unit_test_assert_percentile. Values are kept to within 1% in a fixed
+*   amount of memory per recording thread, from 0 up to about 18 minutes;
+*   longer values are counted as the longest.
+*
+*   @param *test - the unit_test to attach the histogram to.
+*   @param *name - name of the operation being measured.
+*
+*   @return the new histogram.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_histogram *unit_test_histogram_init(struct unit_test *test, const char *name);
+
+/*
+*   This function records one value in a histogram. It can be called from
+*   any thread, and takes a few nanoseconds: each thread records into its
+*   own part of the histogram with plain stores, without locks or atomic
+*   read-modify-writes, and the parts are only added together when the
+*   histogram is read.
+*
+*   @param *histogram - the histogram.
+*   @param nanoseconds - the value to record.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_histogram_record(struct unit_test_histogram *histogram, long long nanoseconds);
+
+/*
+*   This function calls an operation a number of times, recording how long
+*   each call takes in a histogram. The time includes reading the clock,
+*   which takes some tens of nanoseconds.
+*
+*   @param *histogram - the histogram.
+*   @param *operation - the operation, called with arg and the number of
+*       the call.
+*   @param *arg - passed to the operation.
+*   @param calls - number of times to call the operation.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_histogram_measure(struct unit_test_histogram *histogram, void (*operation)(void *arg, long call),
+    void *arg, long calls);
+
+/*
+*   This function tests that a percentile of the values recorded in a
+*   histogram is at most a limit, such as that 99% of calls took no more
+*   than 250 microseconds. The percentile is read as the highest value in
+*   its bucket, so it can be up to 1% above the true value, never below.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *histogram - the histogram.
+*   @param percentile - the percentile to check, from 0 to 100, such as
+*       99 or 99.9.
+*   @param max_microseconds - the most that percentile may be.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_percentile(struct unit_test *test, const char *fname, int lineno,
+    struct unit_test_histogram *histogram, double percentile, double max_microseconds);
+
+/*
+*   This function makes a stream which reads from an open FILE, for
+*   unit_test_assert_stream_equals. The FILE is read from its current
+*   position and is not closed.
+*
+*   @param *name - name of the stream, printed by failed assertions.
+*   @param *file - the FILE to read.
+*
+*   @return the stream.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_stream unit_test_stream_file(const char *name, FILE *file);
+
+/*
+*   This function makes a stream which reads from a file descriptor, such
+*   as a file, pipe or socket, for unit_test_assert_stream_equals. The
+*   descriptor is read from its current position and is not closed.
+*
+*   @param *name - name of the stream, printed by failed assertions.
+*   @param fd - the file descriptor to read.
+*
+*   @return the stream.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_stream unit_test_stream_fd(const char *name, int fd);
+
+/*
+*   This function makes a stream whose bytes come from a function, for
+*   unit_test_assert_stream_equals. It lets output be checked as it is
+*   produced, without writing it anywhere first.
+*
+*   @param *name - name of the stream, printed by failed assertions.
+*   @param *read - fills buffer with up to size bytes and returns how many
+*       it wrote, 0 at the end of the stream, or -1 with errno set if it
+*       failed. It is called from a thread of its own.
+*   @param *source - passed to read.
+*
+*   @return the stream.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_stream unit_test_stream_callback(const char *name,
+    long long (*read)(void *source, void *buffer, size_t size), void *source);
+
+/*
+*   This function tests that two streams hold the same bytes, reading them
+*   a chunk at a time so that streams far larger than memory can be
+*   compared. Each stream is read by a thread of its own into two buffers
+*   of chunk bytes, so the next chunk is read while the last is compared,
+*   and at most four chunks are held in memory at once. A failure gives the
+*   offset of the first byte that differs, or at which one stream ended,
+*   and the bytes around it. The number of bytes compared and how fast is
+*   printed in the test's summary.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *expected - the stream holding the expected bytes.
+*   @param *actual - the stream to check.
+*   @param chunk - bytes per read, or 0 for 1 MiB.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_stream_equals(struct unit_test *test, const char *fname, int lineno,
+    struct unit_test_stream *expected, struct unit_test_stream *actual, size_t chunk);
+
 #endif
\ No newline at end of file
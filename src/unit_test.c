@@ -1,988 +1,8630 @@
+#define _GNU_SOURCE
 #include "../include/unit_test.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
 #include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <setjmp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <ucontext.h>
+#include <poll.h>
+#include <dlfcn.h>
+#include <dirent.h>
+#include <limits.h>
+#include <stdint.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+*   Assertions made from a thread other than the one which owns a unit test
+*   are counted in one of these shards instead of in the unit test itself.
+*   Each shard sits on its own cache line so that worker threads never
+*   contend with each other on the hot path. Shards are folded back into
+*   num_passed and num_failed by unit_test_merge().
+*/
+#define UNIT_TEST_MAX_SHARDS 64
+#define UNIT_TEST_CACHE_LINE 64
+
+struct unit_test_shard {
+    long long passed;
+    long long failed;
+} __attribute__((aligned(UNIT_TEST_CACHE_LINE)));
+
+/*
+*   A growable character buffer used to format assertion output before it
+*   is written out in a single call.
+*/
+struct unit_test_buffer {
+    char *data;
+    size_t length;
+    size_t capacity;
+};
+
+/*
+*   A failure recorded by a non-owner thread. The sequence number is taken
+*   from a global counter so that failures from every thread can be merged
+*   back into the order in which they happened.
+*/
+struct unit_test_failure {
+    unsigned long long sequence;
+    struct unit_test *test;
+    char *text;
+    size_t length;
+};
+
+/*
+*   Per-thread failure log. The lock is only ever contended while
+*   unit_test_merge() is draining the log, never between two asserting
+*   threads.
+*/
+struct unit_test_thread {
+    pthread_mutex_t lock;
+    struct unit_test_failure *failures;
+    int failure_count;
+    int failure_capacity;
+    struct unit_test_thread *next;
+};
+
+/*
+*   The kinds of assertion which can be reported, in the same order as the
+*   unit_test_kinds table below.
+*/
+enum unit_test_kind {
+    UNIT_TEST_KIND_ADDRESS,
+    UNIT_TEST_KIND_FLOAT,
+    UNIT_TEST_KIND_INT,
+    UNIT_TEST_KIND_DOUBLE,
+    UNIT_TEST_KIND_LONG,
+    UNIT_TEST_KIND_CHAR,
+    UNIT_TEST_KIND_FLOAT_ARRAY,
+    UNIT_TEST_KIND_INT_ARRAY,
+    UNIT_TEST_KIND_DOUBLE_ARRAY,
+    UNIT_TEST_KIND_LONG_ARRAY,
+    UNIT_TEST_KIND_CHAR_ARRAY,
+    UNIT_TEST_KIND_FLOAT_UNORDERED,
+    UNIT_TEST_KIND_INT_UNORDERED,
+    UNIT_TEST_KIND_DOUBLE_UNORDERED,
+    UNIT_TEST_KIND_LONG_UNORDERED,
+    UNIT_TEST_KIND_CHAR_UNORDERED,
+    UNIT_TEST_KIND_FLOAT_SUBSET,
+    UNIT_TEST_KIND_INT_SUBSET,
+    UNIT_TEST_KIND_DOUBLE_SUBSET,
+    UNIT_TEST_KIND_LONG_SUBSET,
+    UNIT_TEST_KIND_CHAR_SUBSET,
+    UNIT_TEST_KIND_FLOAT_SORTED,
+    UNIT_TEST_KIND_INT_SORTED,
+    UNIT_TEST_KIND_DOUBLE_SORTED,
+    UNIT_TEST_KIND_LONG_SORTED,
+    UNIT_TEST_KIND_CHAR_SORTED,
+    UNIT_TEST_KIND_INT_PERMUTATION,
+    UNIT_TEST_KIND_LONG_PERMUTATION,
+    UNIT_TEST_KIND_STRING_EQUALS,
+    UNIT_TEST_KIND_STRING_CONTAINS,
+    UNIT_TEST_KIND_STRING_PREFIX,
+    UNIT_TEST_KIND_DEATH,
+    UNIT_TEST_KIND_EXIT,
+    UNIT_TEST_KIND_DEADLINE,
+    UNIT_TEST_KIND_MOCK_CALLS,
+    UNIT_TEST_KIND_MOCK_ARGS,
+    UNIT_TEST_KIND_MOCK_ORDER,
+    UNIT_TEST_KIND_DIFFERENTIAL,
+    UNIT_TEST_KIND_PERCENTILE,
+    UNIT_TEST_KIND_STREAM
+};
+
+/*
+*   Display information for each assertion kind. relation is NULL for
+*   assertions which do not print their operands on the result line, and
+*   element is the scalar kind used to print the members of an array.
+*/
+static const struct unit_test_kind_info {
+    const char *title;
+    const char *relation;
+    const char *noun;
+    int element;
+} unit_test_kinds[] = {
+    {"Assert Same Address", "on addresses", "Address", UNIT_TEST_KIND_ADDRESS},
+    {"Assert Float Equals", "between floats", "Float", UNIT_TEST_KIND_FLOAT},
+    {"Assert Integer Equals", "between integers", "Integer", UNIT_TEST_KIND_INT},
+    {"Assert Double Equals", "between doubles", "Double", UNIT_TEST_KIND_DOUBLE},
+    {"Assert Long Equals", "between longs", "Long", UNIT_TEST_KIND_LONG},
+    {"Assert Char Equals", "between chars", "Char", UNIT_TEST_KIND_CHAR},
+    {"Assert Float Array Equals", NULL, "Float", UNIT_TEST_KIND_FLOAT},
+    {"Assert Integer Array Equals", NULL, "Integer", UNIT_TEST_KIND_INT},
+    {"Assert Double Array Equals", NULL, "Double", UNIT_TEST_KIND_DOUBLE},
+    {"Assert Long Array Equals", NULL, "Long", UNIT_TEST_KIND_LONG},
+    {"Assert Char Array Equals", NULL, "Char", UNIT_TEST_KIND_CHAR},
+    {"Assert Float Array Unordered Equals", NULL, "Float", UNIT_TEST_KIND_FLOAT},
+    {"Assert Integer Array Unordered Equals", NULL, "Integer", UNIT_TEST_KIND_INT},
+    {"Assert Double Array Unordered Equals", NULL, "Double", UNIT_TEST_KIND_DOUBLE},
+    {"Assert Long Array Unordered Equals", NULL, "Long", UNIT_TEST_KIND_LONG},
+    {"Assert Char Array Unordered Equals", NULL, "Char", UNIT_TEST_KIND_CHAR},
+    {"Assert Float Array Subset", NULL, "Float", UNIT_TEST_KIND_FLOAT},
+    {"Assert Integer Array Subset", NULL, "Integer", UNIT_TEST_KIND_INT},
+    {"Assert Double Array Subset", NULL, "Double", UNIT_TEST_KIND_DOUBLE},
+    {"Assert Long Array Subset", NULL, "Long", UNIT_TEST_KIND_LONG},
+    {"Assert Char Array Subset", NULL, "Char", UNIT_TEST_KIND_CHAR},
+    {"Assert Float Array Sorted", NULL, "Float", UNIT_TEST_KIND_FLOAT},
+    {"Assert Integer Array Sorted", NULL, "Integer", UNIT_TEST_KIND_INT},
+    {"Assert Double Array Sorted", NULL, "Double", UNIT_TEST_KIND_DOUBLE},
+    {"Assert Long Array Sorted", NULL, "Long", UNIT_TEST_KIND_LONG},
+    {"Assert Char Array Sorted", NULL, "Char", UNIT_TEST_KIND_CHAR},
+    {"Assert Integer Array Permutation", NULL, "Integer", UNIT_TEST_KIND_INT},
+    {"Assert Long Array Permutation", NULL, "Long", UNIT_TEST_KIND_LONG},
+    {"Assert String Equals", NULL, "String", UNIT_TEST_KIND_STRING_EQUALS},
+    {"Assert String Contains", NULL, "String", UNIT_TEST_KIND_STRING_CONTAINS},
+    {"Assert String Prefix", NULL, "String", UNIT_TEST_KIND_STRING_PREFIX},
+    {"Assert Death", NULL, "Death", UNIT_TEST_KIND_DEATH},
+    {"Assert Exit Code", NULL, "Exit Code", UNIT_TEST_KIND_EXIT},
+    {"Async Deadline", NULL, "Deadline", UNIT_TEST_KIND_DEADLINE},
+    {"Assert Mock Calls", NULL, "Mock", UNIT_TEST_KIND_MOCK_CALLS},
+    {"Assert Mock Called With", NULL, "Mock", UNIT_TEST_KIND_MOCK_ARGS},
+    {"Assert Mock Order", NULL, "Mock", UNIT_TEST_KIND_MOCK_ORDER},
+    {"Assert Differential", NULL, "Differential", UNIT_TEST_KIND_DIFFERENTIAL},
+    {"Assert Percentile", NULL, "Latency", UNIT_TEST_KIND_PERCENTILE},
+    {"Assert Stream Equals", NULL, "Stream", UNIT_TEST_KIND_STREAM}
+};
+
+union unit_test_value {
+    void *p;
+    float f;
+    int i;
+    double d;
+    long l;
+    char c;
+};
+
+/*
+*   A single assertion result. detail holds the pre-formatted expanded
+*   information for assertions whose operands cannot be kept by value
+*   (arrays), and is owned by the event. thread and iteration locate a
+*   failure inside a stress run, and thread is -1 outside of one.
+*/
+struct unit_test_event {
+    struct unit_test *test;
+    const char *fname;
+    int lineno;
+    int kind;
+    int passed;
+    long long index;
+    union unit_test_value a;
+    union unit_test_value b;
+    char *detail;
+    int thread;
+    long iteration;
+};
+
+/*
+*   In bulk mode failures are aggregated per call site instead of being
+*   printed one by one. Each test has a small open-addressing hash table,
+*   keyed on the fname pointer, line number and kind of assertion, which
+*   maps a call site to its entry. Entries are kept in the order their sites first failed and
+*   hold a total count plus the formatted text of the first few failures.
+*
+*   unit_test_repeat() uses the same table to count every assertion made at
+*   a site over many iterations: checked counts all of them, count the
+*   failures, and failed_iterations the iterations with at least one.
+*/
+struct unit_test_site {
+    const char *fname;
+    int lineno;
+    int kind;
+    long long count;
+    int example_count;
+    char **examples;
+    long long checked;
+    long long failed_iterations;
+    long first_iteration;
+    long last_iteration;
+};
+
+struct unit_test_sites {
+    pthread_mutex_t lock;
+    int *slots;
+    int slot_capacity;
+    struct unit_test_site *entries;
+    int count;
+    int capacity;
+};
+
+/*
+*   The suite being run by unit_test_start() on the current thread, and the
+*   point to jump back to if it is aborted or crashes. Contexts nest when a
+*   start function starts another test. signal, code and address describe
+*   a crash the suite was recovered from.
+*/
+struct unit_test_context {
+    struct unit_test *test;
+    sigjmp_buf env;
+    int signal;
+    int code;
+    void *address;
+    struct unit_test_context *previous;
+};
+
+#define UNIT_TEST_JUMP_ABORT 1
+#define UNIT_TEST_JUMP_CRASH 2
+#define UNIT_TEST_JUMP_DEADLINE 3
+
+/*
+*   The outcome of one call to unit_test_stress(), kept on the unit test so
+*   that it can be printed with the test's summary.
+*/
+struct unit_test_stress_result {
+    int threads;
+    long long operations;
+    double seconds;
+    long long *completed;
+    double *elapsed;
+    struct unit_test_stress_result *next;
+};
+
+/*
+*   The outcome of one call to unit_test_benchmark(). Times are in seconds
+*   per call of the body, and warnings lists what in the environment may
+*   have disturbed them.
+*/
+struct unit_test_benchmark_result {
+    const char *name;
+    int samples;
+    long iterations;
+    int cpu;
+    double mean;
+    double median;
+    double min;
+    double cv;
+    double max_cv;
+    char *warnings;
+    struct unit_test_benchmark_result *next;
+};
+
+/*
+*   A latency histogram, made by unit_test_histogram_init(). Each recording
+*   thread has its own part, allocated on its first recording, which only
+*   it writes to; threads past the first UNIT_TEST_MAX_SHARDS share the
+*   last part and update it atomically.
+*/
+#define UNIT_TEST_HISTOGRAM_SUB_BITS 8
+#define UNIT_TEST_HISTOGRAM_MAX_BITS 40
+#define UNIT_TEST_HISTOGRAM_HIGHEST ((1ULL << UNIT_TEST_HISTOGRAM_MAX_BITS) - 1)
+#define UNIT_TEST_HISTOGRAM_BUCKETS \
+    ((UNIT_TEST_HISTOGRAM_MAX_BITS - UNIT_TEST_HISTOGRAM_SUB_BITS + 2) << (UNIT_TEST_HISTOGRAM_SUB_BITS - 1))
+
+struct unit_test_histogram_shard {
+    long long counts[UNIT_TEST_HISTOGRAM_BUCKETS];
+    long long sum;
+    long long min;
+    long long max;
+} __attribute__((aligned(UNIT_TEST_CACHE_LINE)));
+
+struct unit_test_histogram {
+    const char *name;
+    struct unit_test_histogram_shard *shards[UNIT_TEST_MAX_SHARDS + 1];
+    struct unit_test_histogram *next;
+};
+
+static void unit_test_histogram_print(struct unit_test_histogram *histogram, int run);
+
+/*
+*   The outcome of one call to unit_test_assert_differential(), with the
+*   total time each implementation spent on the inputs checked.
+*/
+struct unit_test_differential_result {
+    const char *name;
+    long long inputs;
+    long long reference_ns;
+    long long candidate_ns;
+    struct unit_test_differential_result *next;
+};
+
+/*
+*   The outcome of one call to unit_test_assert_stream_equals(): how many
+*   bytes were compared before the streams ended or differed, and how long
+*   it took.
+*/
+#define UNIT_TEST_STREAM_CHUNK (1 << 20)
+
+struct unit_test_stream_result {
+    const char *expected;
+    const char *actual;
+    unsigned long long bytes;
+    double seconds;
+    struct unit_test_stream_result *next;
+};
+
+/*
+*   The timeline recorded by unit_test_set_trace(). Events are written into
+*   a fixed array in memory shared with forked children, each claiming its
+*   slot with one atomic add. Events which take time are recorded when they
+*   end, with their start and duration in nanoseconds. Names point at
+*   strings which outlive the run, such as test names and __FILE__.
+*/
+enum {
+    UNIT_TEST_TRACE_SUITE,
+    UNIT_TEST_TRACE_FIXTURE,
+    UNIT_TEST_TRACE_STRESS,
+    UNIT_TEST_TRACE_DEATH,
+    UNIT_TEST_TRACE_FAILURE,
+    UNIT_TEST_TRACE_LANE
+};
+
+static const char *unit_test_trace_categories[] = {
+    "suite", "fixture", "stress", "death", "assertion", "worker"
+};
+
+#define UNIT_TEST_TRACE_CAPACITY (1 << 20)
+#define UNIT_TEST_TRACE_LANE_BASE (1 << 30)
+
+struct unit_test_trace_event {
+    const char *name;
+    const char *fname;
+    long long start;
+    long long duration;
+    int pid;
+    int tid;
+    int lineno;
+    int type;
+};
+
+struct unit_test_trace {
+    long long count;
+    long long dropped;
+    long long origin;
+    pid_t owner;
+    char *path;
+    struct unit_test_trace_event events[UNIT_TEST_TRACE_CAPACITY];
+};
 
 struct unit_test **tests;
 int test_count = 0;
+struct unit_test_fixture **fixtures;
+int fixture_count = 0;
+
+static int unit_test_slot_count = 0;
+static __thread int unit_test_slot = -1;
+static __thread struct unit_test_thread *unit_test_self = NULL;
+static __thread struct unit_test_buffer unit_test_scratch;
+static struct unit_test_thread *unit_test_threads = NULL;
+static pthread_mutex_t unit_test_threads_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned long long unit_test_failure_sequence = 0;
+static int unit_test_bulk_examples = 0;
+static int unit_test_abort_suite = 0;
+static int unit_test_max_failed_suites = 0;
+static int unit_test_failed_suites = 0;
+static int unit_test_watching = 0;
+static int unit_test_reloading = 0;
+static __thread struct unit_test_context *unit_test_current = NULL;
+static int unit_test_crash_recovery = 0;
+static struct sigaction unit_test_crash_previous[NSIG];
+static const int unit_test_crash_signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGABRT};
+static __thread void *unit_test_crash_stack = NULL;
+static __thread const char *unit_test_last_fname = NULL;
+static __thread int unit_test_last_lineno = 0;
+static __thread int unit_test_stress_thread = -1;
+static __thread long unit_test_stress_iteration = 0;
+static struct unit_test_sites *unit_test_repeat_sites = NULL;
+static long unit_test_repeat_iteration = 0;
+static unsigned long long unit_test_current_seed = 0x2545F4914F6CDD1DULL;
+static struct unit_test_trace *unit_test_trace = NULL;
+static pid_t unit_test_trace_pid = 0;
+static __thread int unit_test_trace_tid = 0;
+static __thread struct unit_test_buffer *unit_test_capture = NULL;
+
 /*
-*   This function initializes a new unit test with a given name.
-*   
-*   @param name - char* array representing the name of the test case.
-*   @returns unit_test* pointer representing the new and initialized 
-*   unit test.
+*   Returns a monotonic timestamp in seconds.
+*/
+static double unit_test_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/*
+*   Tells the processor that the caller is busy-waiting.
+*/
+static inline void unit_test_cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __asm__ __volatile__("pause");
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/*
+*   Returns the calling thread's slot number. Slots are handed out once per
+*   thread and are never reused, so they also identify the owner of a test.
+*/
+static int unit_test_thread_slot() {
+    if (unit_test_slot < 0)
+    {
+        unit_test_slot = __atomic_fetch_add(&unit_test_slot_count, 1, __ATOMIC_RELAXED);
+    }
+    return unit_test_slot;
+}
+
+/*
+*   Appends formatted text to a buffer, growing it as required.
+*/
+static void unit_test_buffer_printf(struct unit_test_buffer *buffer, const char *format, ...) {
+    va_list args;
+    for (;;)
+    {
+        size_t space = buffer->capacity - buffer->length;
+        va_start(args, format);
+        int written = vsnprintf(buffer->data + buffer->length, space, format, args);
+        va_end(args);
+        assert(written >= 0);
+        if ((size_t) written < space)
+        {
+            buffer->length += written;
+            return;
+        }
+        size_t capacity = buffer->capacity == 0 ? 256 : buffer->capacity * 2;
+        while (capacity - buffer->length <= (size_t) written)
+        {
+            capacity *= 2;
+        }
+        buffer->data = realloc(buffer->data, capacity);
+        assert(buffer->data != NULL);
+        buffer->capacity = capacity;
+    }
+}
+
+/*
+*   Appends raw bytes to a buffer, growing it as required. The buffer is
+*   kept nul terminated.
+*/
+static void unit_test_buffer_append(struct unit_test_buffer *buffer, const void *data, size_t length) {
+    if (buffer->capacity - buffer->length <= length)
+    {
+        size_t capacity = buffer->capacity == 0 ? 256 : buffer->capacity * 2;
+        while (capacity - buffer->length <= length)
+        {
+            capacity *= 2;
+        }
+        buffer->data = realloc(buffer->data, capacity);
+        assert(buffer->data != NULL);
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+}
+
+/*
+*   Detaches the contents of a buffer as a heap string, leaving the buffer
+*   empty.
+*/
+static char *unit_test_buffer_detach(struct unit_test_buffer *buffer) {
+    char *data = buffer->data;
+    if (data == NULL)
+    {
+        data = calloc(1, 1);
+    }
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+    return data;
+}
+
+/*
+*   Returns the shard used by the given slot for a test, allocating the
+*   test's shards the first time any non-owner thread asserts on it.
+*/
+static struct unit_test_shard *unit_test_shard_for(struct unit_test *test, int slot) {
+    struct unit_test_shard *shards = __atomic_load_n(&test->shards, __ATOMIC_ACQUIRE);
+    if (shards == NULL)
+    {
+        struct unit_test_shard *fresh = aligned_alloc(UNIT_TEST_CACHE_LINE,
+            UNIT_TEST_MAX_SHARDS * sizeof(struct unit_test_shard));
+        assert(fresh != NULL);
+        memset(fresh, 0, UNIT_TEST_MAX_SHARDS * sizeof(struct unit_test_shard));
+        if (__atomic_compare_exchange_n(&test->shards, &shards, fresh, 0,
+            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            shards = fresh;
+        }
+        else
+        {
+            free(fresh);
+        }
+    }
+    return &shards[slot % UNIT_TEST_MAX_SHARDS];
+}
+
+/*
+*   Returns the calling thread's failure log, registering it on first use.
+*/
+static struct unit_test_thread *unit_test_thread_self() {
+    if (unit_test_self == NULL)
+    {
+        struct unit_test_thread *self = calloc(1, sizeof(struct unit_test_thread));
+        assert(self != NULL);
+        pthread_mutex_init(&self->lock, NULL);
+        pthread_mutex_lock(&unit_test_threads_lock);
+        self->next = unit_test_threads;
+        unit_test_threads = self;
+        pthread_mutex_unlock(&unit_test_threads_lock);
+        unit_test_self = self;
+    }
+    return unit_test_self;
+}
+
+/*
+*   Prints a single scalar value in the style used by its assertion kind.
+*/
+static void unit_test_format_value(struct unit_test_buffer *out, int kind, union unit_test_value value) {
+    switch (kind)
+    {
+        case UNIT_TEST_KIND_ADDRESS:
+            unit_test_buffer_printf(out, "0x%p", value.p);
+            break;
+        case UNIT_TEST_KIND_FLOAT:
+            unit_test_buffer_printf(out, "%ff", value.f);
+            break;
+        case UNIT_TEST_KIND_INT:
+            unit_test_buffer_printf(out, "%d", value.i);
+            break;
+        case UNIT_TEST_KIND_DOUBLE:
+            unit_test_buffer_printf(out, "%f", value.d);
+            break;
+        case UNIT_TEST_KIND_LONG:
+            unit_test_buffer_printf(out, "%ldL", value.l);
+            break;
+        case UNIT_TEST_KIND_CHAR:
+            unit_test_buffer_printf(out, "'%c'", value.c);
+            break;
+    }
+}
+
+/*
+*   Formats the full output of an assertion: the result line and, for
+*   failures, the expanded information block.
+*/
+static void unit_test_format_event(struct unit_test_buffer *out, struct unit_test_event *event) {
+    const struct unit_test_kind_info *info = &unit_test_kinds[event->kind];
+    unit_test_buffer_printf(out, "%lld - \033[1;37m%s: \033[1;36m%s\033[0m",
+        event->index, event->test->name, info->title);
+    if (info->relation != NULL)
+    {
+        unit_test_buffer_printf(out, " %s \033[0;36m", info->relation);
+        unit_test_format_value(out, event->kind, event->a);
+        unit_test_buffer_printf(out, "\033[0m and \033[0;36m");
+        unit_test_format_value(out, event->kind, event->b);
+        unit_test_buffer_printf(out, "\033[0m");
+    }
+    unit_test_buffer_printf(out, ":");
+
+    if (event->passed)
+    {
+        unit_test_buffer_printf(out, " \033[1;32mPASSED\n\033[0m");
+        return;
+    }
+    unit_test_buffer_printf(out, " \033[1;31mFAILED\n\033[0m");
+    unit_test_buffer_printf(out, "\n\t\033[1;37mExpanded Information:\n");
+    unit_test_buffer_printf(out, "\t\033[1;36m%s \033[1;31mFailed\033[0m"
+        " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n",
+        info->title, event->fname, event->lineno);
+    if (event->detail != NULL)
+    {
+        unit_test_buffer_printf(out, "%s", event->detail);
+    }
+    else
+    {
+        unit_test_buffer_printf(out, "\tAssertion expected \033[1;31m");
+        unit_test_format_value(out, event->kind, event->a);
+        unit_test_buffer_printf(out, "\033[0m but got \033[1;31m");
+        unit_test_format_value(out, event->kind, event->b);
+        unit_test_buffer_printf(out, "\033[0m.\n");
+    }
+    if (event->thread >= 0)
+    {
+        unit_test_buffer_printf(out, "\tFailed on stress thread \033[1;31m%d\033[0m"
+            " at iteration \033[1;31m%ld\033[0m.\n", event->thread, event->iteration);
+    }
+    unit_test_buffer_printf(out, "\n\033[0m");
+}
+
+/*
+*   The asynchronous reporter. Owner threads push assertion events into a
+*   bounded lock-free ring (a Vyukov-style queue: each cell carries a
+*   sequence number which tells producers and the consumer whose turn it
+*   is) and a background thread formats them and writes them out in large
+*   batches. written trails tail until every pushed event is on stdout,
+*   which is what unit_test_async_drain() waits for.
+*/
+#define UNIT_TEST_RING_SIZE 8192
+#define UNIT_TEST_RING_BATCH 65536
+
+struct unit_test_cell {
+    unsigned long long sequence;
+    struct unit_test_event event;
+};
+
+static struct unit_test_cell *unit_test_ring = NULL;
+static unsigned long long unit_test_ring_tail = 0;
+static unsigned long long unit_test_ring_head = 0;
+static unsigned long long unit_test_ring_written = 0;
+static int unit_test_async = 0;
+static int unit_test_async_running = 0;
+static int unit_test_async_sleeping = 0;
+static pthread_t unit_test_async_thread;
+static pthread_mutex_t unit_test_async_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t unit_test_async_wake = PTHREAD_COND_INITIALIZER;
+static struct sigaction unit_test_async_previous[NSIG];
+static const int unit_test_async_signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGTERM, SIGINT};
+
+static void unit_test_format_event(struct unit_test_buffer *out, struct unit_test_event *event);
+
+static void unit_test_async_notify() {
+    pthread_mutex_lock(&unit_test_async_lock);
+    pthread_cond_signal(&unit_test_async_wake);
+    pthread_mutex_unlock(&unit_test_async_lock);
+}
+
+/*
+*   Pushes an event onto the ring, taking ownership of its detail. If the
+*   ring is full the producer waits for the reporter to make room.
+*/
+static void unit_test_async_push(struct unit_test_event *event) {
+    unsigned long long position = __atomic_load_n(&unit_test_ring_tail, __ATOMIC_RELAXED);
+    struct unit_test_cell *cell;
+    for (;;)
+    {
+        cell = &unit_test_ring[position & (UNIT_TEST_RING_SIZE - 1)];
+        unsigned long long sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        long long difference = (long long) (sequence - position);
+        if (difference == 0)
+        {
+            if (__atomic_compare_exchange_n(&unit_test_ring_tail, &position, position + 1, 1,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            unit_test_async_notify();
+            sched_yield();
+            position = __atomic_load_n(&unit_test_ring_tail, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            position = __atomic_load_n(&unit_test_ring_tail, __ATOMIC_RELAXED);
+        }
+    }
+    cell->event = *event;
+    __atomic_store_n(&cell->sequence, position + 1, __ATOMIC_RELEASE);
+    event->detail = NULL;
+    if (__atomic_load_n(&unit_test_async_sleeping, __ATOMIC_RELAXED))
+    {
+        unit_test_async_notify();
+    }
+}
+
+/*
+*   Writes a batch to standard output. Anything printed through stdio
+*   beforehand is flushed first so that it comes out in the right order.
+*/
+static void unit_test_async_write(struct unit_test_buffer *batch) {
+    fflush(stdout);
+    size_t done = 0;
+    while (done < batch->length)
+    {
+        ssize_t written = write(STDOUT_FILENO, batch->data + done, batch->length - done);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            break;
+        }
+        done += written;
+    }
+    batch->length = 0;
+}
+
+static void *unit_test_async_main(void *arg) {
+    struct unit_test_buffer batch = {0};
+    unsigned long long head = unit_test_ring_head;
+    for (;;)
+    {
+        struct unit_test_cell *cell = &unit_test_ring[head & (UNIT_TEST_RING_SIZE - 1)];
+        if (__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) == head + 1)
+        {
+            unit_test_format_event(&batch, &cell->event);
+            free(cell->event.detail);
+            __atomic_store_n(&cell->sequence, head + UNIT_TEST_RING_SIZE, __ATOMIC_RELEASE);
+            head++;
+            __atomic_store_n(&unit_test_ring_head, head, __ATOMIC_RELAXED);
+            if (batch.length < UNIT_TEST_RING_BATCH)
+            {
+                continue;
+            }
+        }
+        if (batch.length > 0)
+        {
+            unit_test_async_write(&batch);
+            __atomic_store_n(&unit_test_ring_written, head, __ATOMIC_RELEASE);
+            continue;
+        }
+        __atomic_store_n(&unit_test_ring_written, head, __ATOMIC_RELEASE);
+
+        pthread_mutex_lock(&unit_test_async_lock);
+        __atomic_store_n(&unit_test_async_sleeping, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&unit_test_ring_tail, __ATOMIC_SEQ_CST) == head)
+        {
+            if (!__atomic_load_n(&unit_test_async_running, __ATOMIC_ACQUIRE))
+            {
+                __atomic_store_n(&unit_test_async_sleeping, 0, __ATOMIC_RELAXED);
+                pthread_mutex_unlock(&unit_test_async_lock);
+                break;
+            }
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_nsec += 1000000;
+            if (until.tv_nsec >= 1000000000)
+            {
+                until.tv_sec++;
+                until.tv_nsec -= 1000000000;
+            }
+            pthread_cond_timedwait(&unit_test_async_wake, &unit_test_async_lock, &until);
+        }
+        __atomic_store_n(&unit_test_async_sleeping, 0, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&unit_test_async_lock);
+    }
+    free(batch.data);
+    return NULL;
+}
+
+/*
+*   Waits until every event pushed so far has been written to standard
+*   output. Everything which prints through stdio while asynchronous
+*   reporting is on calls this first. Only async-signal-safe calls are
+*   made while waiting, and the wait gives up after about a second, so
+*   the signal handler below can use it too.
+*/
+static void unit_test_async_drain() {
+    if (!__atomic_load_n(&unit_test_async, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+    unsigned long long target = __atomic_load_n(&unit_test_ring_tail, __ATOMIC_ACQUIRE);
+    struct timespec pause = {0, 50000};
+    for (int waited = 0; waited < 20000; waited++)
+    {
+        if (__atomic_load_n(&unit_test_ring_written, __ATOMIC_ACQUIRE) >= target)
+        {
+            return;
+        }
+        nanosleep(&pause, NULL);
+    }
+}
+
+/*
+*   Flushes pending results when the process is killed by a signal, then
+*   lets the signal carry on as it would have.
+*/
+static void unit_test_async_signal(int signal) {
+    unit_test_async_drain();
+    sigaction(signal, &unit_test_async_previous[signal], NULL);
+    raise(signal);
+}
+
+static void unit_test_async_exit() {
+    unit_test_set_async_reporting(0);
+}
+
+/*
+*   A forked child has no reporter thread; it reports synchronously.
+*/
+static void unit_test_async_child() {
+    unit_test_async = 0;
+    unit_test_async_running = 0;
+}
+
+/*
+*   This function turns asynchronous reporting on or off. While it is on,
+*   an assertion on the thread which owns its test only records a compact
+*   event, and a background thread formats the results and writes them to
+*   standard output in large batches. This keeps formatting and I/O off
+*   the test thread. Results are always flushed before a header or summary
+*   is printed, when the process exits, and when it is killed by a signal.
+*   Anything the test itself prints may come out ahead of results which
+*   have not been flushed yet.
+*
+*   @param enabled - non-zero to turn asynchronous reporting on.
 *
 *   @author Brennan Hurst
-*   @version 10/07/2021
+*   @version 10/18/2026
 */
-struct unit_test* unit_test_init(char* name) {
+void unit_test_set_async_reporting(int enabled) {
+    static int registered = 0;
+    if (enabled && !unit_test_async)
+    {
+        if (unit_test_ring == NULL)
+        {
+            unit_test_ring = calloc(UNIT_TEST_RING_SIZE, sizeof(struct unit_test_cell));
+            assert(unit_test_ring != NULL);
+            for (unsigned long long i = 0; i < UNIT_TEST_RING_SIZE; i++)
+            {
+                unit_test_ring[i].sequence = unit_test_ring_tail + i;
+            }
+        }
+        if (!registered)
+        {
+            registered = 1;
+            atexit(&unit_test_async_exit);
+            pthread_atfork(NULL, NULL, &unit_test_async_child);
+        }
+        fflush(stdout);
+        __atomic_store_n(&unit_test_async_running, 1, __ATOMIC_RELEASE);
+        int created = pthread_create(&unit_test_async_thread, NULL, &unit_test_async_main, NULL);
+        if (created != 0)
+        {
+            //without a writer thread results keep being printed as they happen
+            __atomic_store_n(&unit_test_async_running, 0, __ATOMIC_RELEASE);
+            fprintf(stderr, "unit_test: could not start the asynchronous reporter: %s\n", strerror(created));
+            return;
+        }
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = &unit_test_async_signal;
+        action.sa_flags = SA_ONSTACK;
+        sigemptyset(&action.sa_mask);
+        for (size_t i = 0; i < sizeof(unit_test_async_signals) / sizeof(int); i++)
+        {
+            sigaction(unit_test_async_signals[i], &action,
+                &unit_test_async_previous[unit_test_async_signals[i]]);
+        }
+        __atomic_store_n(&unit_test_async, 1, __ATOMIC_RELEASE);
+    }
+    else if (!enabled && unit_test_async)
+    {
+        unit_test_async_drain();
+        __atomic_store_n(&unit_test_async_running, 0, __ATOMIC_RELEASE);
+        unit_test_async_notify();
+        pthread_join(unit_test_async_thread, NULL);
+        __atomic_store_n(&unit_test_async, 0, __ATOMIC_RELEASE);
+        for (size_t i = 0; i < sizeof(unit_test_async_signals) / sizeof(int); i++)
+        {
+            sigaction(unit_test_async_signals[i],
+                &unit_test_async_previous[unit_test_async_signals[i]], NULL);
+        }
+    }
+}
 
-    tests = realloc(tests, (test_count + 1) * sizeof(struct unit_test*));
-    struct unit_test *u_test = calloc(1, sizeof(struct unit_test));
-    //printf("%d\n", sizeof(tests));
-    u_test->name = name;
-    u_test->num_passed = 0;
-    u_test->num_failed = 0;
-    tests[test_count] = u_test;
-    test_count++;
-    return u_test;
+/*
+*   Returns a test's call site table, creating it on first use.
+*/
+static struct unit_test_sites *unit_test_sites_for(struct unit_test *test) {
+    struct unit_test_sites *sites = __atomic_load_n(&test->sites, __ATOMIC_ACQUIRE);
+    if (sites == NULL)
+    {
+        struct unit_test_sites *fresh = calloc(1, sizeof(struct unit_test_sites));
+        assert(fresh != NULL);
+        pthread_mutex_init(&fresh->lock, NULL);
+        if (__atomic_compare_exchange_n(&test->sites, &sites, fresh, 0,
+            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            sites = fresh;
+        }
+        else
+        {
+            pthread_mutex_destroy(&fresh->lock);
+            free(fresh);
+        }
+    }
+    return sites;
+}
+
+static unsigned long unit_test_site_hash(const char *fname, int lineno) {
+    unsigned long hash = (unsigned long) (size_t) fname * 0x9E3779B97F4A7C15UL;
+    hash ^= (unsigned long) lineno * 0xC2B2AE3D27D4EB4FUL;
+    return hash ^ (hash >> 29);
+}
+
+/*
+*   Finds the entry for a call site, adding one if the site has not been
+*   seen before. Must be called with the table locked.
+*/
+static struct unit_test_site *unit_test_site_find(struct unit_test_sites *sites, const char *fname,
+    int lineno, int kind) {
+    if ((sites->count + 1) * 4 > sites->slot_capacity * 3)
+    {
+        int capacity = sites->slot_capacity == 0 ? 64 : sites->slot_capacity * 2;
+        int *slots = malloc(capacity * sizeof(int));
+        assert(slots != NULL);
+        memset(slots, -1, capacity * sizeof(int));
+        for (int i = 0; i < sites->count; i++)
+        {
+            unsigned long probe = unit_test_site_hash(sites->entries[i].fname, sites->entries[i].lineno);
+            while (slots[probe & (capacity - 1)] >= 0) probe++;
+            slots[probe & (capacity - 1)] = i;
+        }
+        free(sites->slots);
+        sites->slots = slots;
+        sites->slot_capacity = capacity;
+    }
+
+    unsigned long probe = unit_test_site_hash(fname, lineno);
+    for (;; probe++)
+    {
+        int index = sites->slots[probe & (sites->slot_capacity - 1)];
+        if (index < 0)
+        {
+            break;
+        }
+        if (sites->entries[index].fname == fname && sites->entries[index].lineno == lineno
+            && sites->entries[index].kind == kind)
+        {
+            return &sites->entries[index];
+        }
+    }
+
+    if (sites->count == sites->capacity)
+    {
+        sites->capacity = sites->capacity == 0 ? 16 : sites->capacity * 2;
+        sites->entries = realloc(sites->entries, sites->capacity * sizeof(struct unit_test_site));
+        assert(sites->entries != NULL);
+    }
+    sites->slots[probe & (sites->slot_capacity - 1)] = sites->count;
+    struct unit_test_site *site = &sites->entries[sites->count++];
+    memset(site, 0, sizeof(*site));
+    site->fname = fname;
+    site->lineno = lineno;
+    site->kind = kind;
+    return site;
+}
+
+/*
+*   Counts a failure against its call site, keeping the formatted text of
+*   the first few. Later failures at the same site are only counted, so
+*   they are never formatted.
+*/
+static void unit_test_bulk_record(struct unit_test_event *event) {
+    struct unit_test_sites *sites = unit_test_sites_for(event->test);
+    pthread_mutex_lock(&sites->lock);
+    struct unit_test_site *site = unit_test_site_find(sites, event->fname, event->lineno, event->kind);
+    site->count++;
+    if (site->example_count < unit_test_bulk_examples)
+    {
+        if (site->examples == NULL)
+        {
+            site->examples = calloc(unit_test_bulk_examples, sizeof(char *));
+            assert(site->examples != NULL);
+        }
+        struct unit_test_buffer out = {0};
+        unit_test_format_event(&out, event);
+        site->examples[site->example_count++] = unit_test_buffer_detach(&out);
+    }
+    pthread_mutex_unlock(&sites->lock);
+}
+
+/*
+*   Counts an assertion against its call site while a worker is repeating
+*   a test. Nothing is formatted or printed.
+*/
+static void unit_test_repeat_record(struct unit_test_event *event) {
+    struct unit_test_sites *sites = unit_test_repeat_sites;
+    pthread_mutex_lock(&sites->lock);
+    struct unit_test_site *site = unit_test_site_find(sites, event->fname, event->lineno, event->kind);
+    if (site->checked == 0)
+    {
+        site->first_iteration = -1;
+    }
+    site->checked++;
+    if (!event->passed)
+    {
+        site->count++;
+        if (site->first_iteration < 0 || site->last_iteration != unit_test_repeat_iteration)
+        {
+            site->failed_iterations++;
+        }
+        if (site->first_iteration < 0 || unit_test_repeat_iteration < site->first_iteration)
+        {
+            site->first_iteration = unit_test_repeat_iteration;
+        }
+        site->last_iteration = unit_test_repeat_iteration;
+    }
+    pthread_mutex_unlock(&sites->lock);
+}
+
+/*
+*   Prints and clears the failures aggregated for a test in bulk mode.
+*/
+static void unit_test_bulk_flush(struct unit_test *test) {
+    struct unit_test_sites *sites = __atomic_load_n(&test->sites, __ATOMIC_ACQUIRE);
+    if (sites == NULL)
+    {
+        return;
+    }
+    pthread_mutex_lock(&sites->lock);
+    for (int i = 0; i < sites->count; i++)
+    {
+        struct unit_test_site *site = &sites->entries[i];
+        printf("\t\033[1;36m%s \033[1;31mFailed %lld time%s\033[0m in file \033[1;31m%s\033[0m"
+            " at line \033[1;31m%d\033[0m", unit_test_kinds[site->kind].title, site->count,
+            site->count == 1 ? "" : "s", site->fname, site->lineno);
+        if (site->count > site->example_count)
+        {
+            printf(" (first %d shown)", site->example_count);
+        }
+        printf(":\n\n");
+        for (int j = 0; j < site->example_count; j++)
+        {
+            fputs(site->examples[j], stdout);
+            free(site->examples[j]);
+        }
+        free(site->examples);
+    }
+    sites->count = 0;
+    if (sites->slots != NULL)
+    {
+        memset(sites->slots, -1, sites->slot_capacity * sizeof(int));
+    }
+    pthread_mutex_unlock(&sites->lock);
+}
+
+/*
+*   This function turns bulk mode on or off. Bulk mode is meant for
+*   assertions inside loops over large amounts of data. While it is on,
+*   passing assertions are counted but not printed, and failures are
+*   grouped by the file and line they were made from. For each of those
+*   call sites only the first few failures are kept, along with a count of
+*   all of them, and they are printed once with the test's summary.
+*
+*   @param examples - number of failures to keep for each call site, or 0
+*       to turn bulk mode off.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_set_bulk_mode(int examples) {
+    assert(examples >= 0);
+    unit_test_async_drain();
+    unit_test_bulk_examples = examples;
+}
+
+/*
+*   Returns a monotonic timestamp in nanoseconds, for the trace.
+*/
+static long long unit_test_trace_clock() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/*
+*   Returns the time an event starts, or 0 when nothing is being traced.
+*/
+static inline long long unit_test_trace_begin() {
+    return unit_test_trace != NULL ? unit_test_trace_clock() : 0;
+}
+
+/*
+*   Claims the next slot in the trace buffer and fills in who the event
+*   belongs to. Returns NULL once the buffer is full; the event is then
+*   only counted.
+*/
+static struct unit_test_trace_event *unit_test_trace_claim(struct unit_test_trace *trace, int type) {
+    long long index = __atomic_fetch_add(&trace->count, 1, __ATOMIC_RELAXED);
+    if (index >= UNIT_TEST_TRACE_CAPACITY)
+    {
+        __atomic_fetch_add(&trace->dropped, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    if (unit_test_trace_tid == 0)
+    {
+        unit_test_trace_tid = (int) syscall(SYS_gettid);
+    }
+    struct unit_test_trace_event *event = &trace->events[index];
+    event->type = type;
+    event->pid = unit_test_trace_pid;
+    event->tid = unit_test_trace_tid;
+    return event;
+}
+
+/*
+*   Records an event which started at the time returned by
+*   unit_test_trace_begin() and ends now.
+*/
+static void unit_test_trace_end(int type, const char *name, long long started) {
+    struct unit_test_trace *trace = unit_test_trace;
+    if (trace == NULL || started == 0)
+    {
+        return;
+    }
+    long long now = unit_test_trace_clock();
+    struct unit_test_trace_event *event = unit_test_trace_claim(trace, type);
+    if (event != NULL)
+    {
+        event->name = name;
+        event->fname = NULL;
+        event->lineno = 0;
+        event->start = started;
+        event->duration = now - started;
+    }
+}
+
+/*
+*   Records an event which takes no time, such as a failed assertion.
+*/
+static void unit_test_trace_instant(int type, const char *name, const char *fname, int lineno) {
+    struct unit_test_trace *trace = unit_test_trace;
+    if (trace == NULL)
+    {
+        return;
+    }
+    struct unit_test_trace_event *event = unit_test_trace_claim(trace, type);
+    if (event != NULL)
+    {
+        event->name = name;
+        event->fname = fname;
+        event->lineno = lineno;
+        event->start = unit_test_trace_clock();
+        event->duration = 0;
+    }
+}
+
+/*
+*   Names the rows of the timeline which worker processes record on, for
+*   workers 1 to count. Lanes are given thread ids far above any real one
+*   so that they cannot clash.
+*/
+static void unit_test_trace_lanes(int count) {
+    for (int lane = 1; lane <= count && unit_test_trace != NULL; lane++)
+    {
+        struct unit_test_trace_event *event = unit_test_trace_claim(unit_test_trace, UNIT_TEST_TRACE_LANE);
+        if (event != NULL)
+        {
+            event->tid = UNIT_TEST_TRACE_LANE_BASE + lane;
+            event->name = NULL;
+            event->fname = NULL;
+            event->lineno = lane;
+            event->start = 0;
+            event->duration = 0;
+        }
+    }
+}
+
+/*
+*   Makes the events recorded by the calling worker process appear on its
+*   own row of its parent's timeline, rather than under a process of their
+*   own.
+*/
+static void unit_test_trace_lane(pid_t parent, int lane) {
+    unit_test_trace_pid = parent;
+    unit_test_trace_tid = UNIT_TEST_TRACE_LANE_BASE + lane;
+}
+
+/*
+*   A forked child records under its own process id.
+*/
+static void unit_test_trace_child() {
+    unit_test_trace_pid = getpid();
+    unit_test_trace_tid = 0;
+}
+
+/*
+*   Writes a string as a JSON string literal.
+*/
+static void unit_test_trace_string(FILE *file, const char *text) {
+    fputc('"', file);
+    for (const unsigned char *c = (const unsigned char *) text; c != NULL && *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            fputc('\\', file);
+            fputc(*c, file);
+        }
+        else if (*c < 0x20)
+        {
+            fprintf(file, "\\u%04x", *c);
+        }
+        else
+        {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+/*
+*   Writes the recorded events as Chrome trace event JSON, with times in
+*   microseconds from when tracing was turned on.
+*/
+static void unit_test_trace_write(struct unit_test_trace *trace) {
+    FILE *file = fopen(trace->path, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "unit_test: could not write trace to %s: %s\n", trace->path, strerror(errno));
+        return;
+    }
+    long long count = trace->count < UNIT_TEST_TRACE_CAPACITY ? trace->count : UNIT_TEST_TRACE_CAPACITY;
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"unit tests\"}}",
+        trace->owner);
+    for (long long i = 0; i < count; i++)
+    {
+        struct unit_test_trace_event *event = &trace->events[i];
+        if (event->type == UNIT_TEST_TRACE_LANE)
+        {
+            fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+                "\"args\":{\"name\":\"Worker %d\"}}", event->pid, event->tid, event->lineno);
+            continue;
+        }
+        fprintf(file, ",\n{\"name\":");
+        unit_test_trace_string(file, event->name);
+        fprintf(file, ",\"cat\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f",
+            unit_test_trace_categories[event->type], event->pid, event->tid,
+            (event->start - trace->origin) / 1000.0);
+        if (event->type == UNIT_TEST_TRACE_FAILURE)
+        {
+            fprintf(file, ",\"ph\":\"i\",\"s\":\"t\",\"args\":{\"file\":");
+            unit_test_trace_string(file, event->fname);
+            fprintf(file, ",\"line\":%d}}", event->lineno);
+        }
+        else
+        {
+            fprintf(file, ",\"ph\":\"X\",\"dur\":%.3f}", event->duration / 1000.0);
+        }
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":%lld}}\n",
+        trace->count - count);
+    fclose(file);
+}
+
+/*
+*   Writes the trace when the program exits. Forked children which exit
+*   normally leave it to the process which turned tracing on.
+*/
+static void unit_test_trace_exit() {
+    struct unit_test_trace *trace = unit_test_trace;
+    if (trace != NULL && trace->owner == getpid())
+    {
+        unit_test_set_trace(NULL);
+    }
+}
+
+/*
+*   This function turns recording of a timeline of the run on or off. While
+*   it is on, the start and length of every test, fixture setup, stress run
+*   and death test, and the time, file and line of every failed assertion
+*   are recorded along with the thread they happened on. The timeline is
+*   written to a file in Chrome's trace event format, which can be opened
+*   in Perfetto (ui.perfetto.dev) or chrome://tracing, when the program
+*   exits or tracing is turned off.
+*
+*   Recording an event takes one atomic add and a few stores into a buffer
+*   shared with forked child processes, so tests run by
+*   unit_test_start_forked, parallel runs and repeated tests are recorded
+*   too. Names are recorded as pointers, so they must have existed before
+*   the child was forked. Parallel workers are shown as rows named
+*   "Worker 1", "Worker 2" and so on. The buffer holds about a million
+*   events; any beyond that are counted but not kept.
+*
+*   @param *path - the file to write the timeline to, or NULL to turn
+*       recording off and write the file for the current recording.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_set_trace(const char *path) {
+    static int registered = 0;
+    struct unit_test_trace *trace = unit_test_trace;
+    if (trace != NULL)
+    {
+        __atomic_store_n(&unit_test_trace, NULL, __ATOMIC_RELEASE);
+        unit_test_trace_write(trace);
+        free(trace->path);
+        munmap(trace, sizeof(struct unit_test_trace));
+    }
+    if (path == NULL)
+    {
+        return;
+    }
+    trace = mmap(NULL, sizeof(struct unit_test_trace), PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    assert(trace != MAP_FAILED);
+    trace->path = strdup(path);
+    trace->owner = getpid();
+    trace->origin = unit_test_trace_clock();
+    unit_test_trace_pid = trace->owner;
+    if (!registered)
+    {
+        registered = 1;
+        atexit(&unit_test_trace_exit);
+        pthread_atfork(NULL, NULL, &unit_test_trace_child);
+    }
+    __atomic_store_n(&unit_test_trace, trace, __ATOMIC_RELEASE);
+}
+
+/*
+*   Records the result of an assertion against its unit test.
+*
+*   On the thread which owns the test the result is counted directly and
+*   printed immediately with a single write, so output from concurrent
+*   threads never interleaves mid-line, or handed to the asynchronous
+*   reporter when that is turned on. On any other thread the result is
+*   counted in that thread's shard; failures are formatted into the
+*   thread's failure log and printed in order by unit_test_merge().
+*/
+/*
+*   Adds a file to the list of files a test's assertions were made from,
+*   which watch mode uses to find the tests affected by a change.
+*/
+static void unit_test_note_file(struct unit_test *test, const char *fname) {
+    for (int i = 0; i < test->file_count; i++)
+    {
+        if (test->files[i] == fname || strcmp(test->files[i], fname) == 0)
+        {
+            //keep the most recent file last, where the check in unit_test_report looks
+            test->files[i] = test->files[test->file_count - 1];
+            test->files[test->file_count - 1] = fname;
+            return;
+        }
+    }
+    test->files = realloc(test->files, (test->file_count + 1) * sizeof(const char *));
+    assert(test->files != NULL);
+    test->files[test->file_count++] = fname;
+}
+
+static void unit_test_report(struct unit_test_event *event) {
+    struct unit_test *test = event->test;
+    int slot = unit_test_thread_slot();
+    int owner = slot == test->owner;
+    event->thread = unit_test_stress_thread;
+    event->iteration = unit_test_stress_iteration;
+    unit_test_last_fname = event->fname;
+    unit_test_last_lineno = event->lineno;
+    if (!event->passed)
+    {
+        unit_test_trace_instant(UNIT_TEST_TRACE_FAILURE, unit_test_kinds[event->kind].title,
+            event->fname, event->lineno);
+    }
+
+    if (owner)
+    {
+        if (test->file_count == 0 || test->files[test->file_count - 1] != event->fname)
+        {
+            unit_test_note_file(test, event->fname);
+        }
+        event->index = test->num_passed + test->num_failed;
+        if (event->passed)
+        {
+            test->num_passed++;
+        }
+        else
+        {
+            test->num_failed++;
+        }
+    }
+    else
+    {
+        struct unit_test_shard *shard = unit_test_shard_for(test, slot);
+        if (event->passed)
+        {
+            __atomic_fetch_add(&shard->passed, 1, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            event->index = __atomic_fetch_add(&shard->failed, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    if (unit_test_repeat_sites != NULL)
+    {
+        unit_test_repeat_record(event);
+    }
+    else if (unit_test_bulk_examples > 0)
+    {
+        if (!event->passed)
+        {
+            unit_test_bulk_record(event);
+        }
+    }
+    else if (owner)
+    {
+        if (unit_test_capture != NULL)
+        {
+            unit_test_format_event(unit_test_capture, event);
+        }
+        else if (unit_test_async)
+        {
+            unit_test_async_push(event);
+        }
+        else
+        {
+            struct unit_test_buffer *out = &unit_test_scratch;
+            out->length = 0;
+            unit_test_format_event(out, event);
+            fwrite(out->data, 1, out->length, stdout);
+        }
+    }
+    else
+    {
+        if (!event->passed)
+        {
+            struct unit_test_buffer out = {0};
+            unit_test_format_event(&out, event);
+
+            struct unit_test_thread *self = unit_test_thread_self();
+            pthread_mutex_lock(&self->lock);
+            if (self->failure_count == self->failure_capacity)
+            {
+                self->failure_capacity = self->failure_capacity == 0 ? 16 : self->failure_capacity * 2;
+                self->failures = realloc(self->failures,
+                    self->failure_capacity * sizeof(struct unit_test_failure));
+                assert(self->failures != NULL);
+            }
+            struct unit_test_failure *failure = &self->failures[self->failure_count++];
+            failure->sequence = __atomic_fetch_add(&unit_test_failure_sequence, 1, __ATOMIC_RELAXED);
+            failure->test = test;
+            failure->length = out.length;
+            failure->text = unit_test_buffer_detach(&out);
+            pthread_mutex_unlock(&self->lock);
+        }
+    }
+    free(event->detail);
+    event->detail = NULL;
+
+    if (owner && !event->passed && unit_test_abort_suite && unit_test_current != NULL
+        && unit_test_current->test == test)
+    {
+        siglongjmp(unit_test_current->env, UNIT_TEST_JUMP_ABORT);
+    }
+}
+
+static void unit_test_fixture_teardown(struct unit_test_fixture *fixture);
+static void unit_test_release_fixtures(struct unit_test *test);
+static int unit_test_begin_suite(struct unit_test *test);
+static void unit_test_run_suite(struct unit_test *test, void (*start)());
+static void unit_test_finish_suite(struct unit_test *test, void (*print)());
+
+static int unit_test_compare_failures(const void *a, const void *b) {
+    const struct unit_test_failure *x = a;
+    const struct unit_test_failure *y = b;
+    return (x->sequence > y->sequence) - (x->sequence < y->sequence);
+}
+
+/*
+*   This function initializes a new unit test with a given name.
+*   
+*   @param name - char* array representing the name of the test case.
+*   @returns unit_test* pointer representing the new and initialized 
+*   unit test.
+*
+*   @author Brennan Hurst
+*   @version 10/07/2021
+*/
+struct unit_test* unit_test_init(char* name) {
+
+    tests = realloc(tests, (test_count + 1) * sizeof(struct unit_test*));
+    struct unit_test *u_test = calloc(1, sizeof(struct unit_test));
+    //printf("%d\n", sizeof(tests));
+    u_test->name = name;
+    u_test->num_passed = 0;
+    u_test->num_failed = 0;
+    u_test->owner = unit_test_thread_slot();
+    u_test->shards = NULL;
+    u_test->sites = NULL;
+    tests[test_count] = u_test;
+    test_count++;
+    return u_test;
+}
+
+/*
+*   This function folds the results of assertions made from threads other
+*   than the owning thread back into num_passed and num_failed, and prints
+*   any failures those threads recorded in the order they occurred. It is
+*   called by the summary functions, and only needs to be called directly
+*   when reading the counters of a multi-threaded test by hand.
+*
+*   @param *test - the unit_test you wish to merge.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_merge(struct unit_test *test) {
+    assert(test != NULL);
+    unit_test_async_drain();
+    struct unit_test_shard *shards = __atomic_load_n(&test->shards, __ATOMIC_ACQUIRE);
+    if (shards != NULL)
+    {
+        for (int i = 0; i < UNIT_TEST_MAX_SHARDS; i++)
+        {
+            test->num_passed += __atomic_exchange_n(&shards[i].passed, 0, __ATOMIC_RELAXED);
+            test->num_failed += __atomic_exchange_n(&shards[i].failed, 0, __ATOMIC_RELAXED);
+        }
+    }
+
+    struct unit_test_failure *merged = NULL;
+    int merged_count = 0;
+    pthread_mutex_lock(&unit_test_threads_lock);
+    for (struct unit_test_thread *thread = unit_test_threads; thread != NULL; thread = thread->next)
+    {
+        pthread_mutex_lock(&thread->lock);
+        int kept = 0;
+        for (int i = 0; i < thread->failure_count; i++)
+        {
+            if (thread->failures[i].test == test)
+            {
+                merged = realloc(merged, (merged_count + 1) * sizeof(struct unit_test_failure));
+                assert(merged != NULL);
+                merged[merged_count++] = thread->failures[i];
+            }
+            else
+            {
+                thread->failures[kept++] = thread->failures[i];
+            }
+        }
+        thread->failure_count = kept;
+        pthread_mutex_unlock(&thread->lock);
+    }
+    pthread_mutex_unlock(&unit_test_threads_lock);
+
+    qsort(merged, merged_count, sizeof(struct unit_test_failure), unit_test_compare_failures);
+    for (int i = 0; i < merged_count; i++)
+    {
+        fwrite(merged[i].text, 1, merged[i].length, stdout);
+        free(merged[i].text);
+    }
+    free(merged);
+    unit_test_bulk_flush(test);
+}
+
+/*
+*   This function prints a total summary of all unit test which have executed.
+*   It also reports to the user whether the program is passing as a whole, and 
+*   must be called by the user.
+*
+*   @author Brennan Hurst
+*   @version 10/10/2021
+*/
+void unit_test_print_total_summary() {
+    unit_test_async_drain();
+    for (int i = 0; i < test_count; i++)
+    {
+        unit_test_merge(tests[i]);
+    }
+    
+    printf("\033[1;37m================== Total Summary ==================\033[0m\n");
+    printf("\033[4mTest Name|                                   |Score\033[0m\n");
+    long long total_passing = 0;
+    long long total_failing = 0;
+    int total_aborted = 0;
+    int total_skipped = 0;
+    int total_crashed = 0;
+    int total_out_of_time = 0;
+    int total_filtered = 0;
+    double skipped_cost = 0;
+    for (int i = 0; i < test_count; i++)
+    {
+        int size = 0;
+        for(; tests[i]->name[size] != '\0'; size++);
+        if (tests[i]->status == UNIT_TEST_STATUS_SKIPPED)
+        {
+            printf("%s: \033[1;33m%*s\033[0m\n", tests[i]->name, 49 - size, "skipped");
+            total_skipped++;
+            continue;
+        }
+        if (tests[i]->status == UNIT_TEST_STATUS_OUT_OF_TIME)
+        {
+            printf("%s: \033[1;33m%*s\033[0m\n", tests[i]->name, 49 - size, "out of time");
+            total_out_of_time++;
+            skipped_cost += tests[i]->cost;
+            continue;
+        }
+        if (tests[i]->status == UNIT_TEST_STATUS_FILTERED)
+        {
+            total_filtered++;
+            continue;
+        }
+        if (tests[i]->status == UNIT_TEST_STATUS_ABORTED)
+        {
+            printf("%s: \033[1;31m(aborted)\033[0m%*lld/%lld\n", tests[i]->name, 38 - size,
+                tests[i]->num_passed, tests[i]->num_failed + tests[i]->num_passed);
+            total_aborted++;
+        }
+        else if (tests[i]->status == UNIT_TEST_STATUS_CRASHED)
+        {
+            printf("%s: \033[1;31m(crashed)\033[0m%*lld/%lld\n", tests[i]->name, 38 - size,
+                tests[i]->num_passed, tests[i]->num_failed + tests[i]->num_passed);
+            total_crashed++;
+        }
+        else
+        {
+            printf("%s: %*lld/%lld\n", tests[i]->name, 47 - size, tests[i]->num_passed,
+                tests[i]->num_failed + tests[i]->num_passed);
+        }
+        total_passing += tests[i]->num_passed;
+        total_failing += tests[i]->num_failed;
+    }
+    printf("---------------------------------------------------\n");
+    printf("# of Assertions Passing: \033[1;32m%*lld\033[0m\n", 26, total_passing);
+    printf("# of Assertions Failing: \033[1;31m%*lld\033[0m\n", 26, total_failing);
+    if (total_aborted > 0)
+    {
+        printf("# of Tests Aborted: \033[1;31m%*d\033[0m\n", 31, total_aborted);
+    }
+    if (total_crashed > 0)
+    {
+        printf("# of Tests Crashed: \033[1;31m%*d\033[0m\n", 31, total_crashed);
+    }
+    if (total_skipped > 0)
+    {
+        printf("# of Tests Skipped: \033[1;33m%*d\033[0m\n", 31, total_skipped);
+    }
+    if (total_out_of_time > 0)
+    {
+        printf("# of Tests Out of Time: \033[1;33m%*d\033[0m\n", 27, total_out_of_time);
+        printf("Estimated Time Skipped: \033[1;33m%*.3fs\033[0m\n", 26, skipped_cost);
+    }
+    if (total_filtered > 0)
+    {
+        printf("# of Tests Filtered Out: %*d\n", 26, total_filtered);
+    }
+    printf("Overall Status: ");
+
+    if (total_failing == 0)
+    {
+        printf("\033[1;32m%*s\033[0m\n", 35, "PASSING");
+    }
+    else
+    {
+        printf("\033[1;31m%*s\033[0m\n", 28, "FAILING");
+    }
+
+    if (fixture_count > 0)
+    {
+        printf("---------------------------------------------------\n");
+        printf("\033[4mFixture Name|                         |Setup Time\033[0m\n");
+        for (int i = 0; i < fixture_count; i++)
+        {
+            int size = 0;
+            for(; fixtures[i]->name[size] != '\0'; size++);
+            printf("%s: %*.3fs\n", fixtures[i]->name, 48 - size, fixtures[i]->build_time);
+            if (!unit_test_watching)
+            {
+                unit_test_fixture_teardown(fixtures[i]);
+            }
+        }
+    }
+    printf("===================================================\n");
+
+}
+
+/*
+*   This function starts a unit test and is responsible for executing
+*   and printing out the unit test.
+*   
+*   @param *test - unit_test structure representing the test you will be
+*       running.
+*   @param void (*start)() - function pointer representing the start funciton 
+*       for the unit test.
+*   @param void (*print)() - function pointer representing the print 
+*       function for the unit test. If NULL, the print function defaults to 
+*       the built-in print funciton.
+*
+*   @author Brennan Hurst
+*   @version 10/07/2021
+*/
+void unit_test_start(struct unit_test *test, void (*start)(), void (*print)()) {
+    assert(test != NULL);
+    assert(start != NULL);
+    test->start = start;
+    test->print = print;
+    if (!unit_test_begin_suite(test))
+    {
+        return;
+    }
+    double started = unit_test_now();
+    unit_test_run_suite(test, start);
+    unit_test_finish_suite(test, print);
+    test->duration = unit_test_now() - started;
+    //free(test);
+}
+
+/*
+*   This function configures fail-fast behaviour for unit_test_start and
+*   unit_test_start_forked. Both settings are off by default.
+*
+*   @param abort_suite - if non-zero, the first failed assertion in a test
+*       jumps straight back out of its start function, skipping the rest of
+*       the test. Only failures on the thread running the test abort it.
+*       The start function does not get a chance to clean up.
+*   @param max_failed_suites - if positive, once this many tests have
+*       failed every test started afterwards is skipped.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_set_fail_fast(int abort_suite, int max_failed_suites) {
+    unit_test_abort_suite = abort_suite;
+    unit_test_max_failed_suites = max_failed_suites;
+}
+
+/*
+*   Handles a crash signal. If the crash happened inside a start function
+*   on this thread, it jumps back to unit_test_run_suite(). Otherwise the
+*   handler which was installed before crash recovery was turned on gets
+*   the signal instead.
+*/
+static void unit_test_crash_signal(int signal, siginfo_t *info, void *ucontext) {
+    struct unit_test_context *context = unit_test_current;
+    if (__atomic_load_n(&unit_test_crash_recovery, __ATOMIC_RELAXED) && context != NULL)
+    {
+        context->signal = signal;
+        context->code = info->si_code;
+        context->address = info->si_addr;
+        siglongjmp(context->env, UNIT_TEST_JUMP_CRASH);
+    }
+    sigaction(signal, &unit_test_crash_previous[signal], NULL);
+    raise(signal);
+}
+
+/*
+*   Gives the calling thread an alternate signal stack, so that a test
+*   which crashes by overflowing its stack can still be recovered. If the
+*   stack cannot be installed other crashes are still recovered.
+*/
+static void unit_test_crash_stack_init() {
+    if (unit_test_crash_stack != NULL)
+    {
+        return;
+    }
+    size_t size = SIGSTKSZ < 65536 ? 65536 : SIGSTKSZ;
+    unit_test_crash_stack = malloc(size);
+    assert(unit_test_crash_stack != NULL);
+    stack_t stack;
+    stack.ss_sp = unit_test_crash_stack;
+    stack.ss_size = size;
+    stack.ss_flags = 0;
+    if (sigaltstack(&stack, NULL) != 0)
+    {
+        fprintf(stderr, "unit_test: could not install a signal stack, stack overflows will not be recovered: %s\n",
+            strerror(errno));
+        free(unit_test_crash_stack);
+        unit_test_crash_stack = NULL;
+    }
+}
+
+/*
+*   This function turns in-process crash recovery on or off. It is off by
+*   default. While it is on, a SIGSEGV, SIGBUS, SIGFPE or SIGABRT raised on
+*   the thread running a test's start function jumps back to
+*   unit_test_start, which marks the test as crashed and lets the program
+*   carry on with the next test. The crash is reported along with the last
+*   assertion the thread made before it. This is much faster than running
+*   every test with unit_test_start_forked, but gives up its isolation:
+*   memory the crashed test corrupted, and any locks or resources it held,
+*   stay as they are. Crashes on other threads still end the program.
+*
+*   @param enabled - non-zero to turn crash recovery on.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_set_crash_recovery(int enabled) {
+    if (enabled && !unit_test_crash_recovery)
+    {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = &unit_test_crash_signal;
+        action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+        sigemptyset(&action.sa_mask);
+        for (size_t i = 0; i < sizeof(unit_test_crash_signals) / sizeof(int); i++)
+        {
+            sigaction(unit_test_crash_signals[i], &action,
+                &unit_test_crash_previous[unit_test_crash_signals[i]]);
+        }
+        __atomic_store_n(&unit_test_crash_recovery, 1, __ATOMIC_RELEASE);
+    }
+    else if (!enabled && unit_test_crash_recovery)
+    {
+        __atomic_store_n(&unit_test_crash_recovery, 0, __ATOMIC_RELEASE);
+        for (size_t i = 0; i < sizeof(unit_test_crash_signals) / sizeof(int); i++)
+        {
+            sigaction(unit_test_crash_signals[i],
+                &unit_test_crash_previous[unit_test_crash_signals[i]], NULL);
+        }
+    }
+}
+
+/*
+*   Prepares a test to run, returning zero if it should be skipped because
+*   the run has already seen too many failing tests.
+*/
+static int unit_test_begin_suite(struct unit_test *test) {
+    test->owner = unit_test_thread_slot();
+    if (unit_test_max_failed_suites > 0
+        && __atomic_load_n(&unit_test_failed_suites, __ATOMIC_RELAXED) >= unit_test_max_failed_suites)
+    {
+        test->status = UNIT_TEST_STATUS_SKIPPED;
+        printf("\033[1;33mSkipping %s: %d tests have already failed.\033[0m\n\n",
+            test->name, unit_test_max_failed_suites);
+        unit_test_release_fixtures(test);
+        return 0;
+    }
+    unit_test_print_header(test);
+    return 1;
+}
+
+/*
+*   Calls a test's start function, catching the jump made when fail-fast
+*   aborts it or when crash recovery catches it crashing. The signal mask
+*   only needs saving in the second case, since the jump is made from a
+*   signal handler.
+*/
+static void unit_test_run_suite(struct unit_test *test, void (*start)()) {
+    struct unit_test_context context;
+    context.test = test;
+    context.signal = 0;
+    context.code = 0;
+    context.address = NULL;
+    context.previous = unit_test_current;
+    int recover = __atomic_load_n(&unit_test_crash_recovery, __ATOMIC_ACQUIRE);
+    if (recover)
+    {
+        unit_test_crash_stack_init();
+    }
+    unit_test_last_fname = NULL;
+    unit_test_current = &context;
+    long long traced = unit_test_trace_begin();
+    int jumped = sigsetjmp(context.env, recover);
+    if (jumped == 0)
+    {
+        start(test);
+    }
+    else if (jumped == UNIT_TEST_JUMP_ABORT)
+    {
+        test->status = UNIT_TEST_STATUS_ABORTED;
+    }
+    else if (jumped == UNIT_TEST_JUMP_DEADLINE)
+    {
+        //the missed deadline has already been reported as a failure
+    }
+    else
+    {
+        //a second crash while reporting this one goes to the enclosing suite
+        unit_test_current = context.previous;
+        unit_test_stress_thread = -1;
+        test->status = UNIT_TEST_STATUS_CRASHED;
+        test->num_failed++;
+        unit_test_async_drain();
+        printf("\n\033[1;31mRecovered %s from signal %d (%s)",
+            test->name, context.signal, strsignal(context.signal));
+        //only faults raised by the kernel have an address
+        if (context.code > 0)
+        {
+            printf(" at address %p", context.address);
+        }
+        if (unit_test_last_fname != NULL)
+        {
+            printf(", after the assertion in file %s at line %d", unit_test_last_fname,
+                unit_test_last_lineno);
+        }
+        printf(".\033[0m\n");
+    }
+    unit_test_trace_end(UNIT_TEST_TRACE_SUITE, test->name, traced);
+    unit_test_current = context.previous;
+}
+
+/*
+*   Prints a test's results, works out whether it passed, and releases its
+*   fixtures.
+*/
+static void unit_test_finish_suite(struct unit_test *test, void (*print)()) {
+    unit_test_async_drain();
+    if (test->status == UNIT_TEST_STATUS_ABORTED)
+    {
+        printf("\033[1;31mAborted %s after its first failure.\033[0m\n", test->name);
+    }
+    if (print == NULL) {
+        unit_test_print_summary(test);
+    }
+    else
+    {
+        unit_test_merge(test);
+        print(test);
+    }
+    if (test->status != UNIT_TEST_STATUS_ABORTED && test->status != UNIT_TEST_STATUS_CRASHED)
+    {
+        test->status = test->num_failed > 0 ? UNIT_TEST_STATUS_FAILED : UNIT_TEST_STATUS_PASSED;
+    }
+    if (test->status != UNIT_TEST_STATUS_PASSED)
+    {
+        __atomic_fetch_add(&unit_test_failed_suites, 1, __ATOMIC_RELAXED);
+    }
+    unit_test_release_fixtures(test);
+}
+
+/*
+*   This function prints the header for the unit test section. It is used as 
+*   a helper function and may be useful for inline printing. 
+*
+*   @param *test - the unit_test you wish to print out.
+*
+*   @author Brennan Hurst
+*   @version 10/09/2021
+*/
+void unit_test_print_header(struct unit_test *test) {
+    assert(test != NULL);
+    unit_test_async_drain();
+    printf("======================================== %s "
+        "Results ========================================\n\n", 
+        test->name);
+}
+
+/*
+*   This function takes a unit_test struct and prints out the results to 
+*   standard output.
+*
+*   @param *test - the unit_test you wish to print out. 
+*
+*   @author Brennan Hurst
+*   @version 10/07/2021
+*/
+void unit_test_print_summary(struct unit_test *test) {
+    assert(test != NULL);    
+    unit_test_merge(test);
+    int size = 0;
+    for (; test->name[size + 1] != '\0'; size++);
+    printf("\n\033[1;37m========== %s Summary ==========\033[0m\n", test->name);
+
+    printf("\033[1;37mTotal Tests:%*lld\033[0m\n", 
+        19 + size, test->num_passed + test->num_failed);
+    
+    printf("\033[1;37mTests Passed: \033[1;32m%*lld\033[0m\n", 
+        17 + size, test->num_passed);
+    
+    printf("\033[1;37mTests Failed: \033[1;31m%*lld\033[0m\n", 
+        17 + size, test->num_failed);
+    
+    float percentPassing = 100;
+    
+    if (test->num_failed > 0)
+    {
+        percentPassing = ((float) (test->num_passed) / 
+            (float) (test->num_failed + test->num_passed)) * 100;
+    }
+
+    if (percentPassing >= 90) {
+        printf("\033[1;37mPercent Passing: \033[1;32m%*.2f%%\033[0m\n", 
+        13 + size, percentPassing);
+    }
+    else if (percentPassing > 50) {
+        printf("\033[1;37mPercent Passing: \033[1;33m%*.2f%%\033[0m\n", 
+        13 + size, percentPassing);
+    }
+    else {
+        printf("\033[1;37mPercent Passing: \033[1;31m%*.2f%%\033[0m\n", 
+        13 + size, percentPassing);
+    }
+
+    int run = 1;
+    for (struct unit_test_stress_result *result = test->stress; result != NULL; result = result->next, run++)
+    {
+        printf("\033[1;37mStress Run %d:\033[0m %d threads, %lld operations in %.3fs"
+            " (\033[1;36m%.0f ops/sec\033[0m)\n", run, result->threads, result->operations,
+            result->seconds, result->seconds > 0 ? result->operations / result->seconds : 0.0);
+        for (int i = 0; i < result->threads; i++)
+        {
+            printf("\tThread %d: %lld operations (%.0f ops/sec)\n", i, result->completed[i],
+                result->elapsed[i] > 0 ? result->completed[i] / result->elapsed[i] : 0.0);
+        }
+    }
+
+    run = 1;
+    for (struct unit_test_benchmark_result *result = test->benchmarks; result != NULL; result = result->next, run++)
+    {
+        printf("\033[1;37mBenchmark %d:\033[0m %s, %d samples of %ld calls", run,
+            result->name != NULL ? result->name : "body", result->samples, result->iterations);
+        if (result->cpu >= 0)
+        {
+            printf(" on CPU %d", result->cpu);
+        }
+        printf("\n\tmean %.2f ns, median %.2f ns, min %.2f ns, CV %.2f%% ", result->mean * 1e9,
+            result->median * 1e9, result->min * 1e9, result->cv * 100);
+        if (result->cv > result->max_cv)
+        {
+            printf("(\033[1;33mUNSTABLE\033[0m, above %.2f%%)\n", result->max_cv * 100);
+        }
+        else
+        {
+            printf("(\033[1;32mstable\033[0m)\n");
+        }
+        if (result->warnings != NULL)
+        {
+            printf("\033[1;33m%s\033[0m", result->warnings);
+        }
+    }
+
+    run = 1;
+    for (struct unit_test_histogram *histogram = test->histograms; histogram != NULL;
+        histogram = histogram->next, run++)
+    {
+        unit_test_histogram_print(histogram, run);
+    }
+
+    run = 1;
+    for (struct unit_test_stream_result *result = test->streams; result != NULL; result = result->next, run++)
+    {
+        printf("\033[1;37mStream Comparison %d:\033[0m %s against %s, %llu bytes in %.3fs"
+            " (\033[1;36m%.2f GB/s\033[0m)\n", run, result->actual, result->expected, result->bytes,
+            result->seconds, result->seconds > 0 ? result->bytes / result->seconds / 1e9 : 0.0);
+    }
+
+    run = 1;
+    for (struct unit_test_differential_result *result = test->differentials; result != NULL;
+        result = result->next, run++)
+    {
+        double inputs = result->inputs > 0 ? (double) result->inputs : 1.0;
+        printf("\033[1;37mDifferential Run %d:\033[0m %s, %lld inputs, reference %.2f ns/input,"
+            " candidate %.2f ns/input (\033[1;36m%.2fx speedup\033[0m)\n", run, result->name, result->inputs,
+            result->reference_ns / inputs, result->candidate_ns / inputs,
+            result->candidate_ns > 0 ? (double) result->reference_ns / result->candidate_ns : 0.0);
+    }
+    
+    printf("\033[1;37m");
+    
+    for (int i = 0; i < 31 + size; i++)
+    {
+        printf("=");
+    }
+    
+    printf("\033[0m\n\n");
+}
+
+/*
+*   This function starts a unit test in a child process, so that a crash or
+*   stray write in the test cannot affect the tests which run after it.
+*   Fixtures declared by the test are built in the parent before forking,
+*   which means snapshot fixtures are built once and mapped copy-on-write
+*   into every child. The child's results are sent back to the parent and
+*   counted against the test as usual. A child which dies is counted as a
+*   failure.
+*
+*   @param *test - unit_test structure representing the test you will be
+*       running.
+*   @param void (*start)() - function pointer representing the start funciton
+*       for the unit test.
+*   @param void (*print)() - function pointer representing the print
+*       function for the unit test. If NULL, the print function defaults to
+*       the built-in print funciton.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_start_forked(struct unit_test *test, void (*start)(), void (*print)()) {
+    assert(test != NULL);
+    assert(start != NULL);
+    test->start = start;
+    test->print = print;
+    if (!unit_test_begin_suite(test))
+    {
+        return;
+    }
+    for (int i = 0; i < test->fixture_count; i++)
+    {
+        unit_test_fixture_get(test, test->fixtures[i]);
+    }
+
+    double started = unit_test_now();
+    unit_test_async_drain();
+    int results[2];
+    pid_t child = -1;
+    if (pipe(results) == 0)
+    {
+        fflush(stdout);
+        fflush(stderr);
+        child = fork();
+        if (child < 0)
+        {
+            int error = errno;
+            close(results[0]);
+            close(results[1]);
+            errno = error;
+        }
+    }
+    if (child < 0)
+    {
+        printf("\033[1;31m%s: could not start a child process: %s.\033[0m\n", test->name, strerror(errno));
+        test->num_failed++;
+        unit_test_finish_suite(test, print);
+        test->duration = unit_test_now() - started;
+        return;
+    }
+    if (child == 0)
+    {
+        close(results[0]);
+        unit_test_run_suite(test, start);
+        unit_test_merge(test);
+        fflush(stdout);
+        long long counts[3] = {test->num_passed, test->num_failed, test->status};
+        ssize_t written = write(results[1], counts, sizeof(counts));
+        _exit(written == (ssize_t) sizeof(counts) ? 0 : 1);
+    }
+
+    close(results[1]);
+    long long counts[3];
+    ssize_t got;
+    do
+    {
+        got = read(results[0], counts, sizeof(counts));
+    } while (got < 0 && errno == EINTR);
+    close(results[0]);
+    int status;
+    while (waitpid(child, &status, 0) < 0 && errno == EINTR);
+
+    if (got == (ssize_t) sizeof(counts))
+    {
+        test->num_passed += counts[0];
+        test->num_failed += counts[1];
+        test->status = counts[2];
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || got != (ssize_t) sizeof(counts))
+    {
+        test->num_failed++;
+        if (WIFSIGNALED(status))
+        {
+            printf("\033[1;31m%s: child process was killed by signal %d (%s).\033[0m\n",
+                test->name, WTERMSIG(status), strsignal(WTERMSIG(status)));
+        }
+        else
+        {
+            printf("\033[1;31m%s: child process exited with status %d.\033[0m\n",
+                test->name, WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        }
+    }
+
+    unit_test_finish_suite(test, print);
+    test->duration = unit_test_now() - started;
+}
+
+/*
+*   State shared between unit_test_repeat() and its worker processes.
+*   Iterations are handed out in order from next, so once an iteration has
+*   failed every earlier one has already been started, and workers stop
+*   taking new ones. current holds the iteration each worker is running,
+*   so one which kills its worker can still be reported.
+*/
+struct unit_test_repeat_state {
+    long next;
+    long first_failure;
+    long long completed;
+    long long failed_iterations;
+    long long passed;
+    long long failed;
+    long current[];
+};
+
+/*
+*   Returns the seed for an iteration. Seeds are a mix of the base seed and
+*   the iteration number, so each iteration gets the same one whichever
+*   worker runs it.
+*/
+static unsigned long long unit_test_repeat_seed(unsigned long long base, long iteration) {
+    unsigned long long seed = base + 0x9E3779B97F4A7C15ULL * (unsigned long long) (iteration + 1);
+    seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+    return seed ^ (seed >> 31);
+}
+
+/*
+*   Sends the call site counts gathered since the last call to the parent
+*   and clears them. Counts are sent after every iteration, so one which
+*   kills its worker only loses its own.
+*/
+static void unit_test_repeat_send(int results) {
+    struct unit_test_sites *sites = unit_test_repeat_sites;
+    size_t length = sites->count * sizeof(struct unit_test_site);
+    const char *data = (const char *) sites->entries;
+    while (length > 0)
+    {
+        ssize_t written = write(results, data, length);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            _exit(1);
+        }
+        data += written;
+        length -= written;
+    }
+    sites->count = 0;
+    if (sites->slots != NULL)
+    {
+        memset(sites->slots, -1, sites->slot_capacity * sizeof(int));
+    }
+}
+
+/*
+*   Runs iterations of a test in a worker process until there are none
+*   left.
+*/
+static void unit_test_repeat_worker(struct unit_test *test, struct unit_test_repeat *options,
+    struct unit_test_repeat_state *state, int worker, int results) {
+    int null = open("/dev/null", O_WRONLY);
+    if (null >= 0)
+    {
+        dup2(null, STDOUT_FILENO);
+        close(null);
+    }
+    unit_test_repeat_sites = calloc(1, sizeof(struct unit_test_sites));
+    assert(unit_test_repeat_sites != NULL);
+    pthread_mutex_init(&unit_test_repeat_sites->lock, NULL);
+    test->owner = unit_test_thread_slot();
+    for (;;)
+    {
+        long iteration = __atomic_fetch_add(&state->next, 1, __ATOMIC_ACQ_REL);
+        if (iteration >= options->iterations || (options->until_failure
+            && iteration > __atomic_load_n(&state->first_failure, __ATOMIC_ACQUIRE)))
+        {
+            break;
+        }
+        __atomic_store_n(&state->current[worker], iteration, __ATOMIC_RELEASE);
+        unit_test_repeat_iteration = iteration;
+        unit_test_current_seed = unit_test_repeat_seed(options->seed, iteration);
+        test->num_passed = 0;
+        test->num_failed = 0;
+        test->status = UNIT_TEST_STATUS_NOT_RUN;
+        unit_test_run_suite(test, test->start);
+        unit_test_merge(test);
+        __atomic_fetch_add(&state->passed, test->num_passed, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&state->failed, test->num_failed, __ATOMIC_RELAXED);
+        if (test->num_failed > 0 || test->status == UNIT_TEST_STATUS_CRASHED)
+        {
+            __atomic_fetch_add(&state->failed_iterations, 1, __ATOMIC_RELAXED);
+            long first = __atomic_load_n(&state->first_failure, __ATOMIC_ACQUIRE);
+            while (iteration < first && !__atomic_compare_exchange_n(&state->first_failure, &first, iteration, 0,
+                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+        }
+        unit_test_repeat_send(results);
+        __atomic_fetch_add(&state->completed, 1, __ATOMIC_RELEASE);
+        __atomic_store_n(&state->current[worker], -1, __ATOMIC_RELEASE);
+    }
+    fflush(stdout);
+    _exit(0);
+}
+
+static pid_t unit_test_repeat_spawn(struct unit_test *test, struct unit_test_repeat *options,
+    struct unit_test_repeat_state *state, int worker, int *results) {
+    int pipes[2];
+    int piped = pipe2(pipes, O_CLOEXEC);
+    assert(piped == 0);
+    __atomic_store_n(&state->current[worker], -1, __ATOMIC_RELEASE);
+    fflush(stdout);
+    fflush(stderr);
+    pid_t child = fork();
+    assert(child >= 0);
+    if (child == 0)
+    {
+        close(pipes[0]);
+        unit_test_trace_lane(getppid(), worker + 1);
+        unit_test_repeat_worker(test, options, state, worker, pipes[1]);
+    }
+    close(pipes[1]);
+    *results = pipes[0];
+    return child;
+}
+
+/*
+*   Adds the call site counts a worker has sent so far to the totals,
+*   keeping any partly received entry for next time.
+*/
+static void unit_test_repeat_collect(struct unit_test_sites *totals, struct unit_test_buffer *received) {
+    struct unit_test_site *entries = (struct unit_test_site *) received->data;
+    size_t count = received->length / sizeof(struct unit_test_site);
+    for (size_t i = 0; i < count; i++)
+    {
+        struct unit_test_site *site = unit_test_site_find(totals, entries[i].fname, entries[i].lineno,
+            entries[i].kind);
+        if (site->checked == 0)
+        {
+            site->first_iteration = -1;
+        }
+        site->checked += entries[i].checked;
+        site->count += entries[i].count;
+        site->failed_iterations += entries[i].failed_iterations;
+        if (entries[i].first_iteration >= 0
+            && (site->first_iteration < 0 || entries[i].first_iteration < site->first_iteration))
+        {
+            site->first_iteration = entries[i].first_iteration;
+        }
+    }
+    size_t used = count * sizeof(struct unit_test_site);
+    memmove(received->data, received->data + used, received->length - used);
+    received->length -= used;
+}
+
+/*
+*   Orders call sites by the number of iterations they failed in, most
+*   first.
+*/
+static int unit_test_repeat_compare(const void *x, const void *y) {
+    const struct unit_test_site *a = x;
+    const struct unit_test_site *b = y;
+    if (a->failed_iterations != b->failed_iterations)
+    {
+        return a->failed_iterations > b->failed_iterations ? -1 : 1;
+    }
+    return a->lineno - b->lineno;
+}
+
+/*
+*   This function runs a test over and over to catch failures which only
+*   happen some of the time. It reuses the start and print functions the
+*   test was given by unit_test_start, unit_test_start_forked or
+*   unit_test_register, resetting num_passed and num_failed before every
+*   iteration. Iterations run in worker processes with their output thrown
+*   away; each gets its own seed, returned by unit_test_seed, which does
+*   not depend on the worker running it.
+*
+*   Afterwards the number of failing iterations is printed along with how
+*   often each assertion failed, and the first failing iteration is run
+*   again with its seed and its output shown, using
+*   unit_test_start_forked. The test's results are those of that iteration,
+*   or the totals over every iteration if none failed. An iteration which
+*   crashes its worker is counted as failing and a new worker carries on.
+*
+*   @param *test - the unit_test to repeat. It must have a start function.
+*   @param *options - the number of iterations, whether to stop at the
+*       first failure, the number of worker processes and the base seed.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_repeat(struct unit_test *test, struct unit_test_repeat *options) {
+    assert(test != NULL);
+    assert(test->start != NULL);
+    assert(options != NULL && options->iterations > 0);
+    int jobs = options->jobs > 1 ? options->jobs : 1;
+    for (int i = 0; i < test->fixture_count; i++)
+    {
+        unit_test_fixture_get(test, test->fixtures[i]);
+    }
+    size_t size = sizeof(struct unit_test_repeat_state) + jobs * sizeof(long);
+    struct unit_test_repeat_state *state = mmap(NULL, size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    assert(state != MAP_FAILED);
+    memset(state, 0, size);
+    state->first_failure = options->iterations;
+    pid_t *children = calloc(jobs, sizeof(pid_t));
+    int *results = calloc(jobs, sizeof(int));
+    struct unit_test_buffer *received = calloc(jobs, sizeof(struct unit_test_buffer));
+    struct pollfd *pollers = calloc(jobs, sizeof(struct pollfd));
+    assert(children != NULL && results != NULL && received != NULL && pollers != NULL);
+    struct unit_test_sites totals = {0};
+    pthread_mutex_init(&totals.lock, NULL);
+
+    unit_test_async_drain();
+    unit_test_trace_lanes(jobs);
+    double started = unit_test_now();
+    for (int i = 0; i < jobs; i++)
+    {
+        children[i] = unit_test_repeat_spawn(test, options, state, i, &results[i]);
+    }
+    int running = jobs;
+    long long crashed = 0;
+    while (running > 0)
+    {
+        for (int i = 0; i < jobs; i++)
+        {
+            pollers[i].fd = children[i] > 0 ? results[i] : -1;
+            pollers[i].events = POLLIN;
+            pollers[i].revents = 0;
+        }
+        if (poll(pollers, jobs, -1) < 0)
+        {
+            continue;
+        }
+        for (int i = 0; i < jobs; i++)
+        {
+            if (children[i] <= 0 || pollers[i].revents == 0)
+            {
+                continue;
+            }
+            char chunk[65536];
+            ssize_t got = read(results[i], chunk, sizeof(chunk));
+            if (got > 0)
+            {
+                unit_test_buffer_append(&received[i], chunk, got);
+                unit_test_repeat_collect(&totals, &received[i]);
+                continue;
+            }
+            if (got < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            close(results[i]);
+            int status;
+            while (waitpid(children[i], &status, 0) < 0 && errno == EINTR);
+            children[i] = 0;
+            running--;
+            received[i].length = 0;
+            if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+            {
+                continue;
+            }
+
+            //the worker died part way through an iteration, which counts as a failure
+            long iteration = __atomic_load_n(&state->current[i], __ATOMIC_ACQUIRE);
+            if (iteration >= 0)
+            {
+                crashed++;
+                __atomic_fetch_add(&state->completed, 1, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&state->failed_iterations, 1, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&state->failed, 1, __ATOMIC_RELAXED);
+                long first = __atomic_load_n(&state->first_failure, __ATOMIC_ACQUIRE);
+                while (iteration < first && !__atomic_compare_exchange_n(&state->first_failure, &first,
+                    iteration, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+            }
+            if (__atomic_load_n(&state->next, __ATOMIC_ACQUIRE) < options->iterations
+                && (!options->until_failure || iteration < 0))
+            {
+                children[i] = unit_test_repeat_spawn(test, options, state, i, &results[i]);
+                running++;
+            }
+        }
+    }
+    double elapsed = unit_test_now() - started;
+
+    long long completed = state->completed;
+    long long failing = state->failed_iterations;
+    long first = failing > 0 ? state->first_failure : -1;
+    int size_name = 0;
+    for (; test->name[size_name + 1] != '\0'; size_name++);
+    printf("\033[1;37m========== %s Repeat ==========\033[0m\n", test->name);
+    printf("Iterations Run:%*lld\n", 16 + size_name, completed);
+    printf("Failing Iterations: \033[1;31m%*lld\033[0m\n", 11 + size_name, failing);
+    printf("Failure Rate:%*.2f%%\n", 17 + size_name, completed > 0 ? 100.0 * failing / completed : 0.0);
+    printf("Workers:%*d\n", 23 + size_name, jobs);
+    printf("Time:%*.3fs\n", 25 + size_name, elapsed);
+    if (crashed > 0)
+    {
+        printf("Crashed Iterations: \033[1;31m%*lld\033[0m\n", 11 + size_name, crashed);
+    }
+    qsort(totals.entries, totals.count, sizeof(struct unit_test_site), &unit_test_repeat_compare);
+    for (int i = 0; i < totals.count && totals.entries[i].failed_iterations > 0; i++)
+    {
+        struct unit_test_site *site = &totals.entries[i];
+        printf("\t\033[1;36m%s\033[0m in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m failed in"
+            " %lld of %lld iterations (%.2f%%) and %lld of %lld checks, first in iteration %ld.\n",
+            unit_test_kinds[site->kind].title, site->fname, site->lineno, site->failed_iterations,
+            completed, completed > 0 ? 100.0 * site->failed_iterations / completed : 0.0,
+            site->count, site->checked, site->first_iteration);
+    }
+    printf("\n");
+
+    unsigned long long seed = unit_test_current_seed;
+    if (first >= 0)
+    {
+        printf("\033[1;31mFirst failing iteration: %ld, seed 0x%016llx.\033[0m Running it again:\n\n",
+            first, unit_test_repeat_seed(options->seed, first));
+        unit_test_current_seed = unit_test_repeat_seed(options->seed, first);
+        test->num_passed = 0;
+        test->num_failed = 0;
+        test->status = UNIT_TEST_STATUS_NOT_RUN;
+        unit_test_start_forked(test, test->start, test->print);
+        if (test->status == UNIT_TEST_STATUS_PASSED)
+        {
+            printf("\033[1;33mIteration %ld did not fail again when it was run on its own.\033[0m\n\n", first);
+            test->num_failed++;
+            test->status = UNIT_TEST_STATUS_FAILED;
+            __atomic_fetch_add(&unit_test_failed_suites, 1, __ATOMIC_RELAXED);
+        }
+    }
+    else
+    {
+        test->num_passed = state->passed;
+        test->num_failed = 0;
+        test->status = UNIT_TEST_STATUS_PASSED;
+        unit_test_release_fixtures(test);
+    }
+    unit_test_current_seed = seed;
+    test->duration = completed > 0 ? elapsed * jobs / completed : 0;
+
+    for (int i = 0; i < jobs; i++)
+    {
+        free(received[i].data);
+    }
+    free(totals.slots);
+    free(totals.entries);
+    pthread_mutex_destroy(&totals.lock);
+    free(children);
+    free(results);
+    free(received);
+    free(pollers);
+    munmap(state, size);
+}
+
+/*
+*   This function repeats every test which has a start function and has
+*   not been filtered out of a run, one after the other, with
+*   unit_test_repeat.
+*
+*   @param *options - the options passed to unit_test_repeat for each test.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_repeat_all(struct unit_test_repeat *options) {
+    int count = test_count;
+    for (int i = 0; i < count; i++)
+    {
+        if (tests[i]->start != NULL && tests[i]->status != UNIT_TEST_STATUS_FILTERED)
+        {
+            unit_test_repeat(tests[i], options);
+        }
+    }
+}
+
+/*
+*   This function returns the seed of the iteration being run by
+*   unit_test_repeat. Tests which make random choices should draw them from
+*   this seed so that a failing iteration can be run again exactly. Outside
+*   unit_test_repeat it returns the same fixed seed every time.
+*
+*   @return the current iteration's seed.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+unsigned long long unit_test_seed() {
+    return unit_test_current_seed;
+}
+
+/*
+*   Async tests run as coroutines, each on its own stack, switched between
+*   by a loop on the thread which calls unit_test_run_async(). A coroutine
+*   runs until it waits for a file descriptor or a timer, when it switches
+*   back to the loop; the loop waits in epoll_wait() for whatever the
+*   coroutines are waiting on and resumes the ones which are ready. Timers
+*   are kept in a binary heap, and an entry is ignored if its coroutine has
+*   been woken since it was added, so waking never has to search the heap.
+*/
+#define UNIT_TEST_COROUTINE_STACK (512 * 1024)
+
+struct unit_test_coroutine {
+    struct unit_test *test;
+    void (*start)();
+    void (*print)();
+    double deadline;
+    double started;
+    double expires;
+    ucontext_t context;
+    void *stack;
+    struct unit_test_buffer output;
+    struct unit_test_context *current;
+    const char *last_fname;
+    int last_lineno;
+    int finished;
+    int waiting;
+    int revents;
+    unsigned long generation;
+    struct unit_test_coroutine *next;
+};
+
+struct unit_test_timer {
+    double when;
+    struct unit_test_coroutine *coroutine;
+    unsigned long generation;
+};
+
+struct unit_test_loop {
+    ucontext_t context;
+    int epoll;
+    struct unit_test_coroutine *ready;
+    struct unit_test_coroutine *ready_tail;
+    struct unit_test_timer *timers;
+    int timer_count;
+    int timer_capacity;
+};
+
+static struct unit_test_coroutine *unit_test_coroutines = NULL;
+static struct unit_test_coroutine *unit_test_coroutines_tail = NULL;
+static __thread struct unit_test_loop *unit_test_current_loop = NULL;
+static __thread struct unit_test_coroutine *unit_test_coroutine_running = NULL;
+
+static void unit_test_timer_push(struct unit_test_loop *loop, double when, struct unit_test_coroutine *coroutine) {
+    if (loop->timer_count == loop->timer_capacity)
+    {
+        loop->timer_capacity = loop->timer_capacity == 0 ? 64 : loop->timer_capacity * 2;
+        loop->timers = realloc(loop->timers, loop->timer_capacity * sizeof(struct unit_test_timer));
+        assert(loop->timers != NULL);
+    }
+    int i = loop->timer_count++;
+    while (i > 0 && loop->timers[(i - 1) / 2].when > when)
+    {
+        loop->timers[i] = loop->timers[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    loop->timers[i].when = when;
+    loop->timers[i].coroutine = coroutine;
+    loop->timers[i].generation = coroutine->generation;
+}
+
+static void unit_test_timer_pop(struct unit_test_loop *loop) {
+    struct unit_test_timer last = loop->timers[--loop->timer_count];
+    int i = 0;
+    for (;;)
+    {
+        int child = 2 * i + 1;
+        if (child >= loop->timer_count)
+        {
+            break;
+        }
+        if (child + 1 < loop->timer_count && loop->timers[child + 1].when < loop->timers[child].when)
+        {
+            child++;
+        }
+        if (loop->timers[child].when >= last.when)
+        {
+            break;
+        }
+        loop->timers[i] = loop->timers[child];
+        i = child;
+    }
+    loop->timers[i] = last;
+}
+
+/*
+*   Moves a waiting coroutine to the back of the ready queue.
+*/
+static void unit_test_coroutine_wake(struct unit_test_loop *loop, struct unit_test_coroutine *coroutine,
+    int revents) {
+    if (!coroutine->waiting)
+    {
+        return;
+    }
+    coroutine->waiting = 0;
+    coroutine->revents = revents;
+    coroutine->generation++;
+    coroutine->next = NULL;
+    if (loop->ready_tail != NULL)
+    {
+        loop->ready_tail->next = coroutine;
+    }
+    else
+    {
+        loop->ready = coroutine;
+    }
+    loop->ready_tail = coroutine;
+}
+
+static void unit_test_coroutine_main() {
+    struct unit_test_coroutine *coroutine = unit_test_coroutine_running;
+    unit_test_run_suite(coroutine->test, coroutine->start);
+    coroutine->finished = 1;
+}
+
+/*
+*   Switches from the loop to a coroutine until it waits or finishes. The
+*   per-thread state which belongs to the running test is swapped along
+*   with the stack.
+*/
+static void unit_test_coroutine_resume(struct unit_test_loop *loop, struct unit_test_coroutine *coroutine) {
+    struct unit_test_context *current = unit_test_current;
+    unit_test_coroutine_running = coroutine;
+    unit_test_capture = &coroutine->output;
+    unit_test_current = coroutine->current;
+    unit_test_last_fname = coroutine->last_fname;
+    unit_test_last_lineno = coroutine->last_lineno;
+    swapcontext(&loop->context, &coroutine->context);
+    coroutine->current = unit_test_current;
+    coroutine->last_fname = unit_test_last_fname;
+    coroutine->last_lineno = unit_test_last_lineno;
+    unit_test_current = current;
+    unit_test_capture = NULL;
+    unit_test_coroutine_running = NULL;
+}
+
+/*
+*   Switches from the running coroutine back to the loop until it is woken
+*   by the loop, by its timeout, or by its deadline. A timeout of 0 or less
+*   waits with no timeout.
+*/
+static void unit_test_coroutine_wait(struct unit_test_coroutine *coroutine, double timeout) {
+    struct unit_test_loop *loop = unit_test_current_loop;
+    double when = timeout > 0 ? unit_test_now() + timeout : 0;
+    if (coroutine->expires > 0 && (when == 0 || coroutine->expires < when))
+    {
+        when = coroutine->expires;
+    }
+    coroutine->waiting = 1;
+    coroutine->revents = 0;
+    if (when > 0)
+    {
+        unit_test_timer_push(loop, when, coroutine);
+    }
+    swapcontext(&coroutine->context, &loop->context);
+}
+
+/*
+*   Fails the running test and ends it if it has run past its deadline.
+*/
+static void unit_test_coroutine_check(struct unit_test_coroutine *coroutine) {
+    if (coroutine->expires <= 0 || unit_test_now() < coroutine->expires)
+    {
+        return;
+    }
+    struct unit_test_event event = {0};
+    event.test = coroutine->test;
+    event.fname = unit_test_last_fname != NULL ? unit_test_last_fname : "(no assertion yet)";
+    event.lineno = unit_test_last_lineno;
+    event.kind = UNIT_TEST_KIND_DEADLINE;
+    event.passed = 0;
+    struct unit_test_buffer out = {0};
+    unit_test_buffer_printf(&out, "\tThe test was still waiting after its deadline of \033[1;31m%.3fs\033[0m;"
+        " the location above is its last assertion.\n", coroutine->deadline);
+    event.detail = unit_test_buffer_detach(&out);
+    unit_test_report(&event);
+    siglongjmp(unit_test_current->env, UNIT_TEST_JUMP_DEADLINE);
+}
+
+/*
+*   This function queues a test to be run as a coroutine by
+*   unit_test_run_async, so that many tests which spend their time waiting
+*   for I/O can run at once on one thread. Inside the test, waiting must be
+*   done with unit_test_await_fd and unit_test_await_sleep, which let the
+*   other tests run in the meantime. Assertions are counted as usual; the
+*   test's results are printed together once it finishes.
+*
+*   @param *test - unit_test structure representing the test you will be
+*       running.
+*   @param void (*start)() - function pointer representing the start
+*       function for the unit test.
+*   @param void (*print)() - function pointer representing the print
+*       function for the unit test. If NULL, the print function defaults to
+*       the built-in print funciton.
+*   @param deadline - seconds the test may take, or 0 for no limit. A test
+*       still waiting at its deadline fails and is ended. The deadline is
+*       only checked while the test waits.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_start_async(struct unit_test *test, void (*start)(), void (*print)(), double deadline) {
+    assert(test != NULL);
+    assert(start != NULL);
+    test->start = start;
+    test->print = print;
+    struct unit_test_coroutine *coroutine = calloc(1, sizeof(struct unit_test_coroutine));
+    assert(coroutine != NULL);
+    coroutine->test = test;
+    coroutine->start = start;
+    coroutine->print = print;
+    coroutine->deadline = deadline;
+    if (unit_test_coroutines_tail != NULL)
+    {
+        unit_test_coroutines_tail->next = coroutine;
+    }
+    else
+    {
+        unit_test_coroutines = coroutine;
+    }
+    unit_test_coroutines_tail = coroutine;
+}
+
+/*
+*   This function runs every test queued with unit_test_start_async,
+*   concurrently on the calling thread, and returns once all of them have
+*   finished. Each test's results are printed as it finishes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_run_async() {
+    struct unit_test_loop loop = {0};
+    loop.epoll = epoll_create1(EPOLL_CLOEXEC);
+    assert(loop.epoll >= 0);
+    unit_test_async_drain();
+    long page = sysconf(_SC_PAGESIZE);
+    int live = 0;
+    struct unit_test_coroutine *coroutine = unit_test_coroutines;
+    unit_test_coroutines = NULL;
+    unit_test_coroutines_tail = NULL;
+    while (coroutine != NULL)
+    {
+        struct unit_test_coroutine *next = coroutine->next;
+        //the lowest page of the stack is left unmapped to catch overflows
+        coroutine->stack = mmap(NULL, UNIT_TEST_COROUTINE_STACK, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+        assert(coroutine->stack != MAP_FAILED);
+        mprotect(coroutine->stack, page, PROT_NONE);
+        getcontext(&coroutine->context);
+        coroutine->context.uc_stack.ss_sp = (char *) coroutine->stack + page;
+        coroutine->context.uc_stack.ss_size = UNIT_TEST_COROUTINE_STACK - page;
+        coroutine->context.uc_link = &loop.context;
+        makecontext(&coroutine->context, &unit_test_coroutine_main, 0);
+        coroutine->test->owner = unit_test_thread_slot();
+        coroutine->started = unit_test_now();
+        coroutine->expires = coroutine->deadline > 0 ? coroutine->started + coroutine->deadline : 0;
+        coroutine->waiting = 1;
+        unit_test_coroutine_wake(&loop, coroutine, 0);
+        live++;
+        coroutine = next;
+    }
+
+    struct unit_test_loop *outer = unit_test_current_loop;
+    unit_test_current_loop = &loop;
+    struct epoll_event events[64];
+    while (live > 0)
+    {
+        while (loop.ready != NULL)
+        {
+            coroutine = loop.ready;
+            loop.ready = coroutine->next;
+            if (loop.ready == NULL)
+            {
+                loop.ready_tail = NULL;
+            }
+            unit_test_coroutine_resume(&loop, coroutine);
+            if (coroutine->finished)
+            {
+                struct unit_test *test = coroutine->test;
+                unit_test_print_header(test);
+                fwrite(coroutine->output.data, 1, coroutine->output.length, stdout);
+                unit_test_finish_suite(test, coroutine->print);
+                test->duration = unit_test_now() - coroutine->started;
+                munmap(coroutine->stack, UNIT_TEST_COROUTINE_STACK);
+                free(coroutine->output.data);
+                free(coroutine);
+                live--;
+            }
+        }
+        if (live == 0)
+        {
+            break;
+        }
+
+        //drop timers whose coroutines have already been woken
+        while (loop.timer_count > 0
+            && loop.timers[0].generation != loop.timers[0].coroutine->generation)
+        {
+            unit_test_timer_pop(&loop);
+        }
+        int wait = -1;
+        if (loop.timer_count > 0)
+        {
+            double remaining = loop.timers[0].when - unit_test_now();
+            wait = remaining <= 0 ? 0 : (int) (remaining * 1000) + 1;
+        }
+        int count = epoll_wait(loop.epoll, events, 64, wait);
+        for (int i = 0; i < count; i++)
+        {
+            unit_test_coroutine_wake(&loop, events[i].data.ptr, events[i].events);
+        }
+        double now = unit_test_now();
+        while (loop.timer_count > 0 && loop.timers[0].when <= now)
+        {
+            struct unit_test_timer timer = loop.timers[0];
+            unit_test_timer_pop(&loop);
+            if (timer.generation == timer.coroutine->generation)
+            {
+                unit_test_coroutine_wake(&loop, timer.coroutine, 0);
+            }
+        }
+    }
+    unit_test_current_loop = outer;
+    free(loop.timers);
+    close(loop.epoll);
+}
+
+/*
+*   This function waits until a file descriptor is ready, letting other
+*   async tests run in the meantime. Outside an async test it simply
+*   blocks in poll().
+*
+*   @param fd - the file descriptor to wait for.
+*   @param events - the events to wait for, such as POLLIN or POLLOUT.
+*   @param timeout - seconds to wait at most, or 0 to wait as long as it
+*       takes.
+*
+*   @return the events which are ready, or 0 if the timeout passed first.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+int unit_test_await_fd(int fd, int events, double timeout) {
+    struct unit_test_coroutine *coroutine = unit_test_coroutine_running;
+    if (coroutine == NULL)
+    {
+        struct pollfd poller = {fd, (short) events, 0};
+        int ready = poll(&poller, 1, timeout > 0 ? (int) (timeout * 1000) : -1);
+        return ready > 0 ? poller.revents : 0;
+    }
+    struct epoll_event event;
+    event.events = (unsigned int) events | EPOLLONESHOT;
+    event.data.ptr = coroutine;
+    int watched = fd;
+    if (epoll_ctl(unit_test_current_loop->epoll, EPOLL_CTL_ADD, fd, &event) != 0)
+    {
+        //another test is already waiting on this descriptor, so wait on a copy of it
+        watched = errno == EEXIST ? fcntl(fd, F_DUPFD_CLOEXEC, 0) : -1;
+        if (watched < 0 || epoll_ctl(unit_test_current_loop->epoll, EPOLL_CTL_ADD, watched, &event) != 0)
+        {
+            if (watched >= 0)
+            {
+                close(watched);
+            }
+            return events;
+        }
+    }
+    unit_test_coroutine_wait(coroutine, timeout);
+    epoll_ctl(unit_test_current_loop->epoll, EPOLL_CTL_DEL, watched, NULL);
+    if (watched != fd)
+    {
+        close(watched);
+    }
+    unit_test_coroutine_check(coroutine);
+    return coroutine->revents;
+}
+
+/*
+*   This function waits for a number of seconds, letting other async tests
+*   run in the meantime. Outside an async test it simply sleeps.
+*
+*   @param seconds - how long to wait.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_await_sleep(double seconds) {
+    struct unit_test_coroutine *coroutine = unit_test_coroutine_running;
+    if (coroutine == NULL)
+    {
+        struct timespec pause = {(time_t) seconds, (long) ((seconds - (time_t) seconds) * 1e9)};
+        nanosleep(&pause, NULL);
+        return;
+    }
+    unit_test_coroutine_wait(coroutine, seconds > 0 ? seconds : 1e-9);
+    unit_test_coroutine_check(coroutine);
+}
+
+/*
+*   This function creates a unit test which is run later by
+*   unit_test_run_all rather than straight away. It is placed in tier 1,
+*   has no tags and no cost estimate until unit_test_set_schedule is
+*   called.
+*
+*   @param *name - name of the unit test.
+*   @param start - the function which runs the test, as for unit_test_start.
+*   @param print - the summary function, or NULL, as for unit_test_start.
+*
+*   @return the new unit test.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test *unit_test_register(char *name, void (*start)(), void (*print)()) {
+    assert(start != NULL);
+    struct unit_test *test = unit_test_init(name);
+    test->start = start;
+    test->print = print;
+    return test;
+}
+
+/*
+*   This function sets how unit_test_run_all schedules a registered test.
+*
+*   @param *test - the unit test to schedule.
+*   @param tier - the test's tier, from 1 for the most important tests.
+*   @param *tags - comma separated tags, such as "db,slow", or NULL.
+*   @param cost - estimated run time in seconds, or 0 if unknown. Once the
+*       history file has timings for the test they are used instead.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_set_schedule(struct unit_test *test, int tier, const char *tags, double cost) {
+    assert(test != NULL);
+    assert(tier >= 1);
+    test->tier = tier;
+    test->tags = tags;
+    test->cost = cost;
+}
+
+/*
+*   The history file has one line per test: its name, its average run time,
+*   the number of times it has been run, and a byte whose bits record
+*   whether each of its last eight runs failed, most recent run in the top
+*   bit. Read as a number, a larger value means a more recent failure.
+*/
+#define UNIT_TEST_HISTORY_WEIGHT 0.3
+
+struct unit_test_history {
+    char *name;
+    double duration;
+    long runs;
+    unsigned int failures;
+};
+
+static int unit_test_history_compare(const void *a, const void *b) {
+    return strcmp(((const struct unit_test_history *) a)->name, ((const struct unit_test_history *) b)->name);
+}
+
+/*
+*   Reads the history file, returning its entries sorted by name.
+*/
+static struct unit_test_history *unit_test_history_load(const char *path, int *count) {
+    *count = 0;
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    struct unit_test_history *entries = NULL;
+    int capacity = 0;
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t length;
+    while ((length = getline(&line, &size, file)) > 0)
+    {
+        line[strcspn(line, "\n")] = '\0';
+        //the name may contain tabs, so the numbers are read from the right
+        char *fields[3];
+        int found = 0;
+        for (; found < 3; found++)
+        {
+            char *tab = strrchr(line, '\t');
+            if (tab == NULL)
+            {
+                break;
+            }
+            *tab = '\0';
+            fields[found] = tab + 1;
+        }
+        if (found < 3)
+        {
+            continue;
+        }
+        if (*count == capacity)
+        {
+            capacity = capacity == 0 ? 64 : capacity * 2;
+            entries = realloc(entries, capacity * sizeof(struct unit_test_history));
+            assert(entries != NULL);
+        }
+        struct unit_test_history *entry = &entries[(*count)++];
+        entry->name = strdup(line);
+        entry->duration = atof(fields[2]);
+        entry->runs = atol(fields[1]);
+        entry->failures = (unsigned int) strtoul(fields[0], NULL, 10) & 0xFF;
+    }
+    free(line);
+    fclose(file);
+    qsort(entries, *count, sizeof(struct unit_test_history), &unit_test_history_compare);
+    return entries;
+}
+
+/*
+*   Finds a test's entry among the first count entries, which are sorted
+*   by name.
+*/
+static struct unit_test_history *unit_test_history_find(struct unit_test_history *entries, int count,
+    const char *name) {
+    struct unit_test_history key = {.name = (char *) name};
+    return count == 0 ? NULL
+        : bsearch(&key, entries, count, sizeof(struct unit_test_history), &unit_test_history_compare);
+}
+
+/*
+*   Writes the history back with the results of the tests which ran. The
+*   file is replaced in one rename so that an interrupted run cannot leave
+*   it half written.
+*/
+static void unit_test_history_save(const char *path, struct unit_test_history *entries, int count) {
+    size_t length = strlen(path);
+    char *temporary = malloc(length + 5);
+    assert(temporary != NULL);
+    memcpy(temporary, path, length);
+    memcpy(temporary + length, ".tmp", 5);
+    FILE *file = fopen(temporary, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "unit_test: could not write history file %s: %s\n", temporary, strerror(errno));
+        free(temporary);
+        return;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        fprintf(file, "%s\t%.6f\t%ld\t%u\n", entries[i].name, entries[i].duration, entries[i].runs,
+            entries[i].failures);
+    }
+    if (fclose(file) != 0 || rename(temporary, path) != 0)
+    {
+        fprintf(stderr, "unit_test: could not write history file %s: %s\n", path, strerror(errno));
+    }
+    free(temporary);
+}
+
+/*
+*   The journal of a checkpointed run. Each finished test is written to it
+*   straight away, so the record survives the process being killed, but it
+*   is only synced to disk once a second, so that a run of many short tests
+*   does not wait on the disk after each one.
+*/
+#define UNIT_TEST_JOURNAL_SYNC 1.0
+
+static int unit_test_journal = -1;
+static double unit_test_journal_synced = 0;
+
+/*
+*   Gives the registered tests which have not run yet the results recorded
+*   for them in a journal, so that they are not run again. Returns the
+*   number of tests resumed, and the length of the journal up to its last
+*   complete line in *complete.
+*/
+static int unit_test_journal_resume(const char *path, off_t *complete) {
+    *complete = 0;
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return 0;
+    }
+    int resumed = 0;
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t length;
+    while ((length = getline(&line, &size, file)) > 0)
+    {
+        //a line without its newline was cut off when the process died
+        if (line[length - 1] != '\n')
+        {
+            break;
+        }
+        *complete += length;
+        line[length - 1] = '\0';
+        //the name may contain tabs, so the numbers are read from the right
+        char *fields[4];
+        int found = 0;
+        for (; found < 4; found++)
+        {
+            char *tab = strrchr(line, '\t');
+            if (tab == NULL)
+            {
+                break;
+            }
+            *tab = '\0';
+            fields[found] = tab + 1;
+        }
+        if (found < 4)
+        {
+            continue;
+        }
+        for (int i = 0; i < test_count; i++)
+        {
+            struct unit_test *test = tests[i];
+            if (test->start == NULL || test->status != UNIT_TEST_STATUS_NOT_RUN || strcmp(test->name, line) != 0)
+            {
+                continue;
+            }
+            test->num_passed = atoll(fields[3]);
+            test->num_failed = atoll(fields[2]);
+            test->status = atoi(fields[1]);
+            test->duration = atof(fields[0]);
+            if (test->status != UNIT_TEST_STATUS_PASSED && test->status != UNIT_TEST_STATUS_SKIPPED)
+            {
+                unit_test_failed_suites++;
+            }
+            resumed++;
+            break;
+        }
+    }
+    free(line);
+    fclose(file);
+    return resumed;
+}
+
+/*
+*   Opens the journal for a run. Unless the run is resuming, the journal
+*   is started afresh.
+*/
+static void unit_test_journal_open(struct unit_test_run *options) {
+    int flags = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC;
+    off_t complete = 0;
+    if (options->resume)
+    {
+        int resumed = unit_test_journal_resume(options->journal, &complete);
+        if (resumed > 0)
+        {
+            printf("\033[1;37mResuming: %d tests already completed in %s.\033[0m\n\n", resumed, options->journal);
+        }
+    }
+    else
+    {
+        flags |= O_TRUNC;
+    }
+    unit_test_journal = open(options->journal, flags, 0644);
+    if (unit_test_journal < 0)
+    {
+        fprintf(stderr, "unit_test: could not open journal %s: %s\n", options->journal, strerror(errno));
+        return;
+    }
+    //drop a line left half written, so that the next one starts on its own line
+    if (options->resume && ftruncate(unit_test_journal, complete) != 0)
+    {
+        fprintf(stderr, "unit_test: could not repair journal %s: %s\n", options->journal, strerror(errno));
+    }
+    unit_test_journal_synced = unit_test_now();
+}
+
+/*
+*   Appends a finished test to the journal.
+*/
+static void unit_test_journal_record(struct unit_test *test) {
+    if (unit_test_journal < 0 || test->status == UNIT_TEST_STATUS_OUT_OF_TIME
+        || test->status == UNIT_TEST_STATUS_NOT_RUN)
+    {
+        return;
+    }
+    char line[4096];
+    int length = snprintf(line, sizeof(line), "%s\t%lld\t%lld\t%d\t%.6f\n", test->name, test->num_passed,
+        test->num_failed, test->status, test->duration);
+    if (length < 0 || length >= (int) sizeof(line) || write(unit_test_journal, line, length) != length)
+    {
+        fprintf(stderr, "unit_test: could not record %s in the journal\n", test->name);
+    }
+    double now = unit_test_now();
+    if (now - unit_test_journal_synced >= UNIT_TEST_JOURNAL_SYNC)
+    {
+        fdatasync(unit_test_journal);
+        unit_test_journal_synced = now;
+    }
+}
+
+static void unit_test_journal_close() {
+    if (unit_test_journal >= 0)
+    {
+        fdatasync(unit_test_journal);
+        close(unit_test_journal);
+        unit_test_journal = -1;
+    }
+}
+
+/*
+*   Returns non-zero if one of a test's tags is in a comma separated list.
+*/
+static int unit_test_tags_match(const char *tags, const char *wanted) {
+    if (tags == NULL)
+    {
+        return 0;
+    }
+    for (const char *tag = tags; *tag != '\0';)
+    {
+        size_t length = strcspn(tag, ",");
+        for (const char *want = wanted; *want != '\0';)
+        {
+            size_t want_length = strcspn(want, ",");
+            if (want_length == length && strncmp(tag, want, length) == 0)
+            {
+                return 1;
+            }
+            want += want_length + (want[want_length] == ',');
+        }
+        tag += length + (tag[length] == ',');
+    }
+    return 0;
+}
+
+/*
+*   A test waiting to be run by unit_test_run_all(). order is its place in
+*   the order tests were registered, which breaks ties when sorting.
+*/
+struct unit_test_queued {
+    struct unit_test *test;
+    int order;
+};
+
+/*
+*   Orders tests for a budgeted run: recent failures first, then by tier,
+*   then the cheapest first.
+*/
+static int unit_test_schedule_compare(const void *x, const void *y) {
+    const struct unit_test_queued *qa = x;
+    const struct unit_test_queued *qb = y;
+    const struct unit_test *a = qa->test;
+    const struct unit_test *b = qb->test;
+    if (a->recent_failures != b->recent_failures)
+    {
+        return a->recent_failures > b->recent_failures ? -1 : 1;
+    }
+    int atier = a->tier > 0 ? a->tier : 1;
+    int btier = b->tier > 0 ? b->tier : 1;
+    if (atier != btier)
+    {
+        return atier < btier ? -1 : 1;
+    }
+    if (a->cost != b->cost)
+    {
+        return a->cost < b->cost ? -1 : 1;
+    }
+    return qa->order - qb->order;
+}
+
+/*
+*   Returns the registered tests which pass the run's tier and tag
+*   filters, marking the others as filtered out.
+*/
+static struct unit_test_queued *unit_test_schedule(struct unit_test_run *options, int *count) {
+    struct unit_test_queued *queue = malloc((test_count > 0 ? test_count : 1) * sizeof(struct unit_test_queued));
+    assert(queue != NULL);
+    *count = 0;
+    for (int i = 0; i < test_count; i++)
+    {
+        struct unit_test *test = tests[i];
+        if (test->start == NULL || test->status != UNIT_TEST_STATUS_NOT_RUN)
+        {
+            continue;
+        }
+        int tier = test->tier > 0 ? test->tier : 1;
+        if ((options->max_tier > 0 && tier > options->max_tier)
+            || (options->tags != NULL && !unit_test_tags_match(test->tags, options->tags)))
+        {
+            test->status = UNIT_TEST_STATUS_FILTERED;
+            continue;
+        }
+        queue[*count].test = test;
+        queue[*count].order = *count;
+        (*count)++;
+    }
+    return queue;
+}
+
+/*
+*   Orders tests longest first, for the LPT (longest processing time)
+*   schedule used by parallel runs: handing the longest remaining test to
+*   whichever worker frees up first keeps a long test from starting last
+*   and holding up the end of the run.
+*/
+static int unit_test_lpt_compare(const void *x, const void *y) {
+    const struct unit_test_queued *a = x;
+    const struct unit_test_queued *b = y;
+    if (a->test->cost != b->test->cost)
+    {
+        return a->test->cost > b->test->cost ? -1 : 1;
+    }
+    return a->order - b->order;
+}
+
+/*
+*   Returns the makespan of running tests in queue order on a number of
+*   workers, each test going to the worker which frees up first, if every
+*   test takes exactly its estimated cost.
+*/
+static double unit_test_predict_makespan(struct unit_test_queued *queue, int count, int workers) {
+    double *loads = calloc(workers, sizeof(double));
+    assert(loads != NULL);
+    double makespan = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int least = 0;
+        for (int j = 1; j < workers; j++)
+        {
+            least = loads[j] < loads[least] ? j : least;
+        }
+        loads[least] += queue[i].test->cost;
+        makespan = loads[least] > makespan ? loads[least] : makespan;
+    }
+    free(loads);
+    return makespan;
+}
+
+/*
+*   What a worker process sends back about the test it ran.
+*/
+struct unit_test_outcome {
+    long long passed;
+    long long failed;
+    int status;
+    double duration;
+};
+
+/*
+*   A worker running one test in a child process. The child's standard
+*   output goes to a temporary file, which is copied to standard output in
+*   one piece once the test finishes, so that the output of tests running
+*   at the same time is never interleaved.
+*/
+struct unit_test_worker {
+    struct unit_test *test;
+    int lane;
+    pid_t child;
+    int results;
+    FILE *output;
+    double started;
+    double busy;
+};
+
+static void unit_test_worker_start(struct unit_test_worker *worker, struct unit_test *test) {
+    for (int i = 0; i < test->fixture_count; i++)
+    {
+        unit_test_fixture_get(test, test->fixtures[i]);
+    }
+    worker->output = tmpfile();
+    assert(worker->output != NULL);
+    int results[2];
+    int piped = pipe2(results, O_CLOEXEC);
+    assert(piped == 0);
+    fflush(stdout);
+    fflush(stderr);
+    pid_t child = fork();
+    assert(child >= 0);
+    if (child == 0)
+    {
+        close(results[0]);
+        dup2(fileno(worker->output), STDOUT_FILENO);
+        unit_test_trace_lane(getppid(), worker->lane);
+        unit_test_start(test, test->start, test->print);
+        fflush(stdout);
+        struct unit_test_outcome outcome = {test->num_passed, test->num_failed, test->status, test->duration};
+        ssize_t written = write(results[1], &outcome, sizeof(outcome));
+        _exit(written == (ssize_t) sizeof(outcome) ? 0 : 1);
+    }
+    close(results[1]);
+    worker->test = test;
+    worker->child = child;
+    worker->results = results[0];
+    worker->started = unit_test_now();
+}
+
+/*
+*   Collects the result of a worker whose child has finished, and prints
+*   the test's output.
+*/
+static void unit_test_worker_finish(struct unit_test_worker *worker) {
+    struct unit_test *test = worker->test;
+    struct unit_test_outcome outcome;
+    ssize_t got;
+    do
+    {
+        got = read(worker->results, &outcome, sizeof(outcome));
+    } while (got < 0 && errno == EINTR);
+    close(worker->results);
+    int status;
+    while (waitpid(worker->child, &status, 0) < 0 && errno == EINTR);
+    worker->busy += unit_test_now() - worker->started;
+
+    int fd = fileno(worker->output);
+    lseek(fd, 0, SEEK_SET);
+    char chunk[65536];
+    ssize_t length;
+    while ((length = read(fd, chunk, sizeof(chunk))) > 0)
+    {
+        fwrite(chunk, 1, length, stdout);
+    }
+    fclose(worker->output);
+
+    if (got == (ssize_t) sizeof(outcome) && WIFEXITED(status) && WEXITSTATUS(status) == 0)
+    {
+        test->num_passed += outcome.passed;
+        test->num_failed += outcome.failed;
+        test->status = outcome.status;
+        test->duration = outcome.duration;
+    }
+    else
+    {
+        test->num_failed++;
+        test->status = UNIT_TEST_STATUS_CRASHED;
+        test->duration = unit_test_now() - worker->started;
+        if (WIFSIGNALED(status))
+        {
+            printf("\033[1;31m%s: child process was killed by signal %d (%s).\033[0m\n\n",
+                test->name, WTERMSIG(status), strsignal(WTERMSIG(status)));
+        }
+        else
+        {
+            printf("\033[1;31m%s: child process exited with status %d.\033[0m\n\n",
+                test->name, WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        }
+    }
+    if (test->status != UNIT_TEST_STATUS_PASSED && test->status != UNIT_TEST_STATUS_SKIPPED)
+    {
+        __atomic_fetch_add(&unit_test_failed_suites, 1, __ATOMIC_RELAXED);
+    }
+    unit_test_release_fixtures(test);
+    unit_test_journal_record(test);
+    worker->test = NULL;
+}
+
+/*
+*   Runs the queue on a number of worker processes, starting each test on
+*   the first worker to become free, and reports how long the run took
+*   against how long the schedule predicted. Returns the number of tests
+*   which were left out because they did not fit in the time budget.
+*/
+static int unit_test_run_parallel(struct unit_test_queued *queue, int count, struct unit_test_run *options,
+    int predicted) {
+    int jobs = options->jobs;
+    struct unit_test_worker *workers = calloc(jobs, sizeof(struct unit_test_worker));
+    struct pollfd *pollers = calloc(jobs, sizeof(struct pollfd));
+    assert(workers != NULL && pollers != NULL);
+    for (int i = 0; i < jobs; i++)
+    {
+        workers[i].lane = i + 1;
+    }
+    unit_test_trace_lanes(jobs);
+    double makespan = predicted ? unit_test_predict_makespan(queue, count, jobs) : 0;
+    unit_test_async_drain();
+
+    double started = unit_test_now();
+    int out_of_time = 0;
+    int running = 0;
+    int next = 0;
+    while (next < count || running > 0)
+    {
+        for (int i = 0; i < jobs && next < count; i++)
+        {
+            if (workers[i].test != NULL)
+            {
+                continue;
+            }
+            //find the next test which still fits in the budget
+            struct unit_test *test = NULL;
+            while (next < count && test == NULL)
+            {
+                test = queue[next++].test;
+                double elapsed = unit_test_now() - started;
+                if (options->budget > 0 && (elapsed >= options->budget || elapsed + test->cost > options->budget))
+                {
+                    test->status = UNIT_TEST_STATUS_OUT_OF_TIME;
+                    out_of_time++;
+                    test = NULL;
+                }
+            }
+            if (test != NULL)
+            {
+                unit_test_worker_start(&workers[i], test);
+                running++;
+            }
+        }
+        if (running == 0)
+        {
+            break;
+        }
+
+        for (int i = 0; i < jobs; i++)
+        {
+            pollers[i].fd = workers[i].test != NULL ? workers[i].results : -1;
+            pollers[i].events = POLLIN;
+            pollers[i].revents = 0;
+        }
+        if (poll(pollers, jobs, -1) < 0)
+        {
+            continue;
+        }
+        for (int i = 0; i < jobs; i++)
+        {
+            if (workers[i].test != NULL && pollers[i].revents != 0)
+            {
+                unit_test_worker_finish(&workers[i]);
+                running--;
+            }
+        }
+    }
+
+    double actual = unit_test_now() - started;
+    double busy = 0;
+    printf("\033[1;37m================== Parallel Run ==================\033[0m\n");
+    printf("Workers: %*d\n", 41, jobs);
+    printf("Schedule: %*s\n", 40, predicted ? "longest first" : "registration order");
+    if (predicted)
+    {
+        printf("Predicted Makespan: %*.3fs\n", 29, makespan);
+    }
+    printf("Actual Makespan: %*.3fs\n", 32, actual);
+    for (int i = 0; i < jobs; i++)
+    {
+        busy += workers[i].busy;
+        printf("Worker %d Busy: %*.3fs (%5.1f%%)\n", i + 1, 25 - (i + 1 >= 10), workers[i].busy,
+            actual > 0 ? 100 * workers[i].busy / actual : 0.0);
+    }
+    printf("Utilization: \033[1;36m%*.1f%%\033[0m\n", 36, actual > 0 ? 100 * busy / (jobs * actual) : 0.0);
+    printf("\033[1;37m==================================================\033[0m\n\n");
+    free(workers);
+    free(pollers);
+    return out_of_time;
+}
+
+/*
+*   This function runs every test made with unit_test_register which has
+*   not run yet. Tests can be limited to a tier and to tags. Tests in lower
+*   tiers run first, and within a tier the cheapest ones, using the tier
+*   and cost given to unit_test_set_schedule. If a history file is given,
+*   the tests which failed most recently run before all others, and the
+*   timings from earlier runs replace the given costs. With a time budget,
+*   a test is only started if its estimated cost fits in the time
+*   remaining; the tests which do not fit are listed as out of time by
+*   unit_test_print_total_summary. The history is updated with this run's
+*   timings and failures.
+*
+*   With more than one job, tests run in that many worker processes at
+*   once. If a history file is given they are started longest first, so
+*   the long tests are spread over the workers instead of one of them
+*   finishing last; without one they start in the order they were
+*   registered. The predicted and actual length of the run and how busy
+*   each worker was are printed at the end.
+*
+*   With a journal, each test's name, counts, status and duration are
+*   appended to it as soon as the test finishes. If the run is killed, a
+*   new run with resume set gives the tests recorded in the journal their
+*   recorded results instead of running them, so the total summary covers
+*   both halves, and carries on with the rest.
+*
+*   @param *options - the run's budget, filters, jobs and history file, or NULL
+*       to run every registered test in the order they were registered.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_run_all(struct unit_test_run *options) {
+    struct unit_test_run defaults = {0};
+    if (options == NULL)
+    {
+        options = &defaults;
+    }
+    if (options->trace != NULL && unit_test_trace == NULL)
+    {
+        unit_test_set_trace(options->trace);
+    }
+    if (options->journal != NULL)
+    {
+        unit_test_journal_open(options);
+    }
+    int count;
+    struct unit_test_queued *queue = unit_test_schedule(options, &count);
+    int history_count = 0;
+    int loaded = 0;
+    struct unit_test_history *history = NULL;
+    if (options->history != NULL)
+    {
+        history = unit_test_history_load(options->history, &history_count);
+        loaded = history_count;
+        for (int i = 0; i < count; i++)
+        {
+            struct unit_test *test = queue[i].test;
+            struct unit_test_history *entry = unit_test_history_find(history, history_count, test->name);
+            if (entry != NULL)
+            {
+                test->cost = entry->duration;
+                test->recent_failures = entry->failures;
+            }
+        }
+    }
+    qsort(queue, count, sizeof(struct unit_test_queued),
+        options->jobs > 1 ? &unit_test_lpt_compare : &unit_test_schedule_compare);
+
+    int out_of_time = 0;
+    if (options->jobs > 1)
+    {
+        out_of_time = unit_test_run_parallel(queue, count, options, loaded > 0);
+    }
+    else
+    {
+        double started = unit_test_now();
+        for (int i = 0; i < count; i++)
+        {
+            struct unit_test *test = queue[i].test;
+            double elapsed = unit_test_now() - started;
+            if (options->budget > 0 && (elapsed >= options->budget || elapsed + test->cost > options->budget))
+            {
+                test->status = UNIT_TEST_STATUS_OUT_OF_TIME;
+                out_of_time++;
+                continue;
+            }
+            unit_test_start(test, test->start, test->print);
+            unit_test_journal_record(test);
+        }
+    }
+    unit_test_journal_close();
+    if (out_of_time > 0)
+    {
+        printf("\033[1;33m%d tests did not fit in the %.2fs time budget.\033[0m\n\n", out_of_time,
+            options->budget);
+    }
+
+    if (options->history != NULL)
+    {
+        history = realloc(history, (history_count + count + 1) * sizeof(struct unit_test_history));
+        assert(history != NULL);
+        for (int i = 0; i < count; i++)
+        {
+            struct unit_test *test = queue[i].test;
+            if (test->status == UNIT_TEST_STATUS_OUT_OF_TIME || test->status == UNIT_TEST_STATUS_SKIPPED)
+            {
+                continue;
+            }
+            //tests new to the history are appended, so only the loaded entries are searched
+            struct unit_test_history *entry = unit_test_history_find(history, loaded, test->name);
+            if (entry == NULL)
+            {
+                entry = &history[history_count++];
+                entry->name = strdup(test->name);
+                entry->duration = test->duration;
+                entry->runs = 0;
+                entry->failures = 0;
+            }
+            entry->duration = entry->runs == 0 ? test->duration
+                : entry->duration + UNIT_TEST_HISTORY_WEIGHT * (test->duration - entry->duration);
+            entry->runs++;
+            entry->failures = (entry->failures >> 1) | (test->status == UNIT_TEST_STATUS_PASSED ? 0 : 0x80);
+        }
+        unit_test_history_save(options->history, history, history_count);
+        for (int i = 0; i < history_count; i++)
+        {
+            free(history[i].name);
+        }
+        free(history);
+    }
+    free(queue);
+}
+
+/*
+*   This function fills in a unit_test_run from command line arguments, so
+*   that a test program can be asked to run only part of its tests:
+*
+*       --budget=SECONDS   stop starting tests after this much time
+*       --tier=N           only run tests in tiers 1 to N
+*       --tags=a,b         only run tests with one of these tags
+*       --history=FILE     order tests by, and record, their history
+*       --jobs=N           run N tests at once
+*       --trace=FILE       write a timeline of the run to FILE
+*       --watch=DIRS       rerun affected tests when files in DIRS change
+*       --journal=FILE     record each finished test in FILE
+*       --resume           skip the tests already recorded in the journal
+*
+*   @param argc - argument count, as passed to main.
+*   @param **argv - arguments, as passed to main.
+*   @param *options - the options to fill in.
+*
+*   @return 0, or -1 after printing a usage message if an argument was not
+*       understood.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+int unit_test_parse_args(int argc, char **argv, struct unit_test_run *options) {
+    assert(options != NULL);
+    for (int i = 1; i < argc; i++)
+    {
+        char *value = strchr(argv[i], '=');
+        size_t length = value == NULL ? strlen(argv[i]) : (size_t) (value - argv[i]);
+        value = value == NULL ? NULL : value + 1;
+        if (value != NULL && length == 8 && strncmp(argv[i], "--budget", length) == 0)
+        {
+            options->budget = atof(value);
+        }
+        else if (value != NULL && length == 6 && strncmp(argv[i], "--tier", length) == 0)
+        {
+            options->max_tier = atoi(value);
+        }
+        else if (value != NULL && length == 6 && strncmp(argv[i], "--tags", length) == 0)
+        {
+            options->tags = value;
+        }
+        else if (value != NULL && length == 9 && strncmp(argv[i], "--history", length) == 0)
+        {
+            options->history = value;
+        }
+        else if (value != NULL && length == 6 && strncmp(argv[i], "--jobs", length) == 0)
+        {
+            options->jobs = atoi(value);
+        }
+        else if (value != NULL && length == 7 && strncmp(argv[i], "--trace", length) == 0)
+        {
+            options->trace = value;
+        }
+        else if (value != NULL && length == 7 && strncmp(argv[i], "--watch", length) == 0)
+        {
+            options->watch = value;
+        }
+        else if (value != NULL && length == 9 && strncmp(argv[i], "--journal", length) == 0)
+        {
+            options->journal = value;
+        }
+        else if (value == NULL && length == 8 && strncmp(argv[i], "--resume", length) == 0)
+        {
+            options->resume = 1;
+        }
+        else
+        {
+            fprintf(stderr, "%s: unknown argument %s\n"
+                "usage: %s [--budget=SECONDS] [--tier=N] [--tags=a,b] [--history=FILE] [--jobs=N]\n"
+                "       [--trace=FILE] [--watch=DIRS] [--journal=FILE] [--resume]\n",
+                argv[0], argv[i], argv[0]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+*   Orders plugin file names so that a directory loads in the same order
+*   every time.
+*/
+static int unit_test_plugin_compare(const void *a, const void *b) {
+    return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+/*
+*   A shared object loaded by unit_test_load_plugin. Its tests are
+*   tests[first] to tests[first + count - 1]; path is the file's real path,
+*   which watch mode compares changed files against.
+*/
+struct unit_test_module {
+    char *path;
+    int first;
+    int count;
+};
+
+static struct unit_test_module *unit_test_modules = NULL;
+static int unit_test_module_count = 0;
+
+/*
+*   Loads one shared object and calls its registration function, if it has
+*   one. Returns the number of tests it registered, or -1 if it could not
+*   be loaded.
+*/
+static int unit_test_open_module(const char *path) {
+    int before = test_count;
+    //RTLD_NOW reports a module with missing symbols here rather than halfway through a test
+    void *module = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (module == NULL)
+    {
+        fprintf(stderr, "unit_test: could not load %s: %s\n", path, dlerror());
+        return -1;
+    }
+    void (*plugin)() = (void (*)()) dlsym(module, "unit_test_plugin");
+    if (plugin != NULL)
+    {
+        plugin();
+    }
+    return test_count - before;
+}
+
+/*
+*   Loads a shared object, and remembers it and the tests it registered.
+*/
+static int unit_test_load_module(const char *path) {
+    int first = test_count;
+    int registered = unit_test_open_module(path);
+    if (registered < 0)
+    {
+        return registered;
+    }
+    unit_test_modules = realloc(unit_test_modules, (unit_test_module_count + 1) * sizeof(struct unit_test_module));
+    assert(unit_test_modules != NULL);
+    struct unit_test_module *module = &unit_test_modules[unit_test_module_count++];
+    module->path = realpath(path, NULL);
+    module->path = module->path != NULL ? module->path : strdup(path);
+    module->first = first;
+    module->count = registered;
+    return registered;
+}
+
+/*
+*   This function loads tests from a shared object, or from every shared
+*   object (file ending in .so) in a directory, into this process. Tests
+*   are registered in the same list as those made by unit_test_init and
+*   unit_test_register, so unit_test_run_all runs them and
+*   unit_test_print_total_summary reports them alongside every other test.
+*   This lets a whole project's tests run in one process, paying for
+*   process startup and dynamic linking once instead of once per test
+*   program.
+*
+*   A module registers its tests with unit_test_register, either from a
+*   function named unit_test_plugin, which is called once the module is
+*   loaded, or from a constructor. Modules are built with -shared -fPIC
+*   and leave the library's functions undefined, so that they use the copy
+*   the loading program is linked to; linking each one against its own
+*   copy would give it its own list of tests. Modules stay loaded until
+*   the process exits, since their tests are run after they are loaded.
+*
+*   @param *path - a shared object, or a directory of them.
+*
+*   @return the number of tests registered, or -1 if a module could not be
+*       loaded; the rest of a directory is still loaded.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+int unit_test_load_plugin(const char *path) {
+    assert(path != NULL);
+    struct stat info;
+    if (stat(path, &info) != 0)
+    {
+        fprintf(stderr, "unit_test: could not load %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    if (!S_ISDIR(info.st_mode))
+    {
+        //a bare file name would make dlopen search the library path instead
+        if (strchr(path, '/') == NULL)
+        {
+            char *local = malloc(strlen(path) + 3);
+            assert(local != NULL);
+            sprintf(local, "./%s", path);
+            int registered = unit_test_load_module(local);
+            free(local);
+            return registered;
+        }
+        return unit_test_load_module(path);
+    }
+
+    DIR *directory = opendir(path);
+    if (directory == NULL)
+    {
+        fprintf(stderr, "unit_test: could not load %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    char **names = NULL;
+    int count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(directory)) != NULL)
+    {
+        size_t length = strlen(entry->d_name);
+        if (length > 3 && strcmp(entry->d_name + length - 3, ".so") == 0)
+        {
+            names = realloc(names, (count + 1) * sizeof(char *));
+            assert(names != NULL);
+            names[count] = malloc(strlen(path) + length + 2);
+            assert(names[count] != NULL);
+            sprintf(names[count++], "%s/%s", path, entry->d_name);
+        }
+    }
+    closedir(directory);
+    qsort(names, count, sizeof(char *), &unit_test_plugin_compare);
+
+    int registered = 0;
+    int failed = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int loaded = unit_test_load_module(names[i]);
+        failed |= loaded < 0;
+        registered += loaded > 0 ? loaded : 0;
+        free(names[i]);
+    }
+    free(names);
+    return failed ? -1 : registered;
+}
+
+/*
+*   Returns the part of a path after its last slash.
+*/
+static const char *unit_test_basename(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash != NULL ? slash + 1 : path;
+}
+
+/*
+*   Returns whether a file is source code, which watch mode maps to tests,
+*   rather than an editor's swap file or something a build wrote.
+*/
+static int unit_test_is_source(const char *name) {
+    static const char *extensions[] = {".c", ".h", ".cc", ".cpp", ".cxx", ".hh", ".hpp", ".inc"};
+    const char *dot = strrchr(name, '.');
+    if (name[0] == '.' || dot == NULL)
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); i++)
+    {
+        if (strcmp(dot, extensions[i]) == 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+*   Returns whether a change to a file affects a test: when one of the
+*   files the test's assertions were made from has the same name, or has
+*   the changed file's name without its extension inside its own, as
+*   test_parser.c does for parser.c.
+*/
+static int unit_test_watch_affects(struct unit_test *test, const char *path) {
+    const char *name = unit_test_basename(path);
+    size_t stem = strcspn(name, ".");
+    for (int i = 0; i < test->file_count; i++)
+    {
+        const char *file = unit_test_basename(test->files[i]);
+        if (strcmp(file, name) == 0 || (stem > 0 && memmem(file, strlen(file), name, stem) != NULL))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+*   The names of the tests to rerun once their code has been rebuilt. all
+*   is set by a change to source code which could not be traced to any
+*   test, such as a header.
+*/
+struct unit_test_pending {
+    const char **names;
+    int count;
+    int all;
+};
+
+static int unit_test_pending_listed(struct unit_test_pending *pending, const char *name) {
+    for (int i = 0; i < pending->count; i++)
+    {
+        if (strcmp(pending->names[i], name) == 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+*   Returns whether a test is to be rerun when the code it is in has been
+*   rebuilt. tests[first] to tests[first + count - 1] are all the tests in
+*   that code; if none of them are pending it was rebuilt for some other
+*   reason, and they all rerun.
+*/
+static int unit_test_pending_has(struct unit_test_pending *pending, const char *name, int first, int count) {
+    if (pending->all || unit_test_pending_listed(pending, name))
+    {
+        return 1;
+    }
+    for (int i = first; i < first + count; i++)
+    {
+        if (tests[i]->status != UNIT_TEST_STATUS_FILTERED && unit_test_pending_listed(pending, tests[i]->name))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+*   Adds the tests affected by a changed file to the pending list.
+*/
+static void unit_test_pending_change(struct unit_test_pending *pending, const char *path) {
+    int found = 0;
+    for (int i = 0; i < test_count; i++)
+    {
+        struct unit_test *test = tests[i];
+        if (test->status == UNIT_TEST_STATUS_FILTERED || !unit_test_watch_affects(test, path))
+        {
+            continue;
+        }
+        found = 1;
+        if (!unit_test_pending_listed(pending, test->name))
+        {
+            pending->names = realloc(pending->names, (pending->count + 1) * sizeof(const char *));
+            assert(pending->names != NULL);
+            pending->names[pending->count++] = test->name;
+        }
+    }
+    pending->all |= !found;
+}
+
+static void unit_test_pending_clear(struct unit_test_pending *pending) {
+    free(pending->names);
+    pending->names = NULL;
+    pending->count = 0;
+    pending->all = 0;
+}
+
+/*
+*   Loads the rebuilt copy of a module in place of the one loaded before.
+*   dlopen would hand back the module already loaded from the same path,
+*   so a copy of the file is loaded instead. The old copy is left loaded,
+*   since fixtures it built may still point into it. Tests of the new copy
+*   which are not pending take the results of the old copy's tests of the
+*   same name, and the old copy's tests are hidden. Returns the number of
+*   tests left to run, or -1 if the module could not be loaded.
+*/
+static int unit_test_watch_reload(struct unit_test_module *module, struct unit_test_pending *pending) {
+    char copy[] = "/tmp/unit_test_module_XXXXXX.so";
+    int out = mkstemps(copy, 3);
+    int in = open(module->path, O_RDONLY | O_CLOEXEC);
+    if (out < 0 || in < 0)
+    {
+        fprintf(stderr, "unit_test: could not reload %s: %s\n", module->path, strerror(errno));
+        if (out >= 0)
+        {
+            close(out);
+            unlink(copy);
+        }
+        if (in >= 0)
+        {
+            close(in);
+        }
+        return -1;
+    }
+    char chunk[65536];
+    ssize_t length;
+    while ((length = read(in, chunk, sizeof(chunk))) > 0)
+    {
+        if (write(out, chunk, length) != length)
+        {
+            break;
+        }
+    }
+    close(in);
+    close(out);
+
+    int first = test_count;
+    unit_test_reloading = 1;
+    int registered = unit_test_open_module(copy);
+    unit_test_reloading = 0;
+    unlink(copy);
+    if (registered < 0)
+    {
+        return -1;
+    }
+
+    int rerun = 0;
+    for (int i = first; i < test_count; i++)
+    {
+        struct unit_test *test = tests[i];
+        struct unit_test *old = NULL;
+        for (int j = module->first; j < module->first + module->count && old == NULL; j++)
+        {
+            old = strcmp(tests[j]->name, test->name) == 0 ? tests[j] : NULL;
+        }
+        if (old == NULL || unit_test_pending_has(pending, test->name, module->first, module->count))
+        {
+            rerun++;
+            continue;
+        }
+        test->num_passed = old->num_passed;
+        test->num_failed = old->num_failed;
+        test->status = old->status;
+        test->duration = old->duration;
+        test->files = old->files;
+        test->file_count = old->file_count;
+    }
+    for (int j = module->first; j < module->first + module->count; j++)
+    {
+        tests[j]->status = UNIT_TEST_STATUS_FILTERED;
+    }
+    module->first = first;
+    module->count = registered;
+    return rerun;
+}
+
+/*
+*   Replaces the process with the rebuilt program. Which tests to rerun,
+*   and the results and files of the others, are passed on in the
+*   UNIT_TEST_WATCH environment variable, one test per line:
+*   rerun, passed, failed, status, name and then its files, separated by
+*   tabs. Only returns if the program could not be started.
+*/
+static void unit_test_watch_exec(const char *self, char **argv, struct unit_test_pending *pending) {
+    struct unit_test_buffer state = {0};
+    for (int i = 0; i < test_count; i++)
+    {
+        struct unit_test *test = tests[i];
+        if (test->status == UNIT_TEST_STATUS_FILTERED || test->start == NULL)
+        {
+            continue;
+        }
+        unit_test_buffer_printf(&state, "%d\t%lld\t%lld\t%d\t%s",
+            unit_test_pending_has(pending, test->name, 0, test_count),
+            test->num_passed, test->num_failed, test->status, test->name);
+        for (int j = 0; j < test->file_count; j++)
+        {
+            unit_test_buffer_printf(&state, "\t%s", test->files[j]);
+        }
+        unit_test_buffer_printf(&state, "\n");
+    }
+    setenv("UNIT_TEST_WATCH", state.data != NULL ? state.data : "", 1);
+    free(state.data);
+    fflush(stdout);
+    fflush(stderr);
+    execv(self, argv);
+    fprintf(stderr, "unit_test: could not restart %s: %s\n", self, strerror(errno));
+    unsetenv("UNIT_TEST_WATCH");
+}
+
+/*
+*   Takes back the state passed on by unit_test_watch_exec: tests which do
+*   not need to run again are given their earlier results.
+*/
+static void unit_test_watch_restore() {
+    const char *state = getenv("UNIT_TEST_WATCH");
+    if (state == NULL)
+    {
+        return;
+    }
+    char *lines = strdup(state);
+    unsetenv("UNIT_TEST_WATCH");
+    char *line_end;
+    for (char *line = strtok_r(lines, "\n", &line_end); line != NULL; line = strtok_r(NULL, "\n", &line_end))
+    {
+        char *field_end;
+        char *rerun = strtok_r(line, "\t", &field_end);
+        char *passed = strtok_r(NULL, "\t", &field_end);
+        char *failed = strtok_r(NULL, "\t", &field_end);
+        char *status = strtok_r(NULL, "\t", &field_end);
+        char *name = strtok_r(NULL, "\t", &field_end);
+        if (name == NULL)
+        {
+            continue;
+        }
+        for (int i = 0; i < test_count; i++)
+        {
+            struct unit_test *test = tests[i];
+            if (test->status != UNIT_TEST_STATUS_NOT_RUN || strcmp(test->name, name) != 0)
+            {
+                continue;
+            }
+            for (char *file = strtok_r(NULL, "\t", &field_end); file != NULL; file = strtok_r(NULL, "\t", &field_end))
+            {
+                unit_test_note_file(test, strdup(file));
+            }
+            if (atoi(rerun) == 0)
+            {
+                test->num_passed = atoll(passed);
+                test->num_failed = atoll(failed);
+                test->status = atoi(status);
+            }
+            break;
+        }
+    }
+    free(lines);
+}
+
+/*
+*   A directory being watched.
+*/
+struct unit_test_watched {
+    int wd;
+    char *path;
+};
+
+static void unit_test_watch_directory(int notify, const char *path, struct unit_test_watched **watched, int *count) {
+    char *real = realpath(path, NULL);
+    int wd = real != NULL ? inotify_add_watch(notify, real, IN_CLOSE_WRITE | IN_MOVED_TO) : -1;
+    if (wd < 0)
+    {
+        fprintf(stderr, "unit_test: could not watch %s: %s\n", path, strerror(errno));
+        free(real);
+        return;
+    }
+    for (int i = 0; i < *count; i++)
+    {
+        if ((*watched)[i].wd == wd)
+        {
+            free(real);
+            return;
+        }
+    }
+    *watched = realloc(*watched, (*count + 1) * sizeof(struct unit_test_watched));
+    assert(*watched != NULL);
+    (*watched)[*count].wd = wd;
+    (*watched)[(*count)++].path = real;
+}
+
+/*
+*   Reads the arguments the program was started with.
+*/
+static char **unit_test_watch_argv() {
+    char **argv = calloc(1, sizeof(char *));
+    int count = 0;
+    FILE *file = fopen("/proc/self/cmdline", "r");
+    char *argument = NULL;
+    size_t size = 0;
+    while (file != NULL && getdelim(&argument, &size, '\0', file) > 0)
+    {
+        argv = realloc(argv, (count + 2) * sizeof(char *));
+        assert(argv != NULL);
+        argv[count++] = strdup(argument);
+        argv[count] = NULL;
+    }
+    free(argument);
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+    return argv;
+}
+
+/*
+*   This function runs the registered tests, then watches for changes and
+*   reruns the tests they affect, until the process is stopped. The
+*   directories given in options->watch (comma separated, not including
+*   their subdirectories), the directories of loaded test modules and the
+*   directory of the program itself are watched.
+*
+*   A changed source file is mapped to the tests whose assertions were
+*   made from a file of the same name, or whose file names contain its
+*   name, as test_parser.c does for parser.c. Source which cannot be
+*   mapped, such as a header, affects every test. The affected tests are
+*   rerun as soon as the code they are in is rebuilt. When a module loaded
+*   with unit_test_load_plugin is rebuilt, the new copy is loaded into this
+*   process, and fixtures stay built from one round to the next, since
+*   they are not torn down while watching. When the program itself is
+*   rebuilt it is restarted, and only runs the affected tests; the other
+*   tests keep their earlier results in the total summary. A rebuild with
+*   no changed source before it reruns everything it contains.
+*
+*   @param *options - the options to run the tests with, as for
+*       unit_test_run_all, with watch set.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_watch(struct unit_test_run *options) {
+    assert(options != NULL);
+    assert(options->watch != NULL);
+    char **argv = unit_test_watch_argv();
+    char *self = realpath("/proc/self/exe", NULL);
+    unit_test_watching = 1;
+    unit_test_watch_restore();
+    unit_test_run_all(options);
+    unit_test_print_total_summary();
+
+    int notify = inotify_init1(IN_CLOEXEC);
+    if (notify < 0)
+    {
+        fprintf(stderr, "unit_test: could not watch for changes: %s\n", strerror(errno));
+        return;
+    }
+    struct unit_test_watched *watched = NULL;
+    int watched_count = 0;
+    char *directories = strdup(options->watch);
+    char *save;
+    for (char *path = strtok_r(directories, ",", &save); path != NULL; path = strtok_r(NULL, ",", &save))
+    {
+        unit_test_watch_directory(notify, path, &watched, &watched_count);
+    }
+    free(directories);
+    for (int i = 0; i <= unit_test_module_count; i++)
+    {
+        const char *file = i < unit_test_module_count ? unit_test_modules[i].path : self;
+        if (file != NULL)
+        {
+            char *directory = strndup(file, unit_test_basename(file) - file);
+            unit_test_watch_directory(notify, directory[0] != '\0' ? directory : ".", &watched, &watched_count);
+            free(directory);
+        }
+    }
+    printf("\033[1;37mWatching for changes.\033[0m\n\n");
+    fflush(stdout);
+
+    struct unit_test_pending pending = {0};
+    int *rebuilt = calloc(unit_test_module_count + 1, sizeof(int));
+    assert(rebuilt != NULL);
+    int self_rebuilt = 0;
+    int changed = 0;
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    while (1)
+    {
+        //act once the build has been quiet for a moment, rather than on its first write
+        struct pollfd poller = {notify, POLLIN, 0};
+        int ready = poll(&poller, 1, changed ? 200 : -1);
+        if (ready < 0 && errno != EINTR)
+        {
+            break;
+        }
+        if (ready > 0)
+        {
+            ssize_t length = read(notify, events, sizeof(events));
+            for (char *next = events; length > 0 && next < events + length; )
+            {
+                struct inotify_event *event = (struct inotify_event *) next;
+                next += sizeof(struct inotify_event) + event->len;
+                const char *directory = NULL;
+                for (int i = 0; i < watched_count && directory == NULL; i++)
+                {
+                    directory = watched[i].wd == event->wd ? watched[i].path : NULL;
+                }
+                if (event->len == 0 || directory == NULL)
+                {
+                    continue;
+                }
+                char path[PATH_MAX];
+                snprintf(path, sizeof(path), "%s/%s", directory, event->name);
+                int module = -1;
+                for (int i = 0; i < unit_test_module_count && module < 0; i++)
+                {
+                    module = strcmp(unit_test_modules[i].path, path) == 0 ? i : -1;
+                }
+                if (self != NULL && strcmp(self, path) == 0)
+                {
+                    self_rebuilt = changed = 1;
+                }
+                else if (module >= 0)
+                {
+                    rebuilt[module] = changed = 1;
+                }
+                else if (unit_test_is_source(event->name))
+                {
+                    unit_test_pending_change(&pending, path);
+                }
+            }
+            continue;
+        }
+        if (ready < 0)
+        {
+            continue;
+        }
+
+        changed = 0;
+        if (self_rebuilt)
+        {
+            self_rebuilt = 0;
+            unit_test_watch_exec(self, argv, &pending);
+        }
+        int rerun = 0;
+        int reloaded = 0;
+        for (int i = 0; i < unit_test_module_count; i++)
+        {
+            if (rebuilt[i])
+            {
+                rebuilt[i] = 0;
+                int count = unit_test_watch_reload(&unit_test_modules[i], &pending);
+                rerun += count > 0 ? count : 0;
+                reloaded += count >= 0;
+            }
+        }
+        if (reloaded > 0)
+        {
+            printf("\033[1;37mRebuilt %d modules; rerunning %d tests.\033[0m\n\n", reloaded, rerun);
+            unit_test_pending_clear(&pending);
+            unit_test_run_all(options);
+            unit_test_print_total_summary();
+            printf("\033[1;37mWatching for changes.\033[0m\n\n");
+            fflush(stdout);
+        }
+    }
+    close(notify);
+}
+
+/*
+*   Allocates an empty fixture and adds it to the fixtures list.
+*/
+static struct unit_test_fixture *unit_test_fixture_register(char *name) {
+    assert(name != NULL);
+    //a reloaded module gets back the fixtures its previous copy built
+    for (int i = 0; unit_test_reloading && i < fixture_count; i++)
+    {
+        if (strcmp(fixtures[i]->name, name) == 0)
+        {
+            return fixtures[i];
+        }
+    }
+    fixtures = realloc(fixtures, (fixture_count + 1) * sizeof(struct unit_test_fixture*));
+    struct unit_test_fixture *fixture = calloc(1, sizeof(struct unit_test_fixture));
+    assert(fixture != NULL);
+    fixture->name = name;
+    pthread_mutex_init(&fixture->lock, NULL);
+    pthread_cond_init(&fixture->built, NULL);
+    fixtures[fixture_count] = fixture;
+    fixture_count++;
+    return fixture;
+}
+
+/*
+*   This function creates a new fixture: shared setup which is built lazily
+*   the first time a test asks for it, shared read-only by every test which
+*   declares it, and torn down once the last of those tests has finished.
+*
+*   @param name - char* array representing the name of the fixture.
+*   @param void *(*setup)() - function pointer which builds the fixture and
+*       returns its data.
+*   @param void (*teardown)(void *data) - function pointer which releases
+*       the fixture's data. May be NULL.
+*   @returns unit_test_fixture* pointer representing the new fixture.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_fixture* unit_test_fixture_init(char *name, void *(*setup)(), void (*teardown)(void *data)) {
+    assert(setup != NULL);
+    struct unit_test_fixture *fixture = unit_test_fixture_register(name);
+    fixture->setup = setup;
+    fixture->teardown = teardown;
+    return fixture;
+}
+
+/*
+*   This function declares that a test uses a fixture. Declare every user
+*   of a fixture before running any of them, so the fixture is kept alive
+*   until the last one has finished.
+*
+*   @param *test - the unit_test which uses the fixture.
+*   @param *fixture - the fixture it uses.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_use_fixture(struct unit_test *test, struct unit_test_fixture *fixture) {
+    assert(test != NULL);
+    assert(fixture != NULL);
+    for (int i = 0; i < test->fixture_count; i++)
+    {
+        if (test->fixtures[i] == fixture) return;
+    }
+    test->fixtures = realloc(test->fixtures, (test->fixture_count + 1) * sizeof(struct unit_test_fixture*));
+    assert(test->fixtures != NULL);
+    test->fixtures[test->fixture_count++] = fixture;
+    pthread_mutex_lock(&fixture->lock);
+    fixture->users++;
+    pthread_mutex_unlock(&fixture->lock);
+}
+
+/*
+*   Snapshots start with one page of header, followed by the fixture data.
+*   The magic number is written last, after the data has been synced, so a
+*   snapshot left behind by a build which died part way is never reused.
+*/
+#define UNIT_TEST_SNAPSHOT_HEADER 4096
+#define UNIT_TEST_SNAPSHOT_MAGIC 0x31304E5350414E53ULL
+
+struct unit_test_snapshot_header {
+    unsigned long long magic;
+    unsigned long long size;
+};
+
+/*
+*   Maps an existing snapshot file copy-on-write, returning NULL if the
+*   file is missing or is not a complete snapshot of the right size.
+*/
+static void *unit_test_snapshot_load(const char *path, size_t size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    struct stat info;
+    struct unit_test_snapshot_header header;
+    void *base = NULL;
+    if (fstat(fd, &info) == 0 && (size_t) info.st_size == UNIT_TEST_SNAPSHOT_HEADER + size
+        && pread(fd, &header, sizeof(header), 0) == (ssize_t) sizeof(header)
+        && header.magic == UNIT_TEST_SNAPSHOT_MAGIC && header.size == size)
+    {
+        base = mmap(NULL, UNIT_TEST_SNAPSHOT_HEADER + size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED)
+        {
+            base = NULL;
+        }
+    }
+    close(fd);
+    return base;
+}
+
+/*
+*   Builds a snapshot into a temporary file, moves it into place and maps
+*   it copy-on-write. Returns NULL, with errno set, if any step fails.
+*/
+static void *unit_test_snapshot_save(struct unit_test_fixture *fixture) {
+    size_t size = fixture->snapshot_size;
+    size_t length = UNIT_TEST_SNAPSHOT_HEADER + size;
+    char temporary[4096];
+    snprintf(temporary, sizeof(temporary), "%s.%d.tmp", fixture->snapshot_path, (int) getpid());
+    int fd = open(temporary, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    char *base = MAP_FAILED;
+    if (ftruncate(fd, length) == 0)
+    {
+        base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (base == MAP_FAILED)
+    {
+        int error = errno;
+        close(fd);
+        unlink(temporary);
+        errno = error;
+        return NULL;
+    }
+    fixture->snapshot_build(base + UNIT_TEST_SNAPSHOT_HEADER, size);
+    msync(base, length, MS_SYNC);
+    struct unit_test_snapshot_header header = {UNIT_TEST_SNAPSHOT_MAGIC, size};
+    memcpy(base, &header, sizeof(header));
+    msync(base, UNIT_TEST_SNAPSHOT_HEADER, MS_SYNC);
+    munmap(base, length);
+    close(fd);
+    if (rename(temporary, fixture->snapshot_path) != 0)
+    {
+        int error = errno;
+        unlink(temporary);
+        errno = error;
+        return NULL;
+    }
+    return unit_test_snapshot_load(fixture->snapshot_path, size);
+}
+
+/*
+*   Builds a snapshot fixture. Without a path the data is built in a
+*   private anonymous mapping, which forked children inherit copy-on-write.
+*   With a path the data is built once into the file and every later run
+*   maps the file copy-on-write instead of building it again. If the file
+*   cannot be written the data is built in memory for this run only, and
+*   if even that cannot be mapped the fixture's data is NULL.
+*/
+static void *unit_test_snapshot_setup(struct unit_test_fixture *fixture) {
+    size_t size = fixture->snapshot_size;
+    char *base;
+
+    if (fixture->snapshot_path != NULL)
+    {
+        base = unit_test_snapshot_load(fixture->snapshot_path, size);
+        if (base == NULL)
+        {
+            base = unit_test_snapshot_save(fixture);
+        }
+        if (base != NULL)
+        {
+            return base + UNIT_TEST_SNAPSHOT_HEADER;
+        }
+        fprintf(stderr, "unit_test: could not save snapshot %s: %s\n", fixture->snapshot_path, strerror(errno));
+    }
+
+    base = mmap(NULL, UNIT_TEST_SNAPSHOT_HEADER + size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+    {
+        fprintf(stderr, "unit_test: could not map snapshot %s: %s\n", fixture->name, strerror(errno));
+        return NULL;
+    }
+    fixture->snapshot_build(base + UNIT_TEST_SNAPSHOT_HEADER, size);
+    return base + UNIT_TEST_SNAPSHOT_HEADER;
+}
+
+/*
+*   This function creates a fixture whose data lives in a memory mapping
+*   rather than on the heap. It is meant for tests run with
+*   unit_test_start_forked: the fixture is built once in the parent, and
+*   every child maps it copy-on-write, so each child starts from pristine
+*   data however much the previous one scribbled over it.
+*
+*   If path is not NULL the snapshot is also saved to that file, and later
+*   runs map the file instead of building the data again. Data in a file
+*   snapshot may be mapped at a different address on each run, so it must
+*   refer to itself with offsets rather than pointers.
+*
+*   @param name - char* array representing the name of the fixture.
+*   @param *path - file to keep the snapshot in, or NULL for none.
+*   @param size - number of bytes of data in the snapshot.
+*   @param void (*build)(void *base, size_t size) - function pointer which
+*       fills in the data at base.
+*   @returns unit_test_fixture* pointer representing the new fixture.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_fixture* unit_test_fixture_init_snapshot(char *name, const char *path, size_t size,
+    void (*build)(void *base, size_t size)) {
+    assert(build != NULL);
+    assert(size > 0);
+    struct unit_test_fixture *fixture = unit_test_fixture_register(name);
+    fixture->snapshot_path = path;
+    fixture->snapshot_size = size;
+    fixture->snapshot_build = build;
+    return fixture;
+}
+
+/*
+*   This function returns a fixture's data, building it first if no test
+*   has used it yet. If another thread is already building the fixture the
+*   caller waits for it rather than building a second copy. The returned
+*   data is shared and must be treated as read-only.
+*
+*   @param *test - the unit_test asking for the fixture. It should have
+*       declared the fixture with unit_test_use_fixture beforehand.
+*   @param *fixture - the fixture you want.
+*   @returns void* pointer to the data returned by the fixture's setup.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void *unit_test_fixture_get(struct unit_test *test, struct unit_test_fixture *fixture) {
+    assert(test != NULL);
+    assert(fixture != NULL);
+    if (__atomic_load_n(&fixture->state, __ATOMIC_ACQUIRE) == UNIT_TEST_FIXTURE_BUILT)
+    {
+        return fixture->data;
+    }
+
+    pthread_mutex_lock(&fixture->lock);
+    while (fixture->state == UNIT_TEST_FIXTURE_BUILDING)
+    {
+        pthread_cond_wait(&fixture->built, &fixture->lock);
+    }
+    if (fixture->state == UNIT_TEST_FIXTURE_UNBUILT)
+    {
+        fixture->state = UNIT_TEST_FIXTURE_BUILDING;
+        pthread_mutex_unlock(&fixture->lock);
+
+        double started = unit_test_now();
+        long long traced = unit_test_trace_begin();
+        void *data = fixture->snapshot_build != NULL ?
+            unit_test_snapshot_setup(fixture) : fixture->setup();
+        unit_test_trace_end(UNIT_TEST_TRACE_FIXTURE, fixture->name, traced);
+        double elapsed = unit_test_now() - started;
+
+        pthread_mutex_lock(&fixture->lock);
+        fixture->data = data;
+        fixture->build_time += elapsed;
+        fixture->builds++;
+        __atomic_store_n(&fixture->state, UNIT_TEST_FIXTURE_BUILT, __ATOMIC_RELEASE);
+        pthread_cond_broadcast(&fixture->built);
+    }
+    void *data = fixture->data;
+    pthread_mutex_unlock(&fixture->lock);
+    return data;
+}
+
+/*
+*   Tears a built fixture down and returns it to the unbuilt state, so a
+*   late user would build it again.
+*/
+static void unit_test_fixture_teardown(struct unit_test_fixture *fixture) {
+    pthread_mutex_lock(&fixture->lock);
+    if (fixture->state == UNIT_TEST_FIXTURE_BUILT)
+    {
+        if (fixture->snapshot_build != NULL && fixture->data != NULL)
+        {
+            munmap((char *) fixture->data - UNIT_TEST_SNAPSHOT_HEADER,
+                UNIT_TEST_SNAPSHOT_HEADER + fixture->snapshot_size);
+        }
+        else if (fixture->teardown != NULL)
+        {
+            fixture->teardown(fixture->data);
+        }
+        fixture->data = NULL;
+        __atomic_store_n(&fixture->state, UNIT_TEST_FIXTURE_UNBUILT, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&fixture->lock);
+}
+
+/*
+*   Marks a test as finished with each fixture it declared, tearing down
+*   any fixture whose last user this was.
+*/
+static void unit_test_release_fixtures(struct unit_test *test) {
+    for (int i = 0; i < test->fixture_count; i++)
+    {
+        struct unit_test_fixture *fixture = test->fixtures[i];
+        pthread_mutex_lock(&fixture->lock);
+        int last = ++fixture->finished >= fixture->users;
+        pthread_mutex_unlock(&fixture->lock);
+        if (last && !unit_test_watching)
+        {
+            unit_test_fixture_teardown(fixture);
+        }
+    }
+}
+
+/*
+*   State shared between the threads of a single stress run.
+*/
+struct unit_test_stress_run {
+    struct unit_test *test;
+    void (*body)(struct unit_test *test, int thread, long iteration);
+    struct unit_test_stress options;
+    int *cpus;
+    int cpu_count;
+    int ready;
+    int go;
+    int stop;
+    double started;
+};
+
+struct unit_test_stress_worker {
+    pthread_t thread;
+    int index;
+    struct unit_test_stress_run *run;
+    long long completed;
+    double elapsed;
+    int finished;
+};
+
+static void *unit_test_stress_main(void *arg) {
+    struct unit_test_stress_worker *worker = arg;
+    struct unit_test_stress_run *run = worker->run;
+    unsigned long long seed = 0x9E3779B97F4A7C15ULL * (worker->index + 1);
+
+    if (run->options.pin_threads && run->cpu_count > 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(run->cpus[worker->index % run->cpu_count], &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    unit_test_stress_thread = worker->index;
+    __atomic_fetch_add(&run->ready, 1, __ATOMIC_ACQ_REL);
+    while (!__atomic_load_n(&run->go, __ATOMIC_ACQUIRE))
+    {
+        unit_test_cpu_relax();
+    }
+
+    long long traced = unit_test_trace_begin();
+    long iteration = 0;
+    for (; run->options.iterations <= 0 || iteration < run->options.iterations; iteration++)
+    {
+        if (__atomic_load_n(&run->stop, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+        unit_test_stress_iteration = iteration;
+        run->body(run->test, worker->index, iteration);
+        if (run->options.random_yields)
+        {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            if ((seed & 15) == 0)
+            {
+                sched_yield();
+            }
+        }
+    }
+    unit_test_trace_end(UNIT_TEST_TRACE_STRESS, run->test->name, traced);
+    worker->elapsed = unit_test_now() - run->started;
+    worker->completed = iteration;
+    __atomic_store_n(&worker->finished, 1, __ATOMIC_RELEASE);
+    unit_test_stress_thread = -1;
+    return NULL;
+}
+
+/*
+*   This function runs a test body concurrently on a number of threads to
+*   stress code which must be safe under contention. Every thread is held at
+*   a spin barrier until all of them are running, then released at once.
+*   Each thread calls body repeatedly until it has completed the requested
+*   number of iterations or the time budget runs out, whichever comes first.
+*   Failures report the thread and iteration they happened on, and the
+*   throughput of the run is printed with the test's summary.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param void (*body)() - function pointer called for every iteration with
+*       the test, the thread index and the iteration number.
+*   @param *options - the stress configuration. threads must be positive,
+*       and at least one of iterations or duration must be set.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_stress(struct unit_test *test, void (*body)(struct unit_test *test, int thread, long iteration),
+    struct unit_test_stress *options) {
+    assert(test != NULL);
+    assert(body != NULL);
+    assert(options != NULL);
+    assert(options->threads > 0);
+    assert(options->iterations > 0 || options->duration > 0);
+
+    struct unit_test_stress_run run = {.test = test, .body = body, .options = *options};
+    if (options->pin_threads)
+    {
+        cpu_set_t allowed;
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+        {
+            run.cpus = calloc(CPU_COUNT(&allowed), sizeof(int));
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+            {
+                if (CPU_ISSET(cpu, &allowed))
+                {
+                    run.cpus[run.cpu_count++] = cpu;
+                }
+            }
+        }
+    }
+
+    struct unit_test_stress_worker *workers = calloc(options->threads, sizeof(struct unit_test_stress_worker));
+    assert(workers != NULL);
+    //if the system runs out of threads, the run goes ahead with the ones which started
+    int threads = 0;
+    for (; threads < options->threads; threads++)
+    {
+        workers[threads].index = threads;
+        workers[threads].run = &run;
+        int created = pthread_create(&workers[threads].thread, NULL, &unit_test_stress_main, &workers[threads]);
+        if (created != 0)
+        {
+            fprintf(stderr, "unit_test: %s: could only start %d of %d stress threads: %s\n", test->name,
+                threads, options->threads, strerror(created));
+            break;
+        }
+    }
+    if (threads == 0)
+    {
+        free(workers);
+        free(run.cpus);
+        return;
+    }
+    while (__atomic_load_n(&run.ready, __ATOMIC_ACQUIRE) < threads)
+    {
+        unit_test_cpu_relax();
+    }
+    run.started = unit_test_now();
+    __atomic_store_n(&run.go, 1, __ATOMIC_RELEASE);
+
+    if (options->duration > 0)
+    {
+        double deadline = run.started + options->duration;
+        int finished = 0;
+        while (!finished)
+        {
+            double remaining = deadline - unit_test_now();
+            if (remaining <= 0)
+            {
+                break;
+            }
+            struct timespec pause = {0, (long) ((remaining < 0.001 ? remaining : 0.001) * 1e9)};
+            nanosleep(&pause, NULL);
+            finished = 1;
+            for (int i = 0; i < threads && finished; i++)
+            {
+                finished = __atomic_load_n(&workers[i].finished, __ATOMIC_ACQUIRE);
+            }
+        }
+        __atomic_store_n(&run.stop, 1, __ATOMIC_RELAXED);
+    }
+
+    struct unit_test_stress_result *result = calloc(1, sizeof(struct unit_test_stress_result));
+    assert(result != NULL);
+    result->threads = threads;
+    result->completed = calloc(threads, sizeof(long long));
+    result->elapsed = calloc(threads, sizeof(double));
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+        result->completed[i] = workers[i].completed;
+        result->elapsed[i] = workers[i].elapsed;
+        result->operations += workers[i].completed;
+        if (workers[i].elapsed > result->seconds)
+        {
+            result->seconds = workers[i].elapsed;
+        }
+    }
+
+    struct unit_test_stress_result **tail = &test->stress;
+    while (*tail != NULL)
+    {
+        tail = &(*tail)->next;
+    }
+    *tail = result;
+    free(workers);
+    free(run.cpus);
+}
+
+/*
+*   A buffer larger than the last level cache, written through between
+*   benchmark samples to evict whatever the body left in the caches.
+*/
+static volatile char *unit_test_eviction = NULL;
+static size_t unit_test_eviction_size = 0;
+static size_t unit_test_eviction_line = 64;
+
+static void unit_test_evict_caches() {
+    if (unit_test_eviction == NULL)
+    {
+        long largest = 0;
+        int levels[] = {_SC_LEVEL1_DCACHE_SIZE, _SC_LEVEL2_CACHE_SIZE, _SC_LEVEL3_CACHE_SIZE, _SC_LEVEL4_CACHE_SIZE};
+        for (int i = 0; i < 4; i++)
+        {
+            long size = sysconf(levels[i]);
+            largest = size > largest ? size : largest;
+        }
+        long line = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+        unit_test_eviction_line = line > 0 ? (size_t) line : 64;
+        unit_test_eviction_size = largest > 0 ? 2 * (size_t) largest : (size_t) 64 << 20;
+        unit_test_eviction = malloc(unit_test_eviction_size);
+        assert(unit_test_eviction != NULL);
+    }
+    for (size_t i = 0; i < unit_test_eviction_size; i += unit_test_eviction_line)
+    {
+        unit_test_eviction[i]++;
+    }
+}
+
+/*
+*   Reads the first line of a file under /proc or /sys into line, without
+*   its newline. Returns 0 if the file could not be read.
+*/
+static int unit_test_read_line(const char *path, char *line, int size) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return 0;
+    }
+    int got = fgets(line, size, file) != NULL;
+    fclose(file);
+    line[strcspn(line, "\n")] = '\0';
+    return got;
+}
+
+/*
+*   Looks for settings of the machine which make timings vary from run to
+*   run, and describes each one found in warnings.
+*/
+static void unit_test_benchmark_environment(struct unit_test_buffer *warnings, int cpu) {
+    char path[128];
+    char line[256];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpu < 0 ? 0 : cpu);
+    if (unit_test_read_line(path, line, sizeof(line)) && strcmp(line, "performance") != 0)
+    {
+        unit_test_buffer_printf(warnings, "\tCPU %d frequency scaling governor is '%s', not 'performance'.\n",
+            cpu < 0 ? 0 : cpu, line);
+    }
+    if (unit_test_read_line("/sys/devices/system/cpu/intel_pstate/no_turbo", line, sizeof(line))
+        && strcmp(line, "0") == 0)
+    {
+        unit_test_buffer_printf(warnings, "\tTurbo boost is enabled.\n");
+    }
+    else if (unit_test_read_line("/sys/devices/system/cpu/cpufreq/boost", line, sizeof(line))
+        && strcmp(line, "1") == 0)
+    {
+        unit_test_buffer_printf(warnings, "\tFrequency boost is enabled.\n");
+    }
+
+    FILE *stat = fopen("/proc/stat", "r");
+    if (stat != NULL)
+    {
+        while (fgets(line, sizeof(line), stat) != NULL)
+        {
+            int running;
+            //the benchmark itself is one of the running tasks
+            if (sscanf(line, "procs_running %d", &running) == 1 && running > 1)
+            {
+                char load[64] = "";
+                unit_test_read_line("/proc/loadavg", load, sizeof(load));
+                unit_test_buffer_printf(warnings, "\t%d other tasks are running (load average %.*s).\n",
+                    running - 1, (int) strcspn(load, " "), load);
+            }
+        }
+        fclose(stat);
+    }
+}
+
+static int unit_test_double_compare(const void *x, const void *y) {
+    double a = *(const double *) x;
+    double b = *(const double *) y;
+    return (a > b) - (a < b);
+}
+
+/*
+*   This function measures how long body takes to run, taking steps to
+*   keep the measurement from changing from run to run. The body is run
+*   for warmup untimed samples and then samples timed ones, each of
+*   iterations calls, optionally on a single core and with the caches
+*   flushed or warmed before every sample. Before starting, the CPU
+*   frequency governor, turbo boost and the number of other running tasks
+*   are checked, and anything likely to disturb the timings is listed in
+*   the test's summary.
+*
+*   The summary gives the mean, median and fastest time per call and the
+*   coefficient of variation (standard deviation over mean) of the
+*   samples. Measurements whose coefficient of variation is above max_cv
+*   are marked unstable, so that they are not trusted by mistake.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *body - the code to measure, called with the test and the
+*       number of the call within its sample.
+*   @param *options - the benchmark configuration.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_benchmark(struct unit_test *test, void (*body)(struct unit_test *test, long iteration),
+    struct unit_test_benchmark *options) {
+    assert(test != NULL);
+    assert(body != NULL);
+    assert(options != NULL);
+    assert(options->samples >= 0 && options->iterations >= 0 && options->warmup >= 0);
+    int samples = options->samples > 0 ? options->samples : 30;
+    long iterations = options->iterations > 0 ? options->iterations : 1;
+
+    struct unit_test_benchmark_result *result = calloc(1, sizeof(struct unit_test_benchmark_result));
+    double *times = calloc(samples, sizeof(double));
+    assert(result != NULL && times != NULL);
+    result->name = options->name;
+    result->samples = samples;
+    result->iterations = iterations;
+    result->max_cv = options->max_cv > 0 ? options->max_cv : 0.05;
+    result->cpu = -1;
+
+    struct unit_test_buffer warnings = {0};
+    cpu_set_t previous;
+    int pinned = 0;
+    if (options->pin_cpu)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(options->cpu, &set);
+        pinned = sched_getaffinity(0, sizeof(previous), &previous) == 0
+            && sched_setaffinity(0, sizeof(set), &set) == 0;
+        if (pinned)
+        {
+            result->cpu = options->cpu;
+        }
+        else
+        {
+            unit_test_buffer_printf(&warnings, "\tCould not pin to CPU %d: %s.\n", options->cpu, strerror(errno));
+        }
+    }
+    unit_test_benchmark_environment(&warnings, result->cpu >= 0 ? result->cpu : sched_getcpu());
+
+    for (int sample = -options->warmup; sample < samples; sample++)
+    {
+        if (options->cache == UNIT_TEST_CACHE_FLUSH)
+        {
+            unit_test_evict_caches();
+        }
+        else if (options->cache == UNIT_TEST_CACHE_WARM)
+        {
+            body(test, 0);
+        }
+        long long started = unit_test_trace_clock();
+        for (long i = 0; i < iterations; i++)
+        {
+            body(test, i);
+        }
+        long long elapsed = unit_test_trace_clock() - started;
+        if (sample >= 0)
+        {
+            times[sample] = elapsed / 1e9 / iterations;
+        }
+    }
+    if (pinned)
+    {
+        sched_setaffinity(0, sizeof(previous), &previous);
+    }
+
+    double sum = 0;
+    for (int i = 0; i < samples; i++)
+    {
+        sum += times[i];
+    }
+    result->mean = sum / samples;
+    double squares = 0;
+    for (int i = 0; i < samples; i++)
+    {
+        squares += (times[i] - result->mean) * (times[i] - result->mean);
+    }
+    double deviation = samples > 1 ? squares / (samples - 1) : 0;
+    //square root by Newton's method, to avoid linking the math library
+    double root = deviation > 0 ? deviation : 0;
+    for (int i = 0; i < 64 && root > 0; i++)
+    {
+        root = (root + deviation / root) / 2;
+    }
+    result->cv = result->mean > 0 ? root / result->mean : 0;
+    qsort(times, samples, sizeof(double), &unit_test_double_compare);
+    result->min = times[0];
+    result->median = samples % 2 ? times[samples / 2] : (times[samples / 2 - 1] + times[samples / 2]) / 2;
+    result->warnings = warnings.data;
+    free(times);
+
+    struct unit_test_benchmark_result **tail = &test->benchmarks;
+    while (*tail != NULL)
+    {
+        tail = &(*tail)->next;
+    }
+    *tail = result;
+}
+
+/*
+*   This function takes two pointers and tests if they point to the same memory
+*   address. 
+*
+*   @param *test - the unit_test you wish to use to track the results. 
+*   @param *a - the first pointer you are comparing
+*   @param *b - the second pointer you are comparing
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*
+*   @author Brennan Hurst
+*   @version 10/07/2021
+*/
+void unit_test_assert_same_address(struct unit_test *test, const char *fname, int lineno, void *a, void *b) {
+    assert(test != NULL);
+    assert(fname != NULL);
+    assert(a != NULL);
+    assert(b != NULL);
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_ADDRESS, .passed = a == b};
+    event.a.p = a;
+    event.b.p = b;
+    unit_test_report(&event);
+}
+
+/*
+*   This function takes two floats and determines if they both contain the same
+*   value.
+*
+*   @param *test - the unit_test you wish to use to track the results. 
+*   @param a - the first float you are comparing
+*   @param b - the second float you are comparing
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*
+*   @author Brennan Hurst
+*   @version 10/07/2021
+*/
+void unit_test_assert_float_equals(struct unit_test *test, const char *fname, int lineno, float a, float b) {
+    assert(test != NULL);
+    assert(fname != NULL);
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_FLOAT, .passed = a == b};
+    event.a.f = a;
+    event.b.f = b;
+    unit_test_report(&event);
+}
+
+/*
+*   This function takes two integers and determines if they both contain the same
+*   value.
+*
+*   @param *test - the unit_test you wish to use to track the results. 
+*   @param a - the first integers you are comparing
+*   @param b - the second integers you are comparing
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*
+*   @author Brennan Hurst
+*   @version 10/07/2021
+*/
+void unit_test_assert_int_equals(struct unit_test *test, const char *fname, int lineno, int a, int b) {
+    assert(test != NULL);
+    assert(fname != NULL);
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_INT, .passed = a == b};
+    event.a.i = a;
+    event.b.i = b;
+    unit_test_report(&event);
+}
+
+/*
+*   This function takes two doubles and determines if they both contain the same
+*   value.
+*
+*   @param *test - the unit_test you wish to use to track the results. 
+*   @param a - the first doubles you are comparing
+*   @param b - the second doubles you are comparing
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*
+*   @author Brennan Hurst
+*   @version 10/07/2021
+*/
+void unit_test_assert_double_equals(struct unit_test *test, const char *fname, int lineno, double a, double b) {
+    assert(test != NULL);
+    assert(fname != NULL);
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_DOUBLE, .passed = a == b};
+    event.a.d = a;
+    event.b.d = b;
+    unit_test_report(&event);
+}
+
+/*
+*   This function takes two longs and determines if they both contain the same
+*   value.
+*
+*   @param *test - the unit_test you wish to use to track the results. 
+*   @param a - the first long you are comparing
+*   @param b - the second long you are comparing
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*
+*   @author Brennan Hurst
+*   @version 10/07/2021
+*/
+void unit_test_assert_long_equals(struct unit_test *test, const char *fname, int lineno, long a, long b) {
+    assert(test != NULL);
+    assert(fname != NULL);
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_LONG, .passed = a == b};
+    event.a.l = a;
+    event.b.l = b;
+    unit_test_report(&event);
+}
+
+/*
+*   This function takes two chars and determines if they both contain the same
+*   value.
+*
+*   @param *test - the unit_test you wish to use to track the results. 
+*   @param a - the first char you are comparing
+*   @param b - the second char you are comparing
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*
+*   @author Brennan Hurst
+*   @version 10/07/2021
+*/
+void unit_test_assert_char_equals(struct unit_test *test, const char *fname, int lineno, char a, char b) {
+    assert(test != NULL);
+    assert(fname != NULL);
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_CHAR, .passed = a == b};
+    event.a.c = a;
+    event.b.c = b;
+    unit_test_report(&event);
+}
+
+/*
+*   Returns element i of an array of the given scalar kind.
+*/
+static union unit_test_value unit_test_element(int kind, const void *array, size_t i) {
+    union unit_test_value value;
+    switch (kind)
+    {
+        case UNIT_TEST_KIND_FLOAT:
+            value.f = ((const float *) array)[i];
+            break;
+        case UNIT_TEST_KIND_INT:
+            value.i = ((const int *) array)[i];
+            break;
+        case UNIT_TEST_KIND_DOUBLE:
+            value.d = ((const double *) array)[i];
+            break;
+        case UNIT_TEST_KIND_LONG:
+            value.l = ((const long *) array)[i];
+            break;
+        default:
+            value.c = ((const char *) array)[i];
+            break;
+    }
+    return value;
+}
+
+/*
+*   Returns the index of the first element at which two arrays of the given
+*   scalar kind differ, or count if they are equal.
+*/
+static size_t unit_test_array_mismatch(int kind, const void *a, const void *b, size_t count) {
+    size_t i = 0;
+    switch (kind)
+    {
+        case UNIT_TEST_KIND_FLOAT:
+            for (; i < count && ((const float *) a)[i] == ((const float *) b)[i]; i++);
+            break;
+        case UNIT_TEST_KIND_INT:
+            for (; i < count && ((const int *) a)[i] == ((const int *) b)[i]; i++);
+            break;
+        case UNIT_TEST_KIND_DOUBLE:
+            for (; i < count && ((const double *) a)[i] == ((const double *) b)[i]; i++);
+            break;
+        case UNIT_TEST_KIND_LONG:
+            for (; i < count && ((const long *) a)[i] == ((const long *) b)[i]; i++);
+            break;
+        default:
+            for (; i < count && ((const char *) a)[i] == ((const char *) b)[i]; i++);
+            break;
+    }
+    return i;
+}
+
+/*
+*   Formats the members of an array as a bracketed list. The element at
+*   index highlight (if any) is printed in red.
+*/
+static void unit_test_format_array(struct unit_test_buffer *out, int element, const void *array,
+    size_t count, size_t highlight) {
+    for (size_t j = 0; j < count; j++)
+    {
+        if (j == highlight)
+        {
+            unit_test_buffer_printf(out, "\033[1;31m");
+            unit_test_format_value(out, element, unit_test_element(element, array, j));
+            unit_test_buffer_printf(out, "\033[0m");
+        }
+        else
+        {
+            if (highlight != (size_t) -1)
+            {
+                unit_test_buffer_printf(out, "\033[1;32m");
+            }
+            unit_test_format_value(out, element, unit_test_element(element, array, j));
+        }
+        if (j < count - 1)
+        {
+            unit_test_buffer_printf(out, ", ");
+        }
+    }
+}
+
+/*
+*   Shared implementation of the array equality assertions. asize and bsize
+*   are sizes in bytes, as given by sizeof.
+*/
+static void unit_test_assert_array_equals(struct unit_test *test, const char *fname, int lineno, int kind,
+    const void *a, int asize, const void *b, int bsize, size_t width) {
+    assert(a != NULL);
+    assert(b != NULL);
+    assert(test != NULL);
+    assert(fname != NULL);
+
+    const struct unit_test_kind_info *info = &unit_test_kinds[kind];
+    size_t acount = asize / width;
+    size_t bcount = bsize / width;
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno, .kind = kind, .passed = 0};
+
+    if (asize == bsize)
+    {
+        size_t i = unit_test_array_mismatch(info->element, a, b, acount);
+        event.passed = i == acount;
+        if (!event.passed)
+        {
+            struct unit_test_buffer out = {0};
+            unit_test_buffer_printf(&out, "\tAssertion expected:\n");
+            unit_test_buffer_printf(&out, "\t\033[1;32m[");
+            unit_test_format_array(&out, info->element, a, acount, (size_t) -1);
+            unit_test_buffer_printf(&out, "]\n\033[0m");
+            unit_test_buffer_printf(&out, "\tbut got:\n");
+            unit_test_buffer_printf(&out, "\t\033[1;32m[");
+            unit_test_format_array(&out, info->element, b, bcount, i);
+            unit_test_buffer_printf(&out, "]\n\033[0m");
+            event.detail = unit_test_buffer_detach(&out);
+        }
+    }
+    else
+    {
+        struct unit_test_buffer out = {0};
+        unit_test_buffer_printf(&out, "\n\t\033[1;31m%s arrays are of uneven length.\033[0m\n\n", info->noun);
+        unit_test_buffer_printf(&out, "\tAssertion expected:\n");
+        unit_test_buffer_printf(&out, "\t\033[1;32m[");
+        unit_test_format_array(&out, info->element, a, acount, (size_t) -1);
+        unit_test_buffer_printf(&out, "] (Array Length: %d)\n\033[0m", (int) acount);
+        unit_test_buffer_printf(&out, "\tbut got:\n");
+        unit_test_buffer_printf(&out, "\t\033[1;31m[");
+        unit_test_format_array(&out, info->element, b, bcount, (size_t) -1);
+        unit_test_buffer_printf(&out, "] \033[1;31m(Array Length: %d)\n\033[0m", (int) bcount);
+        event.detail = unit_test_buffer_detach(&out);
+    }    
+    unit_test_report(&event);
+}
+
+/*
+*   This function takes two floats and determines if they both contain the same
+*   value.
+*
+*   @param *test - the unit_test you wish to use to track the results. 
+*   @param a - the first float array are comparing
+*   @param b - the second float array are comparing
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param asize - the size of array a.
+*   @param bsize - the size of array b.
+*
+*   @author Brennan Hurst
+*   @version 10/09/2021
+*/
+void unit_test_assert_float_array_equals(struct unit_test *test, const char *fname, int lineno, float *a, int asize, float *b, int bsize) {
+    unit_test_assert_array_equals(test, fname, lineno, UNIT_TEST_KIND_FLOAT_ARRAY,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   This function takes two integers and determines if they both contain the same
+*   value.
+*
+*   @param *test - the unit_test you wish to use to track the results. 
+*   @param a - the first integer array you are comparing
+*   @param b - the second integer array you are comparing
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param asize - the size of array a.
+*   @param bsize - the size of array b.
+*   @author Brennan Hurst
+*   @version 10/09/2021
+*/
+void unit_test_assert_int_array_equals(struct unit_test *test, const char *fname, int lineno, int *a, int asize, int *b, int bsize) {
+    unit_test_assert_array_equals(test, fname, lineno, UNIT_TEST_KIND_INT_ARRAY,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   This function takes two doubles and determines if they both contain the same
+*   value.
+*
+*   @param *test - the unit_test you wish to use to track the results. 
+*   @param a - the first double array you are comparing
+*   @param b - the second double array you are comparing
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param asize - the size of array a.
+*   @param bsize - the size of array b.
+*
+*   @author Brennan Hurst
+*   @version 10/09/2021
+*/
+void unit_test_assert_double_array_equals(struct unit_test *test, const char *fname, int lineno, double *a, int asize, double *b, int bsize) {
+    unit_test_assert_array_equals(test, fname, lineno, UNIT_TEST_KIND_DOUBLE_ARRAY,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   This function takes two longs and determines if they both contain the same
+*   value.
+*
+*   @param *test - the unit_test you wish to use to track the results. 
+*   @param a - the first long array you are comparing
+*   @param b - the second long array you are comparing
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param asize - the size of array a.
+*   @param bsize - the size of array b.
+*
+*   @author Brennan Hurst
+*   @version 10/09/2021
+*/
+void unit_test_assert_long_array_equals(struct unit_test *test, const char *fname, int lineno, long *a, int asize, long *b, int bsize) {
+    unit_test_assert_array_equals(test, fname, lineno, UNIT_TEST_KIND_LONG_ARRAY,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   This function takes two chars and determines if they both contain the same
+*   value.
+*
+*   @param *test - the unit_test you wish to use to track the results. 
+*   @param a - the first char array you are comparing
+*   @param b - the second char array you are comparing
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param asize - the size of array a.
+*   @param bsize - the size of array b.
+*
+*   @author Brennan Hurst
+*   @version 10/09/2021
+*/
+void unit_test_assert_char_array_equals(struct unit_test *test, const char *fname, int lineno, char *a, int asize, char *b, int bsize) {
+    unit_test_assert_array_equals(test, fname, lineno, UNIT_TEST_KIND_CHAR_ARRAY,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   The unordered assertions work on 64-bit keys which sort in the same
+*   order as the values they were made from: signed integers are offset so
+*   that they are never negative, and floating point numbers have their
+*   sign bit flipped, or every bit flipped when they are negative. The keys
+*   are radix sorted, so comparing two arrays as multisets is linear in
+*   their length. The smallest key is subtracted from every key first, so
+*   that values which span a small range need few passes.
+*/
+#define UNIT_TEST_SIGN_BIT 0x8000000000000000ULL
+#define UNIT_TEST_MAX_DIFFERENCES 10
+
+/*
+*   Returns the key of an element of an array.
+*/
+static unsigned long long unit_test_key(int element, const void *array, size_t i) {
+    unsigned int bits;
+    unsigned long long wide;
+    switch (element)
+    {
+        case UNIT_TEST_KIND_FLOAT:
+            memcpy(&bits, (const float *) array + i, sizeof(bits));
+            return bits & 0x80000000U ? ~bits : bits | 0x80000000U;
+        case UNIT_TEST_KIND_INT:
+            return (unsigned long long) ((long long) ((const int *) array)[i] + 0x80000000LL);
+        case UNIT_TEST_KIND_DOUBLE:
+            memcpy(&wide, (const double *) array + i, sizeof(wide));
+            return wide & UNIT_TEST_SIGN_BIT ? ~wide : wide | UNIT_TEST_SIGN_BIT;
+        case UNIT_TEST_KIND_LONG:
+            return (unsigned long long) ((const long *) array)[i] ^ UNIT_TEST_SIGN_BIT;
+        default:
+            return (unsigned long long) ((long long) ((const char *) array)[i] + 128);
+    }
+}
+
+/*
+*   Turns a key back into the value it was made from.
+*/
+static union unit_test_value unit_test_key_value(int element, unsigned long long key) {
+    union unit_test_value value;
+    unsigned int bits;
+    switch (element)
+    {
+        case UNIT_TEST_KIND_FLOAT:
+            bits = (unsigned int) key;
+            bits = bits & 0x80000000U ? bits & 0x7FFFFFFFU : ~bits;
+            memcpy(&value.f, &bits, sizeof(bits));
+            break;
+        case UNIT_TEST_KIND_INT:
+            value.i = (int) ((long long) key - 0x80000000LL);
+            break;
+        case UNIT_TEST_KIND_DOUBLE:
+            key = key & UNIT_TEST_SIGN_BIT ? key & ~UNIT_TEST_SIGN_BIT : ~key;
+            memcpy(&value.d, &key, sizeof(key));
+            break;
+        case UNIT_TEST_KIND_LONG:
+            value.l = (long) (key ^ UNIT_TEST_SIGN_BIT);
+            break;
+        default:
+            value.c = (char) ((long long) key - 128);
+            break;
+    }
+    return value;
+}
+
+/*
+*   Subtracts base from each key and sorts them with a least significant
+*   digit radix sort, one byte per pass. The counts for every pass are
+*   gathered in a single read of the keys, and passes over bytes which are
+*   the same in every key are skipped.
+*/
+static void unit_test_radix_sort(unsigned long long *keys, unsigned long long *scratch, size_t count,
+    unsigned long long base) {
+    static __thread size_t counts[8][256];
+    memset(counts, 0, sizeof(counts));
+    for (size_t i = 0; i < count; i++)
+    {
+        unsigned long long key = keys[i] - base;
+        keys[i] = key;
+        for (int pass = 0; pass < 8; pass++)
+        {
+            counts[pass][(key >> (pass * 8)) & 0xFF]++;
+        }
+    }
+
+    unsigned long long *from = keys;
+    unsigned long long *to = scratch;
+    for (int pass = 0; pass < 8 && count > 0; pass++)
+    {
+        int shift = pass * 8;
+        if (counts[pass][(from[0] >> shift) & 0xFF] == count)
+        {
+            continue;
+        }
+        size_t offset = 0;
+        for (int digit = 0; digit < 256; digit++)
+        {
+            size_t digits = counts[pass][digit];
+            counts[pass][digit] = offset;
+            offset += digits;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            to[counts[pass][(from[i] >> shift) & 0xFF]++] = from[i];
+        }
+        unsigned long long *swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != keys)
+    {
+        memcpy(keys, from, count * sizeof(unsigned long long));
+    }
+}
+
+/*
+*   Returns the keys of an array, lowering *least to the smallest of them.
+*/
+static unsigned long long *unit_test_keys(int element, const void *array, size_t count,
+    unsigned long long *least) {
+    unsigned long long *keys = malloc((count > 0 ? count : 1) * sizeof(unsigned long long));
+    assert(keys != NULL);
+    unsigned long long smallest = *least;
+    for (size_t i = 0; i < count; i++)
+    {
+        keys[i] = unit_test_key(element, array, i);
+        smallest = keys[i] < smallest ? keys[i] : smallest;
+    }
+    *least = smallest;
+    return keys;
+}
+
+/*
+*   Elements which one array holds more times than another. Only the first
+*   UNIT_TEST_MAX_DIFFERENCES are kept, but all of them are counted.
+*/
+struct unit_test_differences {
+    unsigned long long keys[UNIT_TEST_MAX_DIFFERENCES];
+    size_t counts[UNIT_TEST_MAX_DIFFERENCES];
+    size_t distinct;
+    size_t total;
+};
+
+static void unit_test_add_difference(struct unit_test_differences *differences, unsigned long long key,
+    size_t count) {
+    if (differences->distinct < UNIT_TEST_MAX_DIFFERENCES)
+    {
+        differences->keys[differences->distinct] = key;
+        differences->counts[differences->distinct] = count;
+    }
+    differences->distinct++;
+    differences->total += count;
+}
+
+/*
+*   Prints a list of differences, such as "5 (x2), 7".
+*/
+static void unit_test_format_differences(struct unit_test_buffer *out, const char *label, int element,
+    struct unit_test_differences *differences) {
+    unit_test_buffer_printf(out, "\t%s \033[1;31m%zu\033[0m element%s:\033[1;31m", label,
+        differences->total, differences->total == 1 ? "" : "s");
+    size_t shown = differences->distinct < UNIT_TEST_MAX_DIFFERENCES
+        ? differences->distinct : UNIT_TEST_MAX_DIFFERENCES;
+    for (size_t i = 0; i < shown; i++)
+    {
+        unit_test_buffer_printf(out, i == 0 ? " " : ", ");
+        unit_test_format_value(out, element, unit_test_key_value(element, differences->keys[i]));
+        if (differences->counts[i] > 1)
+        {
+            unit_test_buffer_printf(out, " (x%zu)", differences->counts[i]);
+        }
+    }
+    if (differences->distinct > shown)
+    {
+        unit_test_buffer_printf(out, " and %zu more distinct values", differences->distinct - shown);
+    }
+    unit_test_buffer_printf(out, "\033[0m\n");
+}
+
+/*
+*   Compares two arrays as multisets. For UNIT_TEST_KIND_*_SUBSET only
+*   elements missing from b fail the assertion.
+*/
+static void unit_test_assert_multiset(struct unit_test *test, const char *fname, int lineno, int kind,
+    const void *a, size_t asize, const void *b, size_t bsize, size_t width) {
+    assert(test != NULL);
+    assert(fname != NULL);
+    assert(a != NULL || asize == 0);
+    assert(b != NULL || bsize == 0);
+
+    int element = unit_test_kinds[kind].element;
+    int subset = kind >= UNIT_TEST_KIND_FLOAT_SUBSET && kind <= UNIT_TEST_KIND_CHAR_SUBSET;
+    size_t acount = asize / width;
+    size_t bcount = bsize / width;
+    unsigned long long base = ~0ULL;
+    unsigned long long *akeys = unit_test_keys(element, a, acount, &base);
+    unsigned long long *bkeys = unit_test_keys(element, b, bcount, &base);
+    unsigned long long *scratch = malloc((acount > bcount ? acount : bcount) * sizeof(unsigned long long) + 1);
+    assert(scratch != NULL);
+    unit_test_radix_sort(akeys, scratch, acount, base);
+    unit_test_radix_sort(bkeys, scratch, bcount, base);
+    free(scratch);
+
+    struct unit_test_differences missing = {0};
+    struct unit_test_differences extra = {0};
+    size_t i = 0;
+    size_t j = 0;
+    while (i < acount || j < bcount)
+    {
+        unsigned long long key;
+        if (j == bcount || (i < acount && akeys[i] <= bkeys[j]))
+        {
+            key = akeys[i];
+        }
+        else
+        {
+            key = bkeys[j];
+        }
+        size_t ain = 0;
+        size_t bin = 0;
+        for (; i < acount && akeys[i] == key; i++, ain++);
+        for (; j < bcount && bkeys[j] == key; j++, bin++);
+        if (ain > bin)
+        {
+            unit_test_add_difference(&missing, key + base, ain - bin);
+        }
+        else if (bin > ain && !subset)
+        {
+            unit_test_add_difference(&extra, key + base, bin - ain);
+        }
+    }
+    free(akeys);
+    free(bkeys);
+
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno, .kind = kind, .passed = 0};
+    event.passed = missing.total == 0 && extra.total == 0;
+    if (!event.passed)
+    {
+        struct unit_test_buffer out = {0};
+        if (subset)
+        {
+            unit_test_buffer_printf(&out, "\tAssertion expected all \033[1;31m%zu\033[0m elements of the"
+                " first array to be in the second array of \033[1;31m%zu\033[0m elements.\n", acount, bcount);
+        }
+        else
+        {
+            unit_test_buffer_printf(&out, "\tAssertion expected the same elements in any order, in arrays of"
+                " \033[1;31m%zu\033[0m and \033[1;31m%zu\033[0m elements.\n", acount, bcount);
+        }
+        if (missing.total > 0)
+        {
+            unit_test_format_differences(&out, "Missing", element, &missing);
+        }
+        if (extra.total > 0)
+        {
+            unit_test_format_differences(&out, "Extra", element, &extra);
+        }
+        event.detail = unit_test_buffer_detach(&out);
+    }
+    unit_test_report(&event);
+}
+
+/*
+*   Checks that an array is in non-decreasing order.
+*/
+static void unit_test_assert_sorted(struct unit_test *test, const char *fname, int lineno, int kind,
+    const void *a, size_t asize, size_t width) {
+    assert(test != NULL);
+    assert(fname != NULL);
+    assert(a != NULL || asize == 0);
+
+    int element = unit_test_kinds[kind].element;
+    size_t count = asize / width;
+    size_t first = 0;
+    size_t unordered = 0;
+    for (size_t i = 1; i < count; i++)
+    {
+        if (unit_test_key(element, a, i - 1) > unit_test_key(element, a, i))
+        {
+            if (unordered++ == 0)
+            {
+                first = i;
+            }
+        }
+    }
+
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = kind, .passed = unordered == 0};
+    if (!event.passed)
+    {
+        struct unit_test_buffer out = {0};
+        unit_test_buffer_printf(&out, "\tAssertion expected the array to be sorted, but element"
+            " \033[1;31m%zu\033[0m (\033[1;31m", first);
+        unit_test_format_value(&out, element, unit_test_key_value(element, unit_test_key(element, a, first)));
+        unit_test_buffer_printf(&out, "\033[0m) is less than the element before it (\033[1;31m");
+        unit_test_format_value(&out, element, unit_test_key_value(element, unit_test_key(element, a, first - 1)));
+        unit_test_buffer_printf(&out, "\033[0m).\n\t\033[1;31m%zu\033[0m of \033[1;31m%zu\033[0m"
+            " elements are less than the element before them.\n", unordered, count);
+        event.detail = unit_test_buffer_detach(&out);
+    }
+    unit_test_report(&event);
+}
+
+/*
+*   Checks that an array of n integers holds each of 0 to n - 1 once,
+*   using one bit per value to remember which have been seen.
+*/
+static void unit_test_assert_permutation(struct unit_test *test, const char *fname, int lineno, int kind,
+    const void *a, size_t asize, size_t width) {
+    assert(test != NULL);
+    assert(fname != NULL);
+    assert(a != NULL || asize == 0);
+
+    size_t count = asize / width;
+    unsigned char *seen = calloc(count / 8 + 1, 1);
+    assert(seen != NULL);
+    size_t out_of_range = 0;
+    size_t repeated = 0;
+    size_t first = count;
+    for (size_t i = 0; i < count; i++)
+    {
+        long value = kind == UNIT_TEST_KIND_INT_PERMUTATION ? ((const int *) a)[i] : ((const long *) a)[i];
+        if (value < 0 || (unsigned long) value >= count)
+        {
+            out_of_range++;
+        }
+        else if (seen[value / 8] & (1 << (value % 8)))
+        {
+            repeated++;
+        }
+        else
+        {
+            seen[value / 8] |= 1 << (value % 8);
+            continue;
+        }
+        if (first == count)
+        {
+            first = i;
+        }
+    }
+    free(seen);
+
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = kind, .passed = first == count};
+    if (!event.passed)
+    {
+        long value = kind == UNIT_TEST_KIND_INT_PERMUTATION ? ((const int *) a)[first] : ((const long *) a)[first];
+        struct unit_test_buffer out = {0};
+        unit_test_buffer_printf(&out, "\tAssertion expected each value from 0 to %zu exactly once, but"
+            " element \033[1;31m%zu\033[0m is \033[1;31m%ld\033[0m.\n", count - 1, first, value);
+        unit_test_buffer_printf(&out, "\t\033[1;31m%zu\033[0m values were out of range,"
+            " \033[1;31m%zu\033[0m were repeated and \033[1;31m%zu\033[0m were missing.\n",
+            out_of_range, repeated, out_of_range + repeated);
+        event.detail = unit_test_buffer_detach(&out);
+    }
+    unit_test_report(&event);
+}
+
+/*
+*   This function determines if two float arrays hold the same elements,
+*   each the same number of times, in any order. It runs in linear time
+*   by radix sorting both arrays, so it is suitable for very large arrays.
+*   On failure the elements missing from b and the extra elements in b
+*   are listed with how many of each there were.
+*   Values are compared by their bits, so 0.0 and -0.0 differ and a NaN
+*   matches an identical NaN.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the expected float array.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the float array being checked.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_float_array_unordered_equals(struct unit_test *test, const char *fname, int lineno,
+    const float *a, size_t asize, const float *b, size_t bsize) {
+    unit_test_assert_multiset(test, fname, lineno, UNIT_TEST_KIND_FLOAT_UNORDERED,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if two integer arrays hold the same elements,
+*   each the same number of times, in any order. It runs in linear time
+*   by radix sorting both arrays, so it is suitable for very large arrays.
+*   On failure the elements missing from b and the extra elements in b
+*   are listed with how many of each there were.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the expected integer array.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the integer array being checked.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_int_array_unordered_equals(struct unit_test *test, const char *fname, int lineno,
+    const int *a, size_t asize, const int *b, size_t bsize) {
+    unit_test_assert_multiset(test, fname, lineno, UNIT_TEST_KIND_INT_UNORDERED,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if two double arrays hold the same elements,
+*   each the same number of times, in any order. It runs in linear time
+*   by radix sorting both arrays, so it is suitable for very large arrays.
+*   On failure the elements missing from b and the extra elements in b
+*   are listed with how many of each there were.
+*   Values are compared by their bits, so 0.0 and -0.0 differ and a NaN
+*   matches an identical NaN.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the expected double array.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the double array being checked.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_double_array_unordered_equals(struct unit_test *test, const char *fname, int lineno,
+    const double *a, size_t asize, const double *b, size_t bsize) {
+    unit_test_assert_multiset(test, fname, lineno, UNIT_TEST_KIND_DOUBLE_UNORDERED,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if two long arrays hold the same elements,
+*   each the same number of times, in any order. It runs in linear time
+*   by radix sorting both arrays, so it is suitable for very large arrays.
+*   On failure the elements missing from b and the extra elements in b
+*   are listed with how many of each there were.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the expected long array.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the long array being checked.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_long_array_unordered_equals(struct unit_test *test, const char *fname, int lineno,
+    const long *a, size_t asize, const long *b, size_t bsize) {
+    unit_test_assert_multiset(test, fname, lineno, UNIT_TEST_KIND_LONG_UNORDERED,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if two char arrays hold the same elements,
+*   each the same number of times, in any order. It runs in linear time
+*   by radix sorting both arrays, so it is suitable for very large arrays.
+*   On failure the elements missing from b and the extra elements in b
+*   are listed with how many of each there were.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the expected char array.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the char array being checked.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_char_array_unordered_equals(struct unit_test *test, const char *fname, int lineno,
+    const char *a, size_t asize, const char *b, size_t bsize) {
+    unit_test_assert_multiset(test, fname, lineno, UNIT_TEST_KIND_CHAR_UNORDERED,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if every element of a float array a also
+*   appears in b, counting repeated elements: an element which appears
+*   three times in a must appear at least three times in b. It runs in
+*   linear time. On failure the elements of a missing from b are listed.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the float array which should be contained in b.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the float array which should contain a.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_float_array_subset(struct unit_test *test, const char *fname, int lineno,
+    const float *a, size_t asize, const float *b, size_t bsize) {
+    unit_test_assert_multiset(test, fname, lineno, UNIT_TEST_KIND_FLOAT_SUBSET,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if every element of a integer array a also
+*   appears in b, counting repeated elements: an element which appears
+*   three times in a must appear at least three times in b. It runs in
+*   linear time. On failure the elements of a missing from b are listed.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the integer array which should be contained in b.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the integer array which should contain a.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_int_array_subset(struct unit_test *test, const char *fname, int lineno,
+    const int *a, size_t asize, const int *b, size_t bsize) {
+    unit_test_assert_multiset(test, fname, lineno, UNIT_TEST_KIND_INT_SUBSET,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if every element of a double array a also
+*   appears in b, counting repeated elements: an element which appears
+*   three times in a must appear at least three times in b. It runs in
+*   linear time. On failure the elements of a missing from b are listed.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the double array which should be contained in b.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the double array which should contain a.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_double_array_subset(struct unit_test *test, const char *fname, int lineno,
+    const double *a, size_t asize, const double *b, size_t bsize) {
+    unit_test_assert_multiset(test, fname, lineno, UNIT_TEST_KIND_DOUBLE_SUBSET,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if every element of a long array a also
+*   appears in b, counting repeated elements: an element which appears
+*   three times in a must appear at least three times in b. It runs in
+*   linear time. On failure the elements of a missing from b are listed.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the long array which should be contained in b.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the long array which should contain a.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_long_array_subset(struct unit_test *test, const char *fname, int lineno,
+    const long *a, size_t asize, const long *b, size_t bsize) {
+    unit_test_assert_multiset(test, fname, lineno, UNIT_TEST_KIND_LONG_SUBSET,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if every element of a char array a also
+*   appears in b, counting repeated elements: an element which appears
+*   three times in a must appear at least three times in b. It runs in
+*   linear time. On failure the elements of a missing from b are listed.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the char array which should be contained in b.
+*   @param asize - the size of array a in bytes.
+*   @param *b - the char array which should contain a.
+*   @param bsize - the size of array b in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_char_array_subset(struct unit_test *test, const char *fname, int lineno,
+    const char *a, size_t asize, const char *b, size_t bsize) {
+    unit_test_assert_multiset(test, fname, lineno, UNIT_TEST_KIND_CHAR_SUBSET,
+        a, asize, b, bsize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if a float array is sorted in non-decreasing
+*   order. On failure it reports the first element which is out of order
+*   and how many were out of order in total.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the float array to check.
+*   @param asize - the size of array a in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_float_array_sorted(struct unit_test *test, const char *fname, int lineno,
+    const float *a, size_t asize) {
+    unit_test_assert_sorted(test, fname, lineno, UNIT_TEST_KIND_FLOAT_SORTED,
+        a, asize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if a integer array is sorted in non-decreasing
+*   order. On failure it reports the first element which is out of order
+*   and how many were out of order in total.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the integer array to check.
+*   @param asize - the size of array a in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_int_array_sorted(struct unit_test *test, const char *fname, int lineno,
+    const int *a, size_t asize) {
+    unit_test_assert_sorted(test, fname, lineno, UNIT_TEST_KIND_INT_SORTED,
+        a, asize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if a double array is sorted in non-decreasing
+*   order. On failure it reports the first element which is out of order
+*   and how many were out of order in total.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the double array to check.
+*   @param asize - the size of array a in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_double_array_sorted(struct unit_test *test, const char *fname, int lineno,
+    const double *a, size_t asize) {
+    unit_test_assert_sorted(test, fname, lineno, UNIT_TEST_KIND_DOUBLE_SORTED,
+        a, asize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if a long array is sorted in non-decreasing
+*   order. On failure it reports the first element which is out of order
+*   and how many were out of order in total.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the long array to check.
+*   @param asize - the size of array a in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_long_array_sorted(struct unit_test *test, const char *fname, int lineno,
+    const long *a, size_t asize) {
+    unit_test_assert_sorted(test, fname, lineno, UNIT_TEST_KIND_LONG_SORTED,
+        a, asize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if a char array is sorted in non-decreasing
+*   order. On failure it reports the first element which is out of order
+*   and how many were out of order in total.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the char array to check.
+*   @param asize - the size of array a in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_char_array_sorted(struct unit_test *test, const char *fname, int lineno,
+    const char *a, size_t asize) {
+    unit_test_assert_sorted(test, fname, lineno, UNIT_TEST_KIND_CHAR_SORTED,
+        a, asize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if a integer array of n elements is a permutation
+*   of 0 to n - 1, that is, holds each of those values exactly once, as
+*   an array of indices produced by a shuffle or a sort should. On failure
+*   it reports how many values were out of range, repeated or missing.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the integer array to check.
+*   @param asize - the size of array a in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_int_array_permutation(struct unit_test *test, const char *fname, int lineno,
+    const int *a, size_t asize) {
+    unit_test_assert_permutation(test, fname, lineno, UNIT_TEST_KIND_INT_PERMUTATION,
+        a, asize, sizeof(a[0]));
+}
+
+/*
+*   This function determines if a long array of n elements is a permutation
+*   of 0 to n - 1, that is, holds each of those values exactly once, as
+*   an array of indices produced by a shuffle or a sort should. On failure
+*   it reports how many values were out of range, repeated or missing.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the long array to check.
+*   @param asize - the size of array a in bytes.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_long_array_permutation(struct unit_test *test, const char *fname, int lineno,
+    const long *a, size_t asize) {
+    unit_test_assert_permutation(test, fname, lineno, UNIT_TEST_KIND_LONG_PERMUTATION,
+        a, asize, sizeof(a[0]));
+}
+
+/*
+*   Returns the index of the first byte at which two buffers of length n
+*   differ, or n if they are equal. Sixteen bytes are compared at a time
+*   where SSE2 is available, and eight at a time otherwise.
+*/
+static size_t unit_test_mismatch(const char *a, const char *b, size_t n) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *) (b + i));
+        unsigned int equal = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+        if (equal != 0xFFFF)
+        {
+            return i + __builtin_ctz(~equal);
+        }
+    }
+#else
+    for (; i + 8 <= n; i += 8)
+    {
+        unsigned long long x;
+        unsigned long long y;
+        memcpy(&x, a + i, 8);
+        memcpy(&y, b + i, 8);
+        if (x != y)
+        {
+            break;
+        }
+    }
+#endif
+    for (; i < n && a[i] == b[i]; i++);
+    return i;
+}
+
+/*
+*   Failed string assertions print a diff of the two strings. It is found
+*   with Myers' O(ND) algorithm, first over lines and then over the
+*   characters of a line which was replaced. The common prefix and suffix
+*   are trimmed before diffing, so large documents with a few changes are
+*   cheap, and the search gives up after UNIT_TEST_DIFF_MAX_EDITS edits.
+*   Only changed hunks are printed, with a few lines of context, up to
+*   UNIT_TEST_DIFF_MAX_LINES lines in total.
+*/
+#define UNIT_TEST_DIFF_MAX_EDITS 1000
+#define UNIT_TEST_DIFF_MAX_WORK 20000000
+#define UNIT_TEST_DIFF_CONTEXT 3
+#define UNIT_TEST_DIFF_MAX_LINES 60
+#define UNIT_TEST_DIFF_MAX_WIDTH 160
+#define UNIT_TEST_DIFF_SHORT 60
+
+enum unit_test_edit {
+    UNIT_TEST_EDIT_KEEP,
+    UNIT_TEST_EDIT_DELETE,
+    UNIT_TEST_EDIT_INSERT
+};
+
+/*
+*   A sequence being diffed: either the characters of a string, or its
+*   lines, in which case each line also has a hash so that most unequal
+*   lines are told apart without comparing them.
+*/
+struct unit_test_sequence {
+    const char *text;
+    size_t count;
+    size_t *starts;
+    size_t *lengths;
+    unsigned long long *hashes;
+};
+
+static int unit_test_sequence_equal(const struct unit_test_sequence *a, size_t i,
+    const struct unit_test_sequence *b, size_t j) {
+    if (a->starts == NULL)
+    {
+        return a->text[i] == b->text[j];
+    }
+    return a->hashes[i] == b->hashes[j] && a->lengths[i] == b->lengths[j]
+        && unit_test_mismatch(a->text + a->starts[i], b->text + b->starts[j], a->lengths[i]) == a->lengths[i];
+}
+
+/*
+*   Splits text into lines. A final line without a newline still counts.
+*/
+static void unit_test_split_lines(struct unit_test_sequence *lines, const char *text, size_t length) {
+    size_t capacity = 16;
+    lines->text = text;
+    lines->count = 0;
+    lines->starts = malloc(capacity * sizeof(size_t));
+    lines->lengths = malloc(capacity * sizeof(size_t));
+    lines->hashes = malloc(capacity * sizeof(unsigned long long));
+    assert(lines->starts != NULL && lines->lengths != NULL && lines->hashes != NULL);
+    for (size_t start = 0; start < length;)
+    {
+        const char *newline = memchr(text + start, '\n', length - start);
+        size_t end = newline == NULL ? length : (size_t) (newline - text);
+        if (lines->count == capacity)
+        {
+            capacity *= 2;
+            lines->starts = realloc(lines->starts, capacity * sizeof(size_t));
+            lines->lengths = realloc(lines->lengths, capacity * sizeof(size_t));
+            lines->hashes = realloc(lines->hashes, capacity * sizeof(unsigned long long));
+            assert(lines->starts != NULL && lines->lengths != NULL && lines->hashes != NULL);
+        }
+        unsigned long long hash = 0xCBF29CE484222325ULL;
+        for (size_t i = start; i < end; i++)
+        {
+            hash = (hash ^ (unsigned char) text[i]) * 0x100000001B3ULL;
+        }
+        lines->starts[lines->count] = start;
+        lines->lengths[lines->count] = end - start;
+        lines->hashes[lines->count] = hash;
+        lines->count++;
+        start = end + 1;
+    }
+}
+
+static void unit_test_free_lines(struct unit_test_sequence *lines) {
+    free(lines->starts);
+    free(lines->lengths);
+    free(lines->hashes);
+}
+
+/*
+*   Finds the shortest edit script turning a[from_a, to_a) into
+*   b[from_b, to_b) with Myers' algorithm, appending it to *edits. The
+*   furthest reaching path of each diagonal is kept for every number of
+*   edits d, which is what lets the path be traced back afterwards. Returns
+*   -1, without touching *edits, if more than UNIT_TEST_DIFF_MAX_EDITS
+*   edits are needed or the search has compared more than
+*   UNIT_TEST_DIFF_MAX_WORK elements.
+*/
+static int unit_test_myers(const struct unit_test_sequence *a, size_t from_a, size_t to_a,
+    const struct unit_test_sequence *b, size_t from_b, size_t to_b, struct unit_test_buffer *edits) {
+    long n = (long) (to_a - from_a);
+    long m = (long) (to_b - from_b);
+    long limit = n + m < UNIT_TEST_DIFF_MAX_EDITS ? n + m : UNIT_TEST_DIFF_MAX_EDITS;
+    long width = 2 * limit + 3;
+    long *v = calloc(width, sizeof(long));
+    long **trace = calloc(limit + 1, sizeof(long *));
+    assert(v != NULL && trace != NULL);
+    long offset = limit + 1;
+    long found = -1;
+    long work = 0;
+
+    for (long d = 0; d <= limit && found < 0 && work < UNIT_TEST_DIFF_MAX_WORK; d++)
+    {
+        for (long k = -d; k <= d; k += 2)
+        {
+            long x;
+            if (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+            {
+                x = v[offset + k + 1];
+            }
+            else
+            {
+                x = v[offset + k - 1] + 1;
+            }
+            long y = x - k;
+            long snake = x;
+            while (x < n && y < m && unit_test_sequence_equal(a, from_a + x, b, from_b + y))
+            {
+                x++;
+                y++;
+            }
+            work += x - snake + 1;
+            v[offset + k] = x;
+            if (x >= n && y >= m)
+            {
+                found = d;
+                break;
+            }
+        }
+        trace[d] = malloc(width * sizeof(long));
+        assert(trace[d] != NULL);
+        memcpy(trace[d], v, width * sizeof(long));
+    }
+
+    if (found >= 0)
+    {
+        //walk back from the end, collecting edits in reverse
+        size_t start = edits->length;
+        long x = n;
+        long y = m;
+        for (long d = found; d >= 0; d--)
+        {
+            long k = x - y;
+            long previous_k;
+            if (d == 0)
+            {
+                previous_k = 0;
+            }
+            else if (k == -d || (k != d && trace[d - 1][offset + k - 1] < trace[d - 1][offset + k + 1]))
+            {
+                previous_k = k + 1;
+            }
+            else
+            {
+                previous_k = k - 1;
+            }
+            long previous_x = d == 0 ? 0 : trace[d - 1][offset + previous_k];
+            long previous_y = previous_x - previous_k;
+            char keep = UNIT_TEST_EDIT_KEEP;
+            for (; x > previous_x && y > previous_y; x--, y--)
+            {
+                unit_test_buffer_append(edits, &keep, 1);
+            }
+            if (d > 0)
+            {
+                char edit = x == previous_x ? UNIT_TEST_EDIT_INSERT : UNIT_TEST_EDIT_DELETE;
+                unit_test_buffer_append(edits, &edit, 1);
+            }
+            x = previous_x;
+            y = previous_y;
+        }
+        for (size_t i = start, j = edits->length - 1; i < j; i++, j--)
+        {
+            char swap = edits->data[i];
+            edits->data[i] = edits->data[j];
+            edits->data[j] = swap;
+        }
+    }
+
+    for (long d = 0; d <= limit && trace[d] != NULL; d++)
+    {
+        free(trace[d]);
+    }
+    free(trace);
+    free(v);
+    return found < 0 ? -1 : 0;
+}
+
+/*
+*   Prints part of a string, escaping control characters and cutting it
+*   short at max characters.
+*/
+static void unit_test_format_text(struct unit_test_buffer *out, const char *text, size_t length, size_t max) {
+    size_t shown = length < max ? length : max;
+    for (size_t i = 0; i < shown; i++)
+    {
+        unsigned char c = (unsigned char) text[i];
+        if (c == '\n')
+        {
+            unit_test_buffer_printf(out, "\\n");
+        }
+        else if (c == '\t')
+        {
+            unit_test_buffer_printf(out, "\\t");
+        }
+        else if (c < 0x20 || c == 0x7F)
+        {
+            unit_test_buffer_printf(out, "\\x%02x", c);
+        }
+        else
+        {
+            unit_test_buffer_append(out, text + i, 1);
+        }
+    }
+    if (shown < length)
+    {
+        unit_test_buffer_printf(out, "\033[0;33m...(%zu more)\033[0m", length - shown);
+    }
+}
+
+/*
+*   Prints a character level diff of two lines: the common prefix and
+*   suffix are trimmed to a little context, and the middle is shown as
+*   [-removed-]{+added+} runs.
+*/
+static void unit_test_format_line_diff(struct unit_test_buffer *out, const char *a, size_t alength,
+    const char *b, size_t blength) {
+    size_t shortest = alength < blength ? alength : blength;
+    size_t prefix = unit_test_mismatch(a, b, shortest);
+    size_t suffix = 0;
+    while (suffix < shortest - prefix && a[alength - suffix - 1] == b[blength - suffix - 1])
+    {
+        suffix++;
+    }
+    struct unit_test_sequence as = {.text = a};
+    struct unit_test_sequence bs = {.text = b};
+    struct unit_test_buffer edits = {0};
+    int found = unit_test_myers(&as, prefix, alength - suffix, &bs, prefix, blength - suffix, &edits);
+
+    size_t context = prefix < 30 ? prefix : 30;
+    unit_test_buffer_printf(out, "\t  %s", context < prefix ? "..." : "");
+    unit_test_format_text(out, a + prefix - context, context, context);
+    if (found < 0)
+    {
+        unit_test_buffer_printf(out, "\033[1;31m[-");
+        unit_test_format_text(out, a + prefix, alength - suffix - prefix, UNIT_TEST_DIFF_MAX_WIDTH);
+        unit_test_buffer_printf(out, "-]\033[1;32m{+");
+        unit_test_format_text(out, b + prefix, blength - suffix - prefix, UNIT_TEST_DIFF_MAX_WIDTH);
+        unit_test_buffer_printf(out, "+}\033[0m");
+    }
+    else
+    {
+        size_t x = prefix;
+        size_t y = prefix;
+        size_t shown = 0;
+        for (size_t i = 0; i < edits.length && shown < UNIT_TEST_DIFF_MAX_WIDTH;)
+        {
+            char edit = edits.data[i];
+            size_t run = 0;
+            for (; i < edits.length && edits.data[i] == edit; i++, run++);
+            size_t room = UNIT_TEST_DIFF_MAX_WIDTH - shown;
+            if (edit == UNIT_TEST_EDIT_KEEP)
+            {
+                unit_test_format_text(out, a + x, run, room);
+                x += run;
+                y += run;
+            }
+            else if (edit == UNIT_TEST_EDIT_DELETE)
+            {
+                unit_test_buffer_printf(out, "\033[1;31m[-");
+                unit_test_format_text(out, a + x, run, room);
+                unit_test_buffer_printf(out, "-]\033[0m");
+                x += run;
+            }
+            else
+            {
+                unit_test_buffer_printf(out, "\033[1;32m{+");
+                unit_test_format_text(out, b + y, run, room);
+                unit_test_buffer_printf(out, "+}\033[0m");
+                y += run;
+            }
+            shown += run;
+        }
+    }
+    context = suffix < 30 ? suffix : 30;
+    unit_test_format_text(out, a + alength - suffix, context, context);
+    unit_test_buffer_printf(out, "%s\n", context < suffix ? "..." : "");
+    free(edits.data);
+}
+
+/*
+*   Prints one line of a line level diff.
+*/
+static void unit_test_format_diff_line(struct unit_test_buffer *out, const struct unit_test_sequence *lines,
+    size_t i, char sign, const char *colour) {
+    unit_test_buffer_printf(out, "\t%s%c %5zu | ", colour, sign, i + 1);
+    unit_test_format_text(out, lines->text + lines->starts[i], lines->lengths[i], UNIT_TEST_DIFF_MAX_WIDTH);
+    unit_test_buffer_printf(out, "\033[0m\n");
+}
+
+/*
+*   Prints a bounded diff of two strings. Single lines are diffed by
+*   character. Otherwise lines are diffed and only the changed hunks are
+*   printed; a hunk which replaces one line with another also gets a
+*   character level diff.
+*/
+static void unit_test_format_diff(struct unit_test_buffer *out, const char *a, size_t alength,
+    const char *b, size_t blength) {
+    if (memchr(a, '\n', alength) == NULL && memchr(b, '\n', blength) == NULL)
+    {
+        unit_test_format_line_diff(out, a, alength, b, blength);
+        return;
+    }
+
+    struct unit_test_sequence as;
+    struct unit_test_sequence bs;
+    unit_test_split_lines(&as, a, alength);
+    unit_test_split_lines(&bs, b, blength);
+    size_t prefix = 0;
+    for (; prefix < as.count && prefix < bs.count && unit_test_sequence_equal(&as, prefix, &bs, prefix); prefix++);
+    size_t suffix = 0;
+    for (; suffix < as.count - prefix && suffix < bs.count - prefix
+        && unit_test_sequence_equal(&as, as.count - suffix - 1, &bs, bs.count - suffix - 1); suffix++);
+
+    struct unit_test_buffer edits = {0};
+    char keep = UNIT_TEST_EDIT_KEEP;
+    for (size_t i = 0; i < prefix; i++)
+    {
+        unit_test_buffer_append(&edits, &keep, 1);
+    }
+    if (unit_test_myers(&as, prefix, as.count - suffix, &bs, prefix, bs.count - suffix, &edits) != 0)
+    {
+        unit_test_buffer_printf(out, "\tThe strings differ in more than %d lines, starting at line %zu;"
+            " showing only the first changed lines.\n", UNIT_TEST_DIFF_MAX_EDITS, prefix + 1);
+        size_t shown = 0;
+        for (size_t i = prefix; i < as.count - suffix && shown < UNIT_TEST_DIFF_MAX_LINES / 2; i++, shown++)
+        {
+            unit_test_format_diff_line(out, &as, i, '-', "\033[1;31m");
+        }
+        shown = 0;
+        for (size_t i = prefix; i < bs.count - suffix && shown < UNIT_TEST_DIFF_MAX_LINES / 2; i++, shown++)
+        {
+            unit_test_format_diff_line(out, &bs, i, '+', "\033[1;32m");
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < suffix; i++)
+        {
+            unit_test_buffer_append(&edits, &keep, 1);
+        }
+        //x and y are the line numbers in a and b that edit e applies to
+        size_t printed = 0;
+        size_t x = 0;
+        size_t y = 0;
+        size_t e = 0;
+        while (e < edits.length && printed < UNIT_TEST_DIFF_MAX_LINES)
+        {
+            if (edits.data[e] == UNIT_TEST_EDIT_KEEP)
+            {
+                e++;
+                x++;
+                y++;
+                continue;
+            }
+            //a hunk starts a few lines before this change and runs until
+            //more than twice the context of unchanged lines follow it
+            size_t end = e;
+            for (size_t kept = 0; end < edits.length; end++)
+            {
+                kept = edits.data[end] == UNIT_TEST_EDIT_KEEP ? kept + 1 : 0;
+                if (kept > 2 * UNIT_TEST_DIFF_CONTEXT)
+                {
+                    end -= UNIT_TEST_DIFF_CONTEXT;
+                    break;
+                }
+            }
+            size_t before = x < UNIT_TEST_DIFF_CONTEXT ? x : UNIT_TEST_DIFF_CONTEXT;
+            before = y < before ? y : before;
+            unit_test_buffer_printf(out, "\t\033[1;36m@@ line %zu of the first string,"
+                " line %zu of the second @@\033[0m\n", x - before + 1, y - before + 1);
+            for (size_t i = before; i > 0; i--)
+            {
+                unit_test_format_diff_line(out, &as, x - i, ' ', "");
+            }
+            printed += before;
+
+            while (e < end && printed < UNIT_TEST_DIFF_MAX_LINES)
+            {
+                size_t deleted = 0;
+                size_t inserted = 0;
+                for (; e + deleted < end && edits.data[e + deleted] == UNIT_TEST_EDIT_DELETE; deleted++);
+                for (; e + deleted + inserted < end
+                    && edits.data[e + deleted + inserted] == UNIT_TEST_EDIT_INSERT; inserted++);
+                if (deleted == 0 && inserted == 0)
+                {
+                    unit_test_format_diff_line(out, &as, x, ' ', "");
+                    e++;
+                    x++;
+                    y++;
+                    printed++;
+                    continue;
+                }
+                for (size_t i = 0; i < deleted; i++)
+                {
+                    unit_test_format_diff_line(out, &as, x + i, '-', "\033[1;31m");
+                }
+                for (size_t i = 0; i < inserted; i++)
+                {
+                    unit_test_format_diff_line(out, &bs, y + i, '+', "\033[1;32m");
+                }
+                if (deleted == 1 && inserted == 1)
+                {
+                    unit_test_format_line_diff(out, a + as.starts[x], as.lengths[x], b + bs.starts[y], bs.lengths[y]);
+                }
+                printed += deleted + inserted;
+                e += deleted + inserted;
+                x += deleted;
+                y += inserted;
+            }
+        }
+        if (e < edits.length)
+        {
+            size_t remaining = 0;
+            for (; e < edits.length; e++)
+            {
+                remaining += edits.data[e] != UNIT_TEST_EDIT_KEEP;
+            }
+            if (remaining > 0)
+            {
+                unit_test_buffer_printf(out, "\t\033[0;33m...and %zu more changed lines.\033[0m\n", remaining);
+            }
+        }
+    }
+    free(edits.data);
+    unit_test_free_lines(&as);
+    unit_test_free_lines(&bs);
+}
+
+/*
+*   Prints a string operand for an assertion, quoted and cut short if it
+*   is long.
+*/
+static void unit_test_format_string(struct unit_test_buffer *out, const char *text) {
+    if (text == NULL)
+    {
+        unit_test_buffer_printf(out, "\033[1;31m(null)\033[0m");
+        return;
+    }
+    unit_test_buffer_printf(out, "\033[1;31m\"");
+    unit_test_format_text(out, text, strlen(text), UNIT_TEST_DIFF_MAX_WIDTH);
+    unit_test_buffer_printf(out, "\"\033[0m");
+}
+
+/*
+*   This function takes two strings and determines if they are equal. The
+*   strings are compared sixteen bytes at a time. On failure, short strings
+*   are printed in full along with where they first differ, and longer
+*   ones are printed as a diff of the changed lines, with a character
+*   level diff of lines which were changed in place.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *a - the expected string.
+*   @param *b - the string being checked.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_string_equals(struct unit_test *test, const char *fname, int lineno,
+    const char *a, const char *b) {
+    assert(test != NULL);
+    assert(fname != NULL);
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_STRING_EQUALS, .passed = 0};
+    size_t alength = a == NULL ? 0 : strlen(a);
+    size_t blength = b == NULL ? 0 : strlen(b);
+    size_t first = 0;
+    if (a != NULL && b != NULL)
+    {
+        first = unit_test_mismatch(a, b, alength < blength ? alength : blength);
+        event.passed = alength == blength && first == alength;
+    }
+
+    if (!event.passed)
+    {
+        struct unit_test_buffer out = {0};
+        if (a == NULL || b == NULL || (alength <= UNIT_TEST_DIFF_SHORT && blength <= UNIT_TEST_DIFF_SHORT))
+        {
+            unit_test_buffer_printf(&out, "\tAssertion expected ");
+            unit_test_format_string(&out, a);
+            unit_test_buffer_printf(&out, " but got ");
+            unit_test_format_string(&out, b);
+            unit_test_buffer_printf(&out, ".\n");
+            if (a != NULL && b != NULL)
+            {
+                unit_test_buffer_printf(&out, "\tThe strings first differ at index \033[1;31m%zu\033[0m.\n", first);
+            }
+        }
+        else
+        {
+            unit_test_buffer_printf(&out, "\tAssertion expected equal strings, but strings of \033[1;31m%zu\033[0m"
+                " and \033[1;31m%zu\033[0m bytes first differ at index \033[1;31m%zu\033[0m:\n",
+                alength, blength, first);
+            unit_test_format_diff(&out, a, alength, b, blength);
+        }
+        event.detail = unit_test_buffer_detach(&out);
+    }
+    unit_test_report(&event);
+}
+
+/*
+*   This function determines if a string contains another string.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *haystack - the string being searched.
+*   @param *needle - the string which should appear in haystack.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_string_contains(struct unit_test *test, const char *fname, int lineno,
+    const char *haystack, const char *needle) {
+    assert(test != NULL);
+    assert(fname != NULL);
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_STRING_CONTAINS, .passed = 0};
+    event.passed = haystack != NULL && needle != NULL && strstr(haystack, needle) != NULL;
+    if (!event.passed)
+    {
+        struct unit_test_buffer out = {0};
+        unit_test_buffer_printf(&out, "\tAssertion expected ");
+        unit_test_format_string(&out, haystack);
+        if (haystack != NULL)
+        {
+            unit_test_buffer_printf(&out, " (\033[1;31m%zu\033[0m bytes)", strlen(haystack));
+        }
+        unit_test_buffer_printf(&out, "\n\tto contain ");
+        unit_test_format_string(&out, needle);
+        unit_test_buffer_printf(&out, ".\n");
+        event.detail = unit_test_buffer_detach(&out);
+    }
+    unit_test_report(&event);
 }
 
 /*
-*   This function prints a total summary of all unit test which have executed.
-*   It also reports to the user whether the program is passing as a whole, and 
-*   must be called by the user.
+*   This function determines if a string starts with another string. Only
+*   as much of the string as the prefix's length is read.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *prefix - the expected start of the string.
+*   @param *b - the string being checked.
 *
 *   @author Brennan Hurst
-*   @version 10/10/2021
+*   @version 10/18/2026
 */
-void unit_test_print_total_summary() {
-    
-    printf("\033[1;37m================== Total Summary ==================\033[0m\n");
-    printf("\033[4mTest Name|                                   |Score\033[0m\n");
-    int total_passing = 0;
-    int total_failing = 0;
-    for (int i = 0; i < test_count; i++)
+void unit_test_assert_string_prefix(struct unit_test *test, const char *fname, int lineno,
+    const char *prefix, const char *b) {
+    assert(test != NULL);
+    assert(fname != NULL);
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_STRING_PREFIX, .passed = 0};
+    size_t length = prefix == NULL ? 0 : strlen(prefix);
+    size_t blength = 0;
+    size_t first = 0;
+    if (prefix != NULL && b != NULL)
     {
-        int size = 0;
-        for(; tests[i]->name[size] != '\0'; size++);
-        printf("%s: %*d/%d\n", tests[i]->name, 47 - size, tests[i]->num_passed,
-            tests[i]->num_failed + tests[i]->num_passed);
-        total_passing += tests[i]->num_passed;
-        total_failing += tests[i]->num_failed;
+        blength = strnlen(b, length);
+        first = unit_test_mismatch(prefix, b, blength);
+        event.passed = first == length;
     }
-    printf("---------------------------------------------------\n");
-    printf("# of Assertions Passing: \033[1;32m%*d\033[0m\n", 26, total_passing);
-    printf("# of Assertions Failing: \033[1;31m%*d\033[0m\n", 26, total_failing);
-    printf("Overall Status: ");
-
-    if (total_failing == 0)
+    if (!event.passed)
     {
-        printf("\033[1;32m%*s\033[0m\n", 35, "PASSING");
+        struct unit_test_buffer out = {0};
+        unit_test_buffer_printf(&out, "\tAssertion expected a string starting with ");
+        unit_test_format_string(&out, prefix);
+        unit_test_buffer_printf(&out, " but got ");
+        unit_test_format_string(&out, b);
+        unit_test_buffer_printf(&out, ".\n");
+        if (prefix != NULL && b != NULL)
+        {
+            unit_test_buffer_printf(&out, "\tThey first differ at index \033[1;31m%zu\033[0m:\n", first);
+            unit_test_format_line_diff(&out, prefix, length, b, blength);
+        }
+        event.detail = unit_test_buffer_detach(&out);
     }
-    else
+    unit_test_report(&event);
+}
+
+/*
+*   Mocks record their calls into a ring of fixed size allocated up front,
+*   so recording a call never allocates: it claims a slot with one atomic
+*   add and copies the arguments in. Only the most recent calls stay in
+*   the ring, but every call is counted. The first call to each mock also
+*   takes a number from one global sequence, which is what ordering
+*   assertions compare; later calls leave it alone, since a counter shared
+*   by every mock would be contended in hot loops.
+*/
+static unsigned long long unit_test_mock_sequence = 0;
+
+/*
+*   This function creates a mock: a stand-in for a function which records
+*   how it was called. The code under test reaches the mock through a
+*   function pointer it is given, or through a wrapper made with the
+*   linker's --wrap option, and the stand-in calls unit_test_mock_record.
+*
+*   @param *name - name of the mock, printed by failed assertions.
+*   @param capacity - the number of most recent calls to keep the
+*       arguments of. It is rounded up to a power of two.
+*
+*   @return a pointer to the new mock.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_mock *unit_test_mock_init(const char *name, int capacity) {
+    assert(name != NULL);
+    assert(capacity > 0);
+    struct unit_test_mock *mock = calloc(1, sizeof(struct unit_test_mock));
+    assert(mock != NULL);
+    mock->name = name;
+    mock->capacity = 1;
+    while (mock->capacity < capacity)
     {
-        printf("\033[1;31m%*s\033[0m\n", 28, "FAILING");
+        mock->capacity *= 2;
     }
-    printf("===================================================\n");
-
+    mock->ring = calloc(mock->capacity, sizeof(struct unit_test_mock_call));
+    assert(mock->ring != NULL);
+    return mock;
 }
 
 /*
-*   This function starts a unit test and is responsible for executing
-*   and printing out the unit test.
-*   
-*   @param *test - unit_test structure representing the test you will be
-*       running.
-*   @param void (*start)() - function pointer representing the start funciton 
-*       for the unit test.
-*   @param void (*print)() - function pointer representing the print 
-*       function for the unit test. If NULL, the print function defaults to 
-*       the built-in print funciton.
+*   This function frees a mock made by unit_test_mock_init.
+*
+*   @param *mock - the mock to free.
 *
 *   @author Brennan Hurst
-*   @version 10/07/2021
+*   @version 10/18/2026
 */
-void unit_test_start(struct unit_test *test, void (*start)(), void (*print)()) {
-    assert(test != NULL);
-    assert(start != NULL);
-    unit_test_print_header(test);
-    start(test);
-    
-    if (print == NULL) {
-        unit_test_print_summary(test);
-    }
-    else
+void unit_test_mock_free(struct unit_test_mock *mock) {
+    if (mock != NULL)
     {
-        print(test);
+        free(mock->ring);
+        free(mock);
     }
-    //free(test);
 }
 
 /*
-*   This function prints the header for the unit test section. It is used as 
-*   a helper function and may be useful for inline printing. 
+*   This function forgets every call a mock has recorded. The value it
+*   returns is kept.
 *
-*   @param *test - the unit_test you wish to print out.
+*   @param *mock - the mock to reset.
 *
 *   @author Brennan Hurst
-*   @version 10/09/2021
+*   @version 10/18/2026
 */
-void unit_test_print_header(struct unit_test *test) {
-    assert(test != NULL);
-    printf("======================================== %s "
-        "Results ========================================\n\n", 
-        test->name);
+void unit_test_mock_reset(struct unit_test_mock *mock) {
+    assert(mock != NULL);
+    __atomic_store_n(&mock->calls, 0, __ATOMIC_RELAXED);
+    mock->first_sequence = 0;
+    memset(mock->ring, 0, mock->capacity * sizeof(struct unit_test_mock_call));
 }
 
 /*
-*   This function takes a unit_test struct and prints out the results to 
-*   standard output.
+*   This function sets the value unit_test_mock_record returns, for mocks
+*   of functions which return something.
 *
-*   @param *test - the unit_test you wish to print out. 
+*   @param *mock - the mock.
+*   @param value - the value to return from every call.
 *
 *   @author Brennan Hurst
-*   @version 10/07/2021
+*   @version 10/18/2026
 */
-void unit_test_print_summary(struct unit_test *test) {
-    assert(test != NULL);    
-    int size = 0;
-    for (; test->name[size + 1] != '\0'; size++);
-    printf("\n\033[1;37m========== %s Summary ==========\033[0m\n", test->name);
+void unit_test_mock_returns(struct unit_test_mock *mock, long long value) {
+    assert(mock != NULL);
+    mock->result = value;
+}
 
-    printf("\033[1;37mTotal Tests:%*d\033[0m\n", 
-        19 + size, test->num_passed + test->num_failed);
-    
-    printf("\033[1;37mTests Passed: \033[1;32m%*d\033[0m\n", 
-        17 + size, test->num_passed);
-    
-    printf("\033[1;37mTests Failed: \033[1;31m%*d\033[0m\n", 
-        17 + size, test->num_failed);
-    
-    float percentPassing = 100;
-    
-    if (test->num_failed > 0)
+/*
+*   This function records a call to a mock. It is called by the stand-in
+*   function with the arguments it was given, cast to long long; unused
+*   arguments should be 0. It can be called from any thread, and is cheap
+*   enough to leave in hot loops: it makes one atomic add and a few
+*   stores, and never allocates or takes a lock.
+*
+*   @param *mock - the mock being called.
+*   @param a - the first argument.
+*   @param b - the second argument.
+*   @param c - the third argument.
+*   @param d - the fourth argument.
+*
+*   @return the value set with unit_test_mock_returns, or 0.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+long long unit_test_mock_record(struct unit_test_mock *mock, long long a, long long b, long long c, long long d) {
+    long long call = __atomic_fetch_add(&mock->calls, 1, __ATOMIC_RELAXED);
+    struct unit_test_mock_call *slot = &mock->ring[call & (mock->capacity - 1)];
+    slot->args[0] = a;
+    slot->args[1] = b;
+    slot->args[2] = c;
+    slot->args[3] = d;
+    if (call == 0)
     {
-        percentPassing = ((float) (test->num_passed) / 
-            (float) (test->num_failed + test->num_passed)) * 100;
+        mock->first_sequence = __atomic_add_fetch(&unit_test_mock_sequence, 1, __ATOMIC_RELAXED);
     }
+    return mock->result;
+}
 
-    if (percentPassing >= 90) {
-        printf("\033[1;37mPercent Passing: \033[1;32m%*.2f%%\033[0m\n", 
-        13 + size, percentPassing);
-    }
-    else if (percentPassing > 50) {
-        printf("\033[1;37mPercent Passing: \033[1;33m%*.2f%%\033[0m\n", 
-        13 + size, percentPassing);
-    }
-    else {
-        printf("\033[1;37mPercent Passing: \033[1;31m%*.2f%%\033[0m\n", 
-        13 + size, percentPassing);
-    }
-    
-    printf("\033[1;37m");
-    
-    for (int i = 0; i < 31 + size; i++)
+/*
+*   This function tests if a mock was called at least min and at most max
+*   times.
+*
+*   @param *test - the unit_test you wish to use to track the results.
+*   @param *fname - file name. Use the macro __FILE_ for this field.
+*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *mock - the mock.
+*   @param min - the fewest calls allowed.
+*   @param max - the most calls allowed.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_assert_mock_calls(struct unit_test *test, const char *fname, int lineno,
+    struct unit_test_mock *mock, long long min, long long max) {
+    assert(test != NULL);
+    assert(fname != NULL);
+    assert(mock != NULL);
+    long long calls = __atomic_load_n(&mock->calls, __ATOMIC_RELAXED);
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_MOCK_CALLS, .passed = 0};
+    event.passed = calls >= min && calls <= max;
+    if (!event.passed)
     {
-        printf("=");
+        struct unit_test_buffer out = {0};
+        if (min == max)
+        {
+            unit_test_buffer_printf(&out, "\tAssertion expected \033[1;31m%s\033[0m to be called"
+                " \033[1;31m%lld\033[0m times", mock->name, min);
+        }
+        else
+        {
+            unit_test_buffer_printf(&out, "\tAssertion expected \033[1;31m%s\033[0m to be called"
+                " between \033[1;31m%lld\033[0m and \033[1;31m%lld\033[0m times", mock->name, min, max);
+        }
+        unit_test_buffer_printf(&out, " but it was called \033[1;31m%lld\033[0m times.\n", calls);
+        event.detail = unit_test_buffer_detach(&out);
     }
-    
-    printf("\033[0m\n\n");
+    unit_test_report(&event);
 }
 
 /*
-*   This function takes two pointers and tests if they point to the same memory
-*   address. 
+*   This function tests the arguments of one call to a mock. Only the
+*   calls still held in the mock's ring can be checked.
 *
-*   @param *test - the unit_test you wish to use to track the results. 
-*   @param *a - the first pointer you are comparing
-*   @param *b - the second pointer you are comparing
+*   @param *test - the unit_test you wish to use to track the results.
 *   @param *fname - file name. Use the macro __FILE_ for this field.
 *   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *mock - the mock.
+*   @param call - which call to check, counting from 0 for the first, or
+*       from -1 for the most recent backwards.
+*   @param *args - the arguments the call is expected to have had.
+*   @param count - the number of arguments to compare, at most 4.
 *
 *   @author Brennan Hurst
-*   @version 10/07/2021
+*   @version 10/18/2026
 */
-void unit_test_assert_same_address(struct unit_test *test, const char *fname, int lineno, void *a, void *b) {
+void unit_test_assert_mock_called_with(struct unit_test *test, const char *fname, int lineno,
+    struct unit_test_mock *mock, long long call, const long long *args, int count) {
     assert(test != NULL);
     assert(fname != NULL);
-    assert(a != NULL);
-    assert(b != NULL);
-    printf("%d - \033[1;37m%s: \033[1;36mAssert Same Address\033[0m on addresses"
-             " \033[0;36m0x%p\033[0m and \033[0;36m0x%p\033[0m:", 
-             test->num_passed + test->num_failed, test->name, a, b);
-    if (a == b) {
-        test->num_passed++;
-        printf(" \033[1;32mPASSED\n\033[0m");
+    assert(mock != NULL);
+    assert(count >= 0 && count <= UNIT_TEST_MOCK_ARGS && (args != NULL || count == 0));
+    long long calls = __atomic_load_n(&mock->calls, __ATOMIC_RELAXED);
+    long long index = call < 0 ? calls + call : call;
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_MOCK_ARGS, .passed = 0};
+    struct unit_test_buffer out = {0};
+    if (index < 0 || index >= calls)
+    {
+        unit_test_buffer_printf(&out, "\tAssertion expected call \033[1;31m%lld\033[0m to \033[1;31m%s\033[0m"
+            " but it was only called \033[1;31m%lld\033[0m times.\n", call, mock->name, calls);
+    }
+    else if (index < calls - mock->capacity)
+    {
+        unit_test_buffer_printf(&out, "\tCall \033[1;31m%lld\033[0m to \033[1;31m%s\033[0m is no longer"
+            " recorded; only the last \033[1;31m%d\033[0m calls are kept.\n", index, mock->name, mock->capacity);
     }
     else
     {
-        test->num_failed++;
-        printf(" \033[1;31mFAILED\n\033[0m");
-        printf("\n\t\033[1;37mExpanded Information:\n");
-        printf("\t\033[1;36mAssert Same Address \033[1;31mFailed\033[0m"
-            " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-        printf("\tAssertion expected \033[1;31m0x%p\033[0m but got \033[1;31m0x%p\033[0m.\n", a, b);
-        printf("\n\033[0m");
+        const long long *got = mock->ring[index & (mock->capacity - 1)].args;
+        int first = 0;
+        while (first < count && got[first] == args[first])
+        {
+            first++;
+        }
+        event.passed = first == count;
+        if (!event.passed)
+        {
+            unit_test_buffer_printf(&out, "\tAssertion expected call \033[1;31m%lld\033[0m to \033[1;31m%s\033[0m"
+                " to have argument \033[1;31m%d\033[0m equal to \033[1;31m%lld\033[0m but it was"
+                " \033[1;31m%lld\033[0m.\n", index, mock->name, first, args[first], got[first]);
+        }
     }
-    
+    event.detail = event.passed ? NULL : unit_test_buffer_detach(&out);
+    free(out.data);
+    unit_test_report(&event);
 }
 
 /*
-*   This function takes two floats and determines if they both contain the same
-*   value.
+*   This function tests that a mock was first called before another mock
+*   was first called. Both must have been called.
 *
-*   @param *test - the unit_test you wish to use to track the results. 
-*   @param a - the first float you are comparing
-*   @param b - the second float you are comparing
+*   @param *test - the unit_test you wish to use to track the results.
 *   @param *fname - file name. Use the macro __FILE_ for this field.
 *   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param *first - the mock expected to be called first.
+*   @param *second - the mock expected to be called after it.
 *
 *   @author Brennan Hurst
-*   @version 10/07/2021
+*   @version 10/18/2026
 */
-void unit_test_assert_float_equals(struct unit_test *test, const char *fname, int lineno, float a, float b) {
+void unit_test_assert_mock_order(struct unit_test *test, const char *fname, int lineno,
+    struct unit_test_mock *first, struct unit_test_mock *second) {
     assert(test != NULL);
     assert(fname != NULL);
-    printf("%d - \033[1;37m%s: \033[1;36mAssert Float Equals\033[0m between floats "
-             "\033[0;36m%ff\033[0m and \033[0;36m%ff\033[0m:", 
-             test->num_passed + test->num_failed, test->name, a, b);
-    if (a == b) {
-        test->num_passed++;
-        printf(" \033[1;32mPASSED\n\033[0m");
+    assert(first != NULL && second != NULL);
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_MOCK_ORDER, .passed = 0};
+    event.passed = first->first_sequence != 0 && second->first_sequence != 0
+        && first->first_sequence < second->first_sequence;
+    if (!event.passed)
+    {
+        struct unit_test_buffer out = {0};
+        if (first->first_sequence == 0 || second->first_sequence == 0)
+        {
+            unit_test_buffer_printf(&out, "\tAssertion expected \033[1;31m%s\033[0m to be called before"
+                " \033[1;31m%s\033[0m but \033[1;31m%s\033[0m was never called.\n", first->name, second->name,
+                first->first_sequence == 0 ? first->name : second->name);
+        }
+        else
+        {
+            unit_test_buffer_printf(&out, "\tAssertion expected \033[1;31m%s\033[0m to be called before"
+                " \033[1;31m%s\033[0m but it was first called after it.\n", first->name, second->name);
+        }
+        event.detail = unit_test_buffer_detach(&out);
+    }
+    unit_test_report(&event);
+}
+
+/*
+*   Death tests run their body in a child forked from a zygote: a process
+*   forked once from the test program, which then only waits for requests.
+*   A request carries a function pointer, which is valid in the zygote
+*   because it is a copy of the same image, and a copy of the argument's
+*   bytes. The zygote forks a child to run it, collects the child's
+*   standard error and exit status, and sends them back. Forking the small,
+*   single threaded zygote is much cheaper than forking the test program
+*   once it has grown, and the child never inherits the test program's
+*   threads, locks or buffered output.
+*/
+#define UNIT_TEST_DEATH_TIMEOUT 10
+#define UNIT_TEST_DEATH_OUTPUT 65536
+
+struct unit_test_death_request {
+    void (*body)(void *arg);
+    size_t arg_size;
+};
+
+struct unit_test_death_result {
+    int status;
+    int timed_out;
+    size_t output_length;
+};
+
+static pthread_mutex_t unit_test_zygote_lock = PTHREAD_MUTEX_INITIALIZER;
+static pid_t unit_test_zygote_pid = 0;
+static pid_t unit_test_zygote_parent = 0;
+static int unit_test_zygote_socket = -1;
+static int unit_test_zygote_hooked = 0;
+
+/*
+*   Reads or writes exactly size bytes on a socket, returning -1 if the
+*   other end has gone away.
+*/
+static int unit_test_socket_read(int fd, void *data, size_t size) {
+    char *at = data;
+    while (size > 0)
+    {
+        ssize_t got = read(fd, at, size);
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (got <= 0)
+        {
+            return -1;
+        }
+        at += got;
+        size -= got;
+    }
+    return 0;
+}
+
+static int unit_test_socket_write(int fd, const void *data, size_t size) {
+    const char *at = data;
+    while (size > 0)
+    {
+        ssize_t sent = send(fd, at, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (sent <= 0)
+        {
+            return -1;
+        }
+        at += sent;
+        size -= sent;
+    }
+    return 0;
+}
+
+/*
+*   Runs a death test body in a child of the zygote, with standard error
+*   sent to the zygote and default handling of fatal signals.
+*/
+static void unit_test_zygote_child(struct unit_test_death_request *request, void *arg, int output) {
+    dup2(output, STDERR_FILENO);
+    for (size_t i = 0; i < sizeof(unit_test_async_signals) / sizeof(unit_test_async_signals[0]); i++)
+    {
+        signal(unit_test_async_signals[i], SIG_DFL);
+    }
+    request->body(arg);
+    fflush(NULL);
+    _exit(0);
+}
+
+/*
+*   Runs a single request in a new child, collecting at most
+*   UNIT_TEST_DEATH_OUTPUT bytes of its standard error. A child which is
+*   still running after UNIT_TEST_DEATH_TIMEOUT seconds is killed.
+*/
+static void unit_test_zygote_run(int socket, struct unit_test_death_request *request, void *arg) {
+    struct unit_test_death_result result = {0};
+    struct unit_test_buffer output = {0};
+    int pipes[2];
+    if (pipe2(pipes, O_CLOEXEC) != 0)
+    {
+        _exit(1);
+    }
+    pid_t child = fork();
+    if (child < 0)
+    {
+        _exit(1);
+    }
+    if (child == 0)
+    {
+        close(socket);
+        close(pipes[0]);
+        unit_test_zygote_child(request, arg, pipes[1]);
+    }
+    close(pipes[1]);
+
+    double deadline = unit_test_now() + UNIT_TEST_DEATH_TIMEOUT;
+    char chunk[4096];
+    for (;;)
+    {
+        int remaining = (int) ((deadline - unit_test_now()) * 1000);
+        if (remaining <= 0)
+        {
+            kill(child, SIGKILL);
+            result.timed_out = 1;
+            break;
+        }
+        struct pollfd poller = {pipes[0], POLLIN, 0};
+        if (poll(&poller, 1, remaining) <= 0)
+        {
+            continue;
+        }
+        ssize_t got = read(pipes[0], chunk, sizeof(chunk));
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (got <= 0)
+        {
+            break;
+        }
+        if (output.length < UNIT_TEST_DEATH_OUTPUT)
+        {
+            size_t keep = UNIT_TEST_DEATH_OUTPUT - output.length;
+            unit_test_buffer_append(&output, chunk, (size_t) got < keep ? (size_t) got : keep);
+        }
+    }
+    close(pipes[0]);
+    //a child can close standard error and carry on running, so the deadline still applies
+    for (;;)
+    {
+        pid_t reaped = waitpid(child, &result.status, result.timed_out ? 0 : WNOHANG);
+        if (reaped == child || (reaped < 0 && errno != EINTR))
+        {
+            break;
+        }
+        if (reaped == 0 && unit_test_now() >= deadline)
+        {
+            kill(child, SIGKILL);
+            result.timed_out = 1;
+        }
+        else if (reaped == 0)
+        {
+            struct timespec pause = {0, 1000000};
+            nanosleep(&pause, NULL);
+        }
+    }
+
+    result.output_length = output.length;
+    if (unit_test_socket_write(socket, &result, sizeof(result)) != 0
+        || unit_test_socket_write(socket, output.data, output.length) != 0)
+    {
+        _exit(1);
+    }
+    free(output.data);
+}
+
+/*
+*   The zygote's main loop. It exits once the test program closes its end
+*   of the socket. Core dumps are turned off, since most death tests crash
+*   on purpose.
+*/
+static void unit_test_zygote_serve(int socket) {
+    struct rlimit limit = {0, 0};
+    setrlimit(RLIMIT_CORE, &limit);
+    struct unit_test_death_request request;
+    while (unit_test_socket_read(socket, &request, sizeof(request)) == 0)
+    {
+        void *arg = NULL;
+        if (request.arg_size > 0)
+        {
+            arg = malloc(request.arg_size);
+            if (arg == NULL || unit_test_socket_read(socket, arg, request.arg_size) != 0)
+            {
+                break;
+            }
+        }
+        unit_test_zygote_run(socket, &request, arg);
+        free(arg);
+    }
+    _exit(0);
+}
+
+/*
+*   Closes the socket to the zygote, which makes it exit, and reaps it.
+*   Must be called with the zygote locked.
+*/
+static void unit_test_zygote_close() {
+    if (unit_test_zygote_socket >= 0)
+    {
+        close(unit_test_zygote_socket);
+        unit_test_zygote_socket = -1;
+    }
+    if (unit_test_zygote_pid > 0 && unit_test_zygote_parent == getpid())
+    {
+        while (waitpid(unit_test_zygote_pid, NULL, 0) < 0 && errno == EINTR);
+    }
+    unit_test_zygote_pid = 0;
+}
+
+static void unit_test_zygote_exit() {
+    pthread_mutex_lock(&unit_test_zygote_lock);
+    unit_test_zygote_close();
+    pthread_mutex_unlock(&unit_test_zygote_lock);
+}
+
+/*
+*   Forks the zygote unless this process already has one. A process forked
+*   by unit_test_start_forked() gets its own zygote rather than sharing
+*   its parent's. Must be called with the zygote locked. Returns 0, or the
+*   error which kept the zygote from starting.
+*/
+static int unit_test_zygote_spawn() {
+    if (unit_test_zygote_pid > 0 && unit_test_zygote_parent == getpid())
+    {
+        return 0;
     }
-    else
+    unit_test_zygote_close();
+
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0)
     {
-        test->num_failed++;
-        printf(" \033[1;31mFAILED\n\033[0m");
-        printf("\n\t\033[1;37mExpanded Information:\n");
-        printf("\t\033[1;36mAssert Float Equals \033[1;31mFailed\033[0m"
-            " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-        printf("\tAssertion expected \033[1;31m%ff\033[0m but got \033[1;31m%ff\033[0m.\n", a, b);
-        printf("\n\033[0m");
+        return errno;
+    }
+    unit_test_async_drain();
+    fflush(stdout);
+    fflush(stderr);
+    pid_t zygote = fork();
+    if (zygote < 0)
+    {
+        int error = errno;
+        close(sockets[0]);
+        close(sockets[1]);
+        return error;
+    }
+    if (zygote == 0)
+    {
+        close(sockets[0]);
+        unit_test_zygote_serve(sockets[1]);
+    }
+    close(sockets[1]);
+    unit_test_zygote_socket = sockets[0];
+    unit_test_zygote_pid = zygote;
+    unit_test_zygote_parent = getpid();
+    if (!unit_test_zygote_hooked)
+    {
+        unit_test_zygote_hooked = 1;
+        atexit(&unit_test_zygote_exit);
     }
+    return 0;
 }
 
 /*
-*   This function takes two integers and determines if they both contain the same
-*   value.
-*
-*   @param *test - the unit_test you wish to use to track the results. 
-*   @param a - the first integers you are comparing
-*   @param b - the second integers you are comparing
-*   @param *fname - file name. Use the macro __FILE_ for this field.
-*   @param lineno - line number. Use the macro __LINE__ for this field.
+*   This function forks the zygote process which death tests are run from.
+*   Calling it is optional, as the first death test starts the zygote if it
+*   is not already running. Call it once the program has done any setup
+*   which death tests rely on, such as loading data, and before starting
+*   threads, so that every death test starts from that state.
 *
 *   @author Brennan Hurst
-*   @version 10/07/2021
+*   @version 10/18/2026
 */
-void unit_test_assert_int_equals(struct unit_test *test, const char *fname, int lineno, int a, int b) {
-    assert(test != NULL);
-    assert(fname != NULL);
-    printf("%d - \033[1;37m%s: \033[1;36mAssert Integer Equals\033[0m between integers "
-             "\033[0;36m%d\033[0m and \033[0;36m%d\033[0m:", 
-             test->num_passed + test->num_failed, test->name, a, b);
-    if (a == b) {
-        test->num_passed++;
-        printf(" \033[1;32mPASSED\n\033[0m");
+void unit_test_zygote_start() {
+    pthread_mutex_lock(&unit_test_zygote_lock);
+    int error = unit_test_zygote_spawn();
+    pthread_mutex_unlock(&unit_test_zygote_lock);
+    if (error != 0)
+    {
+        fprintf(stderr, "unit_test: could not start the zygote process: %s\n", strerror(error));
+    }
+}
+
+/*
+*   Describes how a death test child ended.
+*/
+static void unit_test_format_death(struct unit_test_buffer *out, struct unit_test_death_result *result) {
+    if (result->timed_out)
+    {
+        unit_test_buffer_printf(out, "did not finish within \033[1;31m%d\033[0m seconds",
+            UNIT_TEST_DEATH_TIMEOUT);
+    }
+    else if (WIFSIGNALED(result->status))
+    {
+        unit_test_buffer_printf(out, "was killed by signal \033[1;31m%d (%s)\033[0m",
+            WTERMSIG(result->status), strsignal(WTERMSIG(result->status)));
     }
     else
     {
-        test->num_failed++;
-        printf(" \033[1;31mFAILED\n\033[0m");
-        printf("\n\t\033[1;37mExpanded Information:\n");
-        printf("\t\033[1;36mAssert Integer Equals \033[1;31mFailed\033[0m"
-            " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-        printf("\tAssertion expected \033[1;31m%d\033[0m but got \033[1;31m%d\033[0m.\n", a, b);
-        printf("\n\033[0m");
+        unit_test_buffer_printf(out, "exited with status \033[1;31m%d\033[0m",
+            WEXITSTATUS(result->status));
     }
 }
 
 /*
-*   This function takes two doubles and determines if they both contain the same
-*   value.
-*
-*   @param *test - the unit_test you wish to use to track the results. 
-*   @param a - the first doubles you are comparing
-*   @param b - the second doubles you are comparing
-*   @param *fname - file name. Use the macro __FILE_ for this field.
-*   @param lineno - line number. Use the macro __LINE__ for this field.
-*
-*   @author Brennan Hurst
-*   @version 10/07/2021
+*   Sends a death test to the zygote and reports whether its child ended
+*   the way the kind of assertion expects. For UNIT_TEST_KIND_DEATH,
+*   expected is a signal number, or 0 for any signal. For
+*   UNIT_TEST_KIND_EXIT, it is an exit status.
 */
-void unit_test_assert_double_equals(struct unit_test *test, const char *fname, int lineno, double a, double b) {
+static void unit_test_assert_dies(struct unit_test *test, const char *fname, int lineno, int kind,
+    void (*body)(void *arg), const void *arg, size_t arg_size, int expected, const char *message) {
     assert(test != NULL);
     assert(fname != NULL);
-    printf("%d - \033[1;37m%s: \033[1;36mAssert Double Equals\033[0m between doubles "
-             "\033[0;36m%f\033[0m and \033[0;36m%f\033[0m:", 
-             test->num_passed + test->num_failed, test->name, a, b);
-    if (a == b) {
-        test->num_passed++;
-        printf(" \033[1;32mPASSED\n\033[0m");
+    assert(body != NULL);
+    assert(arg != NULL || arg_size == 0);
+
+    struct unit_test_death_request request = {body, arg_size};
+    struct unit_test_death_result result = {0};
+    struct unit_test_buffer output = {0};
+    long long traced = unit_test_trace_begin();
+    pthread_mutex_lock(&unit_test_zygote_lock);
+    int error = unit_test_zygote_spawn();
+    int received = error == 0 && unit_test_socket_write(unit_test_zygote_socket, &request, sizeof(request)) == 0
+        && unit_test_socket_write(unit_test_zygote_socket, arg, arg_size) == 0
+        && unit_test_socket_read(unit_test_zygote_socket, &result, sizeof(result)) == 0;
+    if (received)
+    {
+        char *text = malloc(result.output_length + 1);
+        assert(text != NULL);
+        received = unit_test_socket_read(unit_test_zygote_socket, text, result.output_length) == 0;
+        text[received ? result.output_length : 0] = '\0';
+        output.data = text;
+        output.length = received ? result.output_length : 0;
+    }
+    if (!received && error == 0)
+    {
+        //the zygote died, so the next death test starts a new one
+        unit_test_zygote_close();
+    }
+    pthread_mutex_unlock(&unit_test_zygote_lock);
+    unit_test_trace_end(UNIT_TEST_TRACE_DEATH, unit_test_kinds[kind].title, traced);
+
+    int ended;
+    if (kind == UNIT_TEST_KIND_DEATH)
+    {
+        ended = WIFSIGNALED(result.status) && (expected == 0 || WTERMSIG(result.status) == expected);
     }
     else
     {
-        test->num_failed++;
-        printf(" \033[1;31mFAILED\n\033[0m");
-        printf("\n\t\033[1;37mExpanded Information:\n");
-        printf("\t\033[1;36mAssert Double Equals \033[1;31mFailed\033[0m"
-            " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-        printf("\tAssertion expected \033[1;31m%f\033[0m but got \033[1;31m%f\033[0m.\n", a, b);
-        printf("\n\033[0m");
-    }    
+        ended = WIFEXITED(result.status) && WEXITSTATUS(result.status) == expected;
+    }
+    int printed = message == NULL || (output.data != NULL && strstr(output.data, message) != NULL);
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno, .kind = kind, .passed = 0};
+    event.passed = received && !result.timed_out && ended && printed;
+
+    if (!event.passed)
+    {
+        struct unit_test_buffer out = {0};
+        unit_test_buffer_printf(&out, "\tAssertion expected the child to ");
+        if (kind == UNIT_TEST_KIND_EXIT)
+        {
+            unit_test_buffer_printf(&out, "exit with status \033[1;31m%d\033[0m", expected);
+        }
+        else if (expected == 0)
+        {
+            unit_test_buffer_printf(&out, "be killed by a signal");
+        }
+        else
+        {
+            unit_test_buffer_printf(&out, "be killed by signal \033[1;31m%d (%s)\033[0m",
+                expected, strsignal(expected));
+        }
+        if (message != NULL)
+        {
+            unit_test_buffer_printf(&out, " and print \033[1;31m\"%s\"\033[0m to standard error", message);
+        }
+        if (received)
+        {
+            unit_test_buffer_printf(&out, ",\n\tbut it ");
+            unit_test_format_death(&out, &result);
+            unit_test_buffer_printf(&out, ".\n");
+        }
+        else if (error != 0)
+        {
+            unit_test_buffer_printf(&out, ",\n\tbut the zygote process could not be started: %s.\n",
+                strerror(error));
+        }
+        else
+        {
+            unit_test_buffer_printf(&out, ",\n\tbut the zygote process exited before it could run.\n");
+        }
+        if (output.length > 0)
+        {
+            unit_test_buffer_printf(&out, "\tStandard error was:\n\033[0;36m");
+            for (char *line = output.data; *line != '\0';)
+            {
+                size_t length = strcspn(line, "\n");
+                unit_test_buffer_printf(&out, "\t| %.*s\n", (int) length, line);
+                line += length + (line[length] == '\n');
+            }
+            unit_test_buffer_printf(&out, "\033[0m");
+        }
+        event.detail = unit_test_buffer_detach(&out);
+    }
+    free(output.data);
+    unit_test_report(&event);
 }
 
 /*
-*   This function takes two longs and determines if they both contain the same
-*   value.
+*   This function runs body(arg) in a child process and asserts that the child
+*   is killed by a signal, as it is when it crashes, calls abort() or fails
+*   an assert(). The child is forked from the zygote process (see
+*   unit_test_zygote_start()), so it starts from the state the program was
+*   in when the zygote was started, not its current state. Because of this
+*   the argument is copied to the child by value: arg_size bytes starting
+*   at arg. Pointers inside it must point to memory which already existed
+*   when the zygote was started.
 *
-*   @param *test - the unit_test you wish to use to track the results. 
-*   @param a - the first long you are comparing
-*   @param b - the second long you are comparing
+*   @param *test - the unit_test you wish to use to track the results.
 *   @param *fname - file name. Use the macro __FILE_ for this field.
 *   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param body - the function expected to die.
+*   @param *arg - the argument copied to body, or NULL.
+*   @param arg_size - the size of the argument in bytes.
+*   @param signal_number - the signal expected to kill the child, or 0 for
+*       any signal.
+*   @param *message - text which must appear in the child's standard
+*       error, or NULL.
 *
 *   @author Brennan Hurst
-*   @version 10/07/2021
+*   @version 10/18/2026
 */
-void unit_test_assert_long_equals(struct unit_test *test, const char *fname, int lineno, long a, long b) {
-    assert(test != NULL);
-    assert(fname != NULL);
-    printf("%d - \033[1;37m%s: \033[1;36mAssert Long Equals\033[0m between longs "
-             "\033[0;36m%ldL\033[0m and \033[0;36m%ldL\033[0m:", 
-             test->num_passed + test->num_failed, test->name, a, b);
-    if (a == b) {
-        test->num_passed++;
-        printf(" \033[1;32mPASSED\n\033[0m");
-    }
-    else
-    {
-        test->num_failed++;
-        printf(" \033[1;31mFAILED\n\033[0m");
-        printf("\n\t\033[1;37mExpanded Information:\n");
-        printf("\t\033[1;36mAssert Long Equals \033[1;31mFailed\033[0m"
-            " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-        printf("\tAssertion expected \033[1;31m%ldL\033[0m but got \033[1;31m%ldL\033[0m.\n", a, b);
-        printf("\n\033[0m");
-    }      
+void unit_test_assert_death(struct unit_test *test, const char *fname, int lineno, void (*body)(void *arg),
+    const void *arg, size_t arg_size, int signal_number, const char *message) {
+    unit_test_assert_dies(test, fname, lineno, UNIT_TEST_KIND_DEATH, body, arg, arg_size,
+        signal_number, message);
 }
 
 /*
-*   This function takes two chars and determines if they both contain the same
-*   value.
+*   This function runs body(arg) in a child process, like
+*   unit_test_assert_death(), and asserts that the child exits with the
+*   given status, for example by calling exit() after rejecting its input.
+*   A body which returns normally exits with status 0.
 *
-*   @param *test - the unit_test you wish to use to track the results. 
-*   @param a - the first char you are comparing
-*   @param b - the second char you are comparing
+*   @param *test - the unit_test you wish to use to track the results.
 *   @param *fname - file name. Use the macro __FILE_ for this field.
 *   @param lineno - line number. Use the macro __LINE__ for this field.
+*   @param body - the function expected to exit.
+*   @param *arg - the argument copied to body, or NULL.
+*   @param arg_size - the size of the argument in bytes.
+*   @param exit_code - the status the child is expected to exit with.
+*   @param *message - text which must appear in the child's standard
+*       error, or NULL.
 *
 *   @author Brennan Hurst
-*   @version 10/07/2021
+*   @version 10/18/2026
 */
-void unit_test_assert_char_equals(struct unit_test *test, const char *fname, int lineno, char a, char b) {
-    assert(test != NULL);
-    assert(fname != NULL);
-    printf("%d - \033[1;37m%s: \033[1;36mAssert Char Equals\033[0m between chars "
-             "\033[0;36m'%c'\033[0m and \033[0;36m'%c'\033[0m:", 
-             test->num_passed + test->num_failed, test->name, a, b);
-    if (a == b) {
-        test->num_passed++;
-        printf(" \033[1;32mPASSED\n\033[0m");
+void unit_test_assert_exit_code(struct unit_test *test, const char *fname, int lineno, void (*body)(void *arg),
+    const void *arg, size_t arg_size, int exit_code, const char *message) {
+    unit_test_assert_dies(test, fname, lineno, UNIT_TEST_KIND_EXIT, body, arg, arg_size,
+        exit_code, message);
+}
+
+/*
+*   The scalar kind and size of each UNIT_TEST_ELEMENT_* type.
+*/
+static const int unit_test_element_kinds[] = {
+    UNIT_TEST_KIND_CHAR, UNIT_TEST_KIND_INT, UNIT_TEST_KIND_LONG, UNIT_TEST_KIND_FLOAT, UNIT_TEST_KIND_DOUBLE
+};
+
+static const size_t unit_test_element_sizes[] = {
+    sizeof(char), sizeof(int), sizeof(long), sizeof(float), sizeof(double)
+};
+
+/*
+*   Returns the index of the first element at which two output arrays of a
+*   differential test differ, or count if none do. Matching batches are
+*   passed with a single memcmp. Floating point elements are equal when
+*   they are within the tolerance of each other, or are both NaN.
+*/
+static size_t unit_test_differential_mismatch(int type, const void *a, const void *b, size_t count,
+    double tolerance) {
+    if (memcmp(a, b, count * unit_test_element_sizes[type]) == 0)
+    {
+        return count;
     }
-    else
+    if (type != UNIT_TEST_ELEMENT_FLOAT && type != UNIT_TEST_ELEMENT_DOUBLE)
     {
-        test->num_failed++;
-        printf(" \033[1;31mFAILED\n\033[0m");
-        printf("\n\t\033[1;37mExpanded Information:\n");
-        printf("\t\033[1;36mAssert Char Equals \033[1;31mFailed\033[0m"
-            " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-        printf("\tAssertion expected \033[1;31m'%c'\033[0m but got \033[1;31m'%c'\033[0m.\n", a, b);
-        printf("\n\033[0m");
-    }    
+        return unit_test_array_mismatch(unit_test_element_kinds[type], a, b, count);
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        double x = type == UNIT_TEST_ELEMENT_FLOAT ? ((const float *) a)[i] : ((const double *) a)[i];
+        double y = type == UNIT_TEST_ELEMENT_FLOAT ? ((const float *) b)[i] : ((const double *) b)[i];
+        if (x == y || (x != x && y != y))
+        {
+            continue;
+        }
+        double ax = x < 0 ? -x : x;
+        double ay = y < 0 ? -y : y;
+        double difference = x - y < 0 ? y - x : x - y;
+        if (!(difference <= tolerance * (ax > ay ? ax : ay)))
+        {
+            return i;
+        }
+    }
+    return count;
 }
 
 /*
-*   This function takes two floats and determines if they both contain the same
-*   value.
-*
-*   @param *test - the unit_test you wish to use to track the results. 
-*   @param a - the first float array are comparing
-*   @param b - the second float array are comparing
-*   @param *fname - file name. Use the macro __FILE_ for this field.
-*   @param lineno - line number. Use the macro __LINE__ for this field.
-*   @param asize - the size of array a.
-*   @param bsize - the size of array b.
-*
-*   @author Brennan Hurst
-*   @version 10/09/2021
+*   Runs both implementations on one input, and returns whether their
+*   outputs differ.
 */
-void unit_test_assert_float_array_equals(struct unit_test *test, const char *fname, int lineno, float *a, int asize, float *b, int bsize) {
-    assert(a != NULL);
-    assert(b != NULL);
-    assert(test != NULL);
-    assert(fname != NULL);
+static int unit_test_differential_diverges(struct unit_test_differential *options, const void *input,
+    void *expected, void *actual) {
+    options->reference(input, expected, 1);
+    options->candidate(input, actual, 1);
+    return unit_test_differential_mismatch(options->output_type, expected, actual, options->output_length,
+        options->tolerance) < options->output_length;
+}
 
-    printf("%d - \033[1;37m%s: \033[1;36mAssert Float Array Equals\033[0m:", 
-             test->num_passed + test->num_failed, test->name);
-    if (asize == bsize) {
-        int i = 0;
-        for (; i < asize/sizeof(a[0]); i++)
+/*
+*   Rounds toward zero, leaving values too large for a long long alone.
+*/
+static double unit_test_truncate(double value) {
+    return value > -1e18 && value < 1e18 ? (double) (long long) value : value;
+}
+
+/*
+*   Moves element i of an input toward zero: to zero itself for step 0, to
+*   half its value for step 1, and by one, or to a whole number, for step
+*   2. Returns whether the element changed.
+*/
+static int unit_test_differential_shrink(int type, void *input, size_t i, int step) {
+    size_t size = unit_test_element_sizes[type];
+    char before[sizeof(double) > sizeof(long) ? sizeof(double) : sizeof(long)];
+    memcpy(before, (char *) input + i * size, size);
+    switch (type)
+    {
+        case UNIT_TEST_ELEMENT_FLOAT:
         {
-            if (a[i] != b[i]) break;
+            float *value = (float *) input + i;
+            *value = step == 0 ? 0 : step == 1 ? *value / 2 : (float) unit_test_truncate(*value);
+            break;
         }
-        if (i == (asize/sizeof(a[0])))
+        case UNIT_TEST_ELEMENT_DOUBLE:
         {
-            test->num_passed++;
-            printf(" \033[1;32mPASSED\n\033[0m");
+            double *value = (double *) input + i;
+            *value = step == 0 ? 0 : step == 1 ? *value / 2 : unit_test_truncate(*value);
+            break;
         }
-        else
+        case UNIT_TEST_ELEMENT_LONG:
         {
-            test->num_failed++;
-            printf(" \033[1;31mFAILED\n\033[0m");
-            printf("\n\t\033[1;37mExpanded Information:\n");
-            printf("\t\033[1;36mAssert Float Array Equals \033[1;31mFailed\033[0m"
-                " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-            printf("\tAssertion expected:\n");
-            printf("\t\033[1;32m[");
-            for (int j = 0; j < asize/sizeof(a[0]); j++)
-            {
-                printf("%ff", a[j]);
-                if (j < asize/sizeof(a[0]) - 1)
-                {
-                    printf(", ");
-                }
-                else
-                {
-                    printf("]\n\033[0m");
-                }
-            }
-            printf("\tbut got:\n");
-            printf("\t\033[1;32m[");
-            for (int j = 0; j < bsize/sizeof(b[0]); j++)
+            long *value = (long *) input + i;
+            *value = step == 0 ? 0 : step == 1 ? *value / 2 : *value - (*value > 0) + (*value < 0);
+            break;
+        }
+        case UNIT_TEST_ELEMENT_INT:
+        {
+            int *value = (int *) input + i;
+            *value = step == 0 ? 0 : step == 1 ? *value / 2 : *value - (*value > 0) + (*value < 0);
+            break;
+        }
+        default:
+        {
+            char *value = (char *) input + i;
+            *value = step == 0 ? 0 : step == 1 ? *value / 2 : *value - (*value > 0) + (*value < 0);
+            break;
+        }
+    }
+    return memcmp(before, (char *) input + i * size, size) != 0;
+}
+
+/*
+*   Shrinks a diverging input one element at a time, keeping each change
+*   toward zero after which the implementations still disagree, until no
+*   element can be shrunk further. Leaves the outputs for the shrunk input
+*   in expected and actual.
+*/
+static void unit_test_differential_minimize(struct unit_test_differential *options, void *input,
+    void *expected, void *actual) {
+    size_t size = unit_test_element_sizes[options->input_type];
+    size_t length = options->input_length * size;
+    char *trial = malloc(length);
+    assert(trial != NULL);
+    memcpy(trial, input, length);
+    int attempts = 100000;
+    int shrunk = 1;
+    while (shrunk && attempts > 0)
+    {
+        shrunk = 0;
+        for (size_t i = 0; i < options->input_length && attempts > 0; i++)
+        {
+            for (int step = 0; step < 3 && attempts > 0; step++)
             {
-                if (j == i)
-                {
-                   printf("\033[1;31m%ff\033[0m", b[j]); 
-                }
-                else
-                {
-                    printf("\033[1;32m%ff", b[j]);
-                }
-                if (j < bsize/sizeof(b[0]) - 1)
+                if (!unit_test_differential_shrink(options->input_type, trial, i, step))
                 {
-                    printf(", ");
+                    continue;
                 }
-                else
+                attempts--;
+                if (unit_test_differential_diverges(options, trial, expected, actual))
                 {
-                    printf("]\n\033[0m");
+                    memcpy((char *) input + i * size, trial + i * size, size);
+                    shrunk = 1;
+                    break;
                 }
+                memcpy(trial + i * size, (char *) input + i * size, size);
             }
-            printf("\n\033[0m");
         }
     }
-    else
-    {
-        test->num_failed++;
-        printf(" \033[1;31mFAILED\n\033[0m");
-        printf("\n\t\033[1;37mExpanded Information:\n");
-        printf("\t\033[1;36mAssert Float Array Equals \033[1;31mFailed\033[0m"
-            " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-        printf("\n\t\033[1;31mFloat arrays are of uneven length.\033[0m\n\n");
-        printf("\tAssertion expected:\n");
-        printf("\t\033[1;32m[");
-        for (int j = 0; j < asize/sizeof(a[0]); j++)
-        {
-            printf("%ff", a[j]);
-            if (j < asize/sizeof(a[0]) - 1)
-            {
-                printf(", ");
-            }
-            else
-            {
-                printf("] (Array Length: %d)\n\033[0m", asize/sizeof(a[0]));
-            }
-        }
-        printf("\tbut got:\n");
-        printf("\t\033\033[1;31m[");
-        for (int j = 0; j < bsize/sizeof(b[0]); j++)
-        {
-            printf("%ff", b[j]);
-            
-            if (j < bsize/sizeof(b[0]) - 1)
-            {
-                printf(", ");
-            }
-            else
-            {
-                printf("] \033[1;31m(Array Length: %d)\n\033[0m", bsize/sizeof(b[0]));
-            }
-        }
-        printf("\n\033[0m");
-        
-    }    
+    unit_test_differential_diverges(options, input, expected, actual);
+    free(trial);
 }
 
 /*
-*   This function takes two integers and determines if they both contain the same
-*   value.
+*   This function checks an optimized implementation of a function against
+*   a simple reference implementation of it. Both are run over count
+*   generated inputs, batch inputs per call, and their outputs compared.
+*   Batches alternate which implementation runs first, so that neither
+*   always gets the inputs from a warm cache, and each call is timed; the
+*   speedup of the candidate over the reference is printed with the test's
+*   summary. The harness only reads the clock three times per batch and compares
+*   matching outputs with one memcmp, so with large batches nearly all of
+*   the time is spent in the two implementations.
 *
-*   @param *test - the unit_test you wish to use to track the results. 
-*   @param a - the first integer array you are comparing
-*   @param b - the second integer array you are comparing
+*   The check stops at the first input on which the outputs differ. That
+*   input is shrunk toward zero, one element at a time, for as long as the
+*   implementations still disagree on it, and the assertion fails showing
+*   the shrunk input, both outputs for it, and the index of the original
+*   input.
+*
+*   @param *test - the unit_test you wish to use to track the results.
 *   @param *fname - file name. Use the macro __FILE_ for this field.
 *   @param lineno - line number. Use the macro __LINE__ for this field.
-*   @param asize - the size of array a.
-*   @param bsize - the size of array b.
+*   @param *options - the implementations, input generator and types.
+*
 *   @author Brennan Hurst
-*   @version 10/09/2021
+*   @version 10/18/2026
 */
-void unit_test_assert_int_array_equals(struct unit_test *test, const char *fname, int lineno, int *a, int asize, int *b, int bsize) {
-    assert(a != NULL);
-    assert(b != NULL);
+void unit_test_assert_differential(struct unit_test *test, const char *fname, int lineno,
+    struct unit_test_differential *options) {
     assert(test != NULL);
     assert(fname != NULL);
+    assert(options != NULL);
+    assert(options->generate != NULL && options->reference != NULL && options->candidate != NULL);
+    assert(options->input_type >= UNIT_TEST_ELEMENT_CHAR && options->input_type <= UNIT_TEST_ELEMENT_DOUBLE);
+    assert(options->output_type >= UNIT_TEST_ELEMENT_CHAR && options->output_type <= UNIT_TEST_ELEMENT_DOUBLE);
+    assert(options->input_length > 0 && options->output_length > 0);
+    size_t batch = options->batch > 0 ? options->batch : 4096;
+    size_t input_size = options->input_length * unit_test_element_sizes[options->input_type];
+    size_t output_size = options->output_length * unit_test_element_sizes[options->output_type];
+    char *inputs = malloc(batch * input_size);
+    char *expected = calloc(batch, output_size);
+    char *actual = calloc(batch, output_size);
+    struct unit_test_differential_result *result = calloc(1, sizeof(struct unit_test_differential_result));
+    assert(inputs != NULL && expected != NULL && actual != NULL && result != NULL);
+    result->name = options->name;
+
+    long long diverged = -1;
+    size_t at = 0;
+    int reference_first = 1;
+    for (long long first = 0; first < options->count && diverged < 0; first += batch)
+    {
+        size_t count = options->count - first < (long long) batch ? (size_t) (options->count - first) : batch;
+        for (size_t i = 0; i < count; i++)
+        {
+            options->generate(inputs + i * input_size, first + i, options->seed);
+        }
+        //alternate which implementation runs first, so neither always finds the inputs in cache
+        void (*run_first)(const void *, void *, size_t) = reference_first ? options->reference : options->candidate;
+        void (*run_second)(const void *, void *, size_t) = reference_first ? options->candidate : options->reference;
+        long long *first_ns = reference_first ? &result->reference_ns : &result->candidate_ns;
+        long long *second_ns = reference_first ? &result->candidate_ns : &result->reference_ns;
+        long long started = unit_test_trace_clock();
+        run_first(inputs, reference_first ? expected : actual, count);
+        long long middle = unit_test_trace_clock();
+        run_second(inputs, reference_first ? actual : expected, count);
+        long long finished = unit_test_trace_clock();
+        *first_ns += middle - started;
+        *second_ns += finished - middle;
+        reference_first = !reference_first;
+        result->inputs += count;
 
-    printf("%d - \033[1;37m%s: \033[1;36mAssert Integer Array Equals\033[0m:", 
-             test->num_passed + test->num_failed, test->name);
-    if (asize == bsize) {
-        int i = 0;
-        for (; i < asize/sizeof(a[0]); i++)
+        size_t i = unit_test_differential_mismatch(options->output_type, expected, actual,
+            count * options->output_length, options->tolerance);
+        if (i < count * options->output_length)
         {
-            if (a[i] != b[i]) break;
+            at = i / options->output_length;
+            diverged = first + at;
         }
-        if (i == (asize/sizeof(a[0])))
+    }
+
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_DIFFERENTIAL, .passed = diverged < 0};
+    if (!event.passed)
+    {
+        char *original = inputs + at * input_size;
+        char *minimized = malloc(input_size);
+        char *minimized_expected = malloc(output_size);
+        char *minimized_actual = malloc(output_size);
+        assert(minimized != NULL && minimized_expected != NULL && minimized_actual != NULL);
+        memcpy(minimized, original, input_size);
+        int alone = unit_test_differential_diverges(options, minimized, minimized_expected, minimized_actual);
+        if (alone)
         {
-            test->num_passed++;
-            printf(" \033[1;32mPASSED\n\033[0m");
+            unit_test_differential_minimize(options, minimized, minimized_expected, minimized_actual);
         }
         else
         {
-            test->num_failed++;
-            printf(" \033[1;31mFAILED\n\033[0m");
-            printf("\n\t\033[1;37mExpanded Information:\n");
-            printf("\t\033[1;36mAssert Integer Array Equals \033[1;31mFailed\033[0m"
-                " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-            printf("\tAssertion expected:\n");
-            printf("\t\033[1;32m[");
-            for (int j = 0; j < asize/sizeof(a[0]); j++)
-            {
-                printf("%d", a[j]);
-                if (j < asize/sizeof(a[0]) - 1)
-                {
-                    printf(", ");
-                }
-                else
-                {
-                    printf("]\n\033[0m");
-                }
-            }
-            printf("\tbut got:\n");
-            printf("\t\033[1;32m[");
-            for (int j = 0; j < bsize/sizeof(b[0]); j++)
-            {
-                if (j == i)
-                {
-                   printf("\033[1;31m%d\033[0m", b[j]); 
-                }
-                else
-                {
-                    printf("\033[1;32m%d", b[j]);
-                }
-                if (j < bsize/sizeof(b[0]) - 1)
-                {
-                    printf(", ");
-                }
-                else
-                {
-                    printf("]\n\033[0m");
-                }
-            }
-            printf("\n\033[0m");
+            memcpy(minimized_expected, expected + at * output_size, output_size);
+            memcpy(minimized_actual, actual + at * output_size, output_size);
+        }
+        size_t i = unit_test_differential_mismatch(options->output_type, minimized_expected, minimized_actual,
+            options->output_length, options->tolerance);
+        int input_kind = unit_test_element_kinds[options->input_type];
+        int output_kind = unit_test_element_kinds[options->output_type];
+
+        struct unit_test_buffer out = {0};
+        unit_test_buffer_printf(&out, "\t\033[1;31m%s\033[0m diverged from the reference on input"
+            " \033[1;31m%lld\033[0m (seed %llu).\n", options->name, diverged, options->seed);
+        if (!alone)
+        {
+            unit_test_buffer_printf(&out, "\tThe input only diverges when run in a batch, so it was not"
+                " minimized.\n");
+        }
+        unit_test_buffer_printf(&out, "\t%s input:\n", alone ? "Minimized" : "Diverging");
+        unit_test_buffer_printf(&out, "\t\033[1;32m[");
+        unit_test_format_array(&out, input_kind, minimized, options->input_length, (size_t) -1);
+        unit_test_buffer_printf(&out, "]\n\033[0m");
+        unit_test_buffer_printf(&out, "\tReference output:\n");
+        unit_test_buffer_printf(&out, "\t\033[1;32m[");
+        unit_test_format_array(&out, output_kind, minimized_expected, options->output_length, (size_t) -1);
+        unit_test_buffer_printf(&out, "]\n\033[0m");
+        unit_test_buffer_printf(&out, "\tCandidate output:\n");
+        unit_test_buffer_printf(&out, "\t\033[1;32m[");
+        unit_test_format_array(&out, output_kind, minimized_actual, options->output_length, i);
+        unit_test_buffer_printf(&out, "]\n\033[0m");
+        if (memcmp(minimized, original, input_size) != 0)
+        {
+            unit_test_buffer_printf(&out, "\tOriginal input:\n");
+            unit_test_buffer_printf(&out, "\t\033[1;32m[");
+            unit_test_format_array(&out, input_kind, original, options->input_length, (size_t) -1);
+            unit_test_buffer_printf(&out, "]\n\033[0m");
+        }
+        event.detail = unit_test_buffer_detach(&out);
+        free(minimized);
+        free(minimized_expected);
+        free(minimized_actual);
+    }
+    unit_test_report(&event);
+
+    struct unit_test_differential_result **tail = &test->differentials;
+    while (*tail != NULL)
+    {
+        tail = &(*tail)->next;
+    }
+    *tail = result;
+    free(inputs);
+    free(expected);
+    free(actual);
+}
+
+/*
+*   Returns the bucket a value falls in. Values below 2^SUB_BITS have a
+*   bucket each; above that, every power of two is split into
+*   2^(SUB_BITS - 1) buckets, so a bucket is never wider than 1/128th of
+*   the values in it.
+*/
+static inline int unit_test_histogram_index(unsigned long long value) {
+    if (value > UNIT_TEST_HISTOGRAM_HIGHEST)
+    {
+        value = UNIT_TEST_HISTOGRAM_HIGHEST;
+    }
+    int exponent = 63 - __builtin_clzll(value | 1);
+    int shift = exponent > UNIT_TEST_HISTOGRAM_SUB_BITS - 1 ? exponent - (UNIT_TEST_HISTOGRAM_SUB_BITS - 1) : 0;
+    return (shift << (UNIT_TEST_HISTOGRAM_SUB_BITS - 1)) + (int) (value >> shift);
+}
+
+/*
+*   Returns the highest value which falls in a bucket.
+*/
+static long long unit_test_histogram_highest(int index) {
+    if (index < (1 << UNIT_TEST_HISTOGRAM_SUB_BITS))
+    {
+        return index;
+    }
+    int shift = (index >> (UNIT_TEST_HISTOGRAM_SUB_BITS - 1)) - 1;
+    long long mantissa = index - ((long long) shift << (UNIT_TEST_HISTOGRAM_SUB_BITS - 1));
+    return ((mantissa + 1) << shift) - 1;
+}
+
+/*
+*   This function creates a latency histogram attached to a unit test. Its
+*   percentiles are printed in the test's summary, and can be checked with
+*   unit_test_assert_percentile. Values are kept to within 1% in a fixed
+*   amount of memory per recording thread, from 0 up to about 18 minutes;
+*   longer values are counted as the longest.
+*
+*   @param *test - the unit_test to attach the histogram to.
+*   @param *name - name of the operation being measured.
+*
+*   @return the new histogram.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_histogram *unit_test_histogram_init(struct unit_test *test, const char *name) {
+    assert(test != NULL);
+    assert(name != NULL);
+    struct unit_test_histogram *histogram = calloc(1, sizeof(struct unit_test_histogram));
+    assert(histogram != NULL);
+    histogram->name = name;
+    struct unit_test_histogram **tail = &test->histograms;
+    while (*tail != NULL)
+    {
+        tail = &(*tail)->next;
+    }
+    *tail = histogram;
+    return histogram;
+}
+
+/*
+*   Returns the calling thread's part of a histogram, allocating it on the
+*   thread's first recording. Threads past the first UNIT_TEST_MAX_SHARDS
+*   share one last part between them.
+*/
+static struct unit_test_histogram_shard *unit_test_histogram_shard(struct unit_test_histogram *histogram,
+    int slot) {
+    int index = slot < UNIT_TEST_MAX_SHARDS ? slot : UNIT_TEST_MAX_SHARDS;
+    struct unit_test_histogram_shard *shard = __atomic_load_n(&histogram->shards[index], __ATOMIC_ACQUIRE);
+    if (shard == NULL)
+    {
+        struct unit_test_histogram_shard *fresh = aligned_alloc(UNIT_TEST_CACHE_LINE,
+            sizeof(struct unit_test_histogram_shard));
+        assert(fresh != NULL);
+        memset(fresh, 0, sizeof(struct unit_test_histogram_shard));
+        fresh->min = LLONG_MAX;
+        if (__atomic_compare_exchange_n(&histogram->shards[index], &shard, fresh, 0,
+            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            shard = fresh;
+        }
+        else
+        {
+            free(fresh);
         }
     }
-    else
+    return shard;
+}
+
+/*
+*   This function records one value in a histogram. It can be called from
+*   any thread, and takes a few nanoseconds: each thread records into its
+*   own part of the histogram with plain stores, without locks or atomic
+*   read-modify-writes, and the parts are only added together when the
+*   histogram is read.
+*
+*   @param *histogram - the histogram.
+*   @param nanoseconds - the value to record.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+void unit_test_histogram_record(struct unit_test_histogram *histogram, long long nanoseconds) {
+    int slot = unit_test_thread_slot();
+    struct unit_test_histogram_shard *shard = unit_test_histogram_shard(histogram, slot);
+    long long value = nanoseconds > 0 ? nanoseconds : 0;
+    int index = unit_test_histogram_index(value);
+    if (slot < UNIT_TEST_MAX_SHARDS)
     {
-        test->num_failed++;
-        printf(" \033[1;31mFAILED\n\033[0m");
-        printf("\n\t\033[1;37mExpanded Information:\n");
-        printf("\t\033[1;36mAssert Integer Array Equals \033[1;31mFailed\033[0m"
-            " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-        printf("\n\t\033[1;31mInteger arrays are of uneven length.\033[0m\n\n");
-        printf("\tAssertion expected:\n");
-        printf("\t\033[1;32m[");
-        for (int j = 0; j < asize/sizeof(a[0]); j++)
+        //only this thread writes to its part, so the updates need not be atomic, only untorn
+        __atomic_store_n(&shard->counts[index], shard->counts[index] + 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&shard->sum, shard->sum + value, __ATOMIC_RELAXED);
+        if (value < shard->min)
         {
-            printf("%d", a[j]);
-            if (j < asize/sizeof(a[0]) - 1)
-            {
-                printf(", ");
-            }
-            else
-            {
-                printf("] (Array Length: %d)\n\033[0m", asize/sizeof(a[0]));
-            }
+            __atomic_store_n(&shard->min, value, __ATOMIC_RELAXED);
         }
-        printf("\tbut got:\n");
-        printf("\t\033\033[1;31m[");
-        for (int j = 0; j < bsize/sizeof(b[0]); j++)
+        if (value > shard->max)
         {
-            printf("%d", b[j]);
-            
-            if (j < bsize/sizeof(b[0]) - 1)
-            {
-                printf(", ");
-            }
-            else
-            {
-                printf("] \033[1;31m(Array Length: %d)\n\033[0m", bsize/sizeof(b[0]));
-            }
+            __atomic_store_n(&shard->max, value, __ATOMIC_RELAXED);
         }
-        printf("\n\033[0m");
-        
-    }    
+        return;
+    }
+    __atomic_fetch_add(&shard->counts[index], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&shard->sum, value, __ATOMIC_RELAXED);
+    long long seen = __atomic_load_n(&shard->min, __ATOMIC_RELAXED);
+    while (value < seen && !__atomic_compare_exchange_n(&shard->min, &seen, value, 1,
+        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    seen = __atomic_load_n(&shard->max, __ATOMIC_RELAXED);
+    while (value > seen && !__atomic_compare_exchange_n(&shard->max, &seen, value, 1,
+        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
 }
 
 /*
-*   This function takes two doubles and determines if they both contain the same
-*   value.
+*   This function calls an operation a number of times, recording how long
+*   each call takes in a histogram. The time includes reading the clock,
+*   which takes some tens of nanoseconds.
 *
-*   @param *test - the unit_test you wish to use to track the results. 
-*   @param a - the first double array you are comparing
-*   @param b - the second double array you are comparing
-*   @param *fname - file name. Use the macro __FILE_ for this field.
-*   @param lineno - line number. Use the macro __LINE__ for this field.
-*   @param asize - the size of array a.
-*   @param bsize - the size of array b.
+*   @param *histogram - the histogram.
+*   @param *operation - the operation, called with arg and the number of
+*       the call.
+*   @param *arg - passed to the operation.
+*   @param calls - number of times to call the operation.
 *
 *   @author Brennan Hurst
-*   @version 10/09/2021
+*   @version 10/18/2026
 */
-void unit_test_assert_double_array_equals(struct unit_test *test, const char *fname, int lineno, double *a, int asize, double *b, int bsize) {
-    assert(a != NULL);
-    assert(b != NULL);
-    assert(test != NULL);
-    assert(fname != NULL);
+void unit_test_histogram_measure(struct unit_test_histogram *histogram, void (*operation)(void *arg, long call),
+    void *arg, long calls) {
+    assert(histogram != NULL);
+    assert(operation != NULL);
+    for (long i = 0; i < calls; i++)
+    {
+        long long started = unit_test_trace_clock();
+        operation(arg, i);
+        unit_test_histogram_record(histogram, unit_test_trace_clock() - started);
+    }
+}
+
+/*
+*   A histogram's parts added together.
+*/
+struct unit_test_histogram_totals {
+    long long counts[UNIT_TEST_HISTOGRAM_BUCKETS];
+    long long total;
+    long long sum;
+    long long min;
+    long long max;
+};
 
-    printf("%d - \033[1;37m%s: \033[1;36mAssert Double Array Equals\033[0m:", 
-             test->num_passed + test->num_failed, test->name);
-    if (asize == bsize) {
-        int i = 0;
-        for (; i < asize/sizeof(a[0]); i++)
+static void unit_test_histogram_merge(struct unit_test_histogram *histogram,
+    struct unit_test_histogram_totals *totals) {
+    memset(totals, 0, sizeof(struct unit_test_histogram_totals));
+    totals->min = LLONG_MAX;
+    for (int i = 0; i <= UNIT_TEST_MAX_SHARDS; i++)
+    {
+        struct unit_test_histogram_shard *shard = __atomic_load_n(&histogram->shards[i], __ATOMIC_ACQUIRE);
+        if (shard == NULL)
         {
-            if (a[i] != b[i]) break;
+            continue;
         }
-        if (i == (asize/sizeof(a[0])))
+        for (int j = 0; j < UNIT_TEST_HISTOGRAM_BUCKETS; j++)
         {
-            test->num_passed++;
-            printf(" \033[1;32mPASSED\n\033[0m");
+            long long count = __atomic_load_n(&shard->counts[j], __ATOMIC_RELAXED);
+            totals->counts[j] += count;
+            totals->total += count;
         }
-        else
+        totals->sum += __atomic_load_n(&shard->sum, __ATOMIC_RELAXED);
+        long long min = __atomic_load_n(&shard->min, __ATOMIC_RELAXED);
+        long long max = __atomic_load_n(&shard->max, __ATOMIC_RELAXED);
+        totals->min = min < totals->min ? min : totals->min;
+        totals->max = max > totals->max ? max : totals->max;
+    }
+}
+
+/*
+*   Returns the value below which the given percent of the recorded values
+*   fall, as the highest value of the bucket it is in, so that it is never
+*   less than the true percentile; and never more than the largest value
+*   recorded.
+*/
+static long long unit_test_histogram_percentile(struct unit_test_histogram_totals *totals, double percentile) {
+    if (totals->total == 0)
+    {
+        return 0;
+    }
+    long long wanted = (long long) (percentile / 100 * totals->total + 0.999999);
+    wanted = wanted < 1 ? 1 : wanted;
+    long long seen = 0;
+    for (int i = 0; i < UNIT_TEST_HISTOGRAM_BUCKETS; i++)
+    {
+        seen += totals->counts[i];
+        if (seen >= wanted)
         {
-            test->num_failed++;
-            printf(" \033[1;31mFAILED\n\033[0m");
-            printf("\n\t\033[1;37mExpanded Information:\n");
-            printf("\t\033[1;36mAssert Double Array Equals \033[1;31mFailed\033[0m"
-                " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-            printf("\tAssertion expected:\n");
-            printf("\t\033[1;32m[");
-            for (int j = 0; j < asize/sizeof(a[0]); j++)
-            {
-                printf("%f", a[j]);
-                if (j < asize/sizeof(a[0]) - 1)
-                {
-                    printf(", ");
-                }
-                else
-                {
-                    printf("]\n\033[0m");
-                }
-            }
-            printf("\tbut got:\n");
-            printf("\t\033[1;32m[");
-            for (int j = 0; j < bsize/sizeof(b[0]); j++)
-            {
-                if (j == i)
-                {
-                   printf("\033[1;31m%f\033[0m", b[j]); 
-                }
-                else
-                {
-                    printf("\033[1;32m%f", b[j]);
-                }
-                if (j < bsize/sizeof(b[0]) - 1)
-                {
-                    printf(", ");
-                }
-                else
-                {
-                    printf("]\n\033[0m");
-                }
-            }
-            printf("\n\033[0m");
+            long long highest = unit_test_histogram_highest(i);
+            return highest < totals->max ? highest : totals->max;
         }
     }
-    else
+    return totals->max;
+}
+
+/*
+*   Prints a histogram's percentiles as part of a test's summary.
+*/
+static void unit_test_histogram_print(struct unit_test_histogram *histogram, int run) {
+    static const double percentiles[] = {50, 90, 99, 99.9, 99.99, 100};
+    struct unit_test_histogram_totals *totals = malloc(sizeof(struct unit_test_histogram_totals));
+    assert(totals != NULL);
+    unit_test_histogram_merge(histogram, totals);
+    printf("\033[1;37mLatency Histogram %d:\033[0m %s, %lld calls", run, histogram->name, totals->total);
+    if (totals->total > 0)
     {
-        test->num_failed++;
-        printf(" \033[1;31mFAILED\n\033[0m");
-        printf("\n\t\033[1;37mExpanded Information:\n");
-        printf("\t\033[1;36mAssert Double Array Equals \033[1;31mFailed\033[0m"
-            " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-        printf("\n\t\033[1;31mDouble arrays are of uneven length.\033[0m\n\n");
-        printf("\tAssertion expected:\n");
-        printf("\t\033[1;32m[");
-        for (int j = 0; j < asize/sizeof(a[0]); j++)
+        printf(", min %.3fus, mean %.3fus", totals->min / 1e3, (double) totals->sum / totals->total / 1e3);
+    }
+    printf("\n");
+    for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]) && totals->total > 0; i++)
+    {
+        if (percentiles[i] == 100)
         {
-            printf("%f", a[j]);
-            if (j < asize/sizeof(a[0]) - 1)
-            {
-                printf(", ");
-            }
-            else
-            {
-                printf("] (Array Length: %d)\n\033[0m", asize/sizeof(a[0]));
-            }
+            printf("\tmax     %14.3fus\n", totals->max / 1e3);
         }
-        printf("\tbut got:\n");
-        printf("\t\033\033[1;31m[");
-        for (int j = 0; j < bsize/sizeof(b[0]); j++)
+        else
         {
-            printf("%f", b[j]);
-            
-            if (j < bsize/sizeof(b[0]) - 1)
-            {
-                printf(", ");
-            }
-            else
-            {
-                printf("] \033[1;31m(Array Length: %d)\n\033[0m", bsize/sizeof(b[0]));
-            }
+            printf("\tp%-6g %14.3fus\n", percentiles[i], unit_test_histogram_percentile(totals, percentiles[i]) / 1e3);
         }
-        printf("\n\033[0m");
-        
-    }    
+    }
+    free(totals);
 }
 
 /*
-*   This function takes two longs and determines if they both contain the same
-*   value.
+*   This function tests that a percentile of the values recorded in a
+*   histogram is at most a limit, such as that 99% of calls took no more
+*   than 250 microseconds. The percentile is read as the highest value in
+*   its bucket, so it can be up to 1% above the true value, never below.
 *
-*   @param *test - the unit_test you wish to use to track the results. 
-*   @param a - the first long array you are comparing
-*   @param b - the second long array you are comparing
+*   @param *test - the unit_test you wish to use to track the results.
 *   @param *fname - file name. Use the macro __FILE_ for this field.
 *   @param lineno - line number. Use the macro __LINE__ for this field.
-*   @param asize - the size of array a.
-*   @param bsize - the size of array b.
+*   @param *histogram - the histogram.
+*   @param percentile - the percentile to check, from 0 to 100, such as
+*       99 or 99.9.
+*   @param max_microseconds - the most that percentile may be.
 *
 *   @author Brennan Hurst
-*   @version 10/09/2021
+*   @version 10/18/2026
 */
-void unit_test_assert_long_array_equals(struct unit_test *test, const char *fname, int lineno, long *a, int asize, long *b, int bsize) {
-    assert(a != NULL);
-    assert(b != NULL);
+void unit_test_assert_percentile(struct unit_test *test, const char *fname, int lineno,
+    struct unit_test_histogram *histogram, double percentile, double max_microseconds) {
     assert(test != NULL);
     assert(fname != NULL);
-
-    printf("%d - \033[1;37m%s: \033[1;36mAssert Long Array Equals\033[0m:", 
-             test->num_passed + test->num_failed, test->name);
-    if (asize == bsize) {
-        int i = 0;
-        for (; i < asize/sizeof(a[0]); i++)
-        {
-            if (a[i] != b[i]) break;
-        }
-        if (i == (asize/sizeof(a[0])))
+    assert(histogram != NULL);
+    assert(percentile >= 0 && percentile <= 100);
+    struct unit_test_histogram_totals *totals = malloc(sizeof(struct unit_test_histogram_totals));
+    assert(totals != NULL);
+    unit_test_histogram_merge(histogram, totals);
+    long long value = unit_test_histogram_percentile(totals, percentile);
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_PERCENTILE, .passed = 0};
+    event.passed = totals->total > 0 && value <= max_microseconds * 1e3;
+    if (!event.passed)
+    {
+        struct unit_test_buffer out = {0};
+        if (totals->total == 0)
         {
-            test->num_passed++;
-            printf(" \033[1;32mPASSED\n\033[0m");
+            unit_test_buffer_printf(&out, "\tAssertion expected p%g of \033[1;31m%s\033[0m to be at most"
+                " \033[1;31m%.3fus\033[0m but nothing was recorded.\n", percentile, histogram->name,
+                max_microseconds);
         }
         else
         {
-            test->num_failed++;
-            printf(" \033[1;31mFAILED\n\033[0m");
-            printf("\n\t\033[1;37mExpanded Information:\n");
-            printf("\t\033[1;36mAssert Long Array Equals \033[1;31mFailed\033[0m"
-                " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-            printf("\tAssertion expected:\n");
-            printf("\t\033[1;32m[");
-            for (int j = 0; j < asize/sizeof(a[0]); j++)
-            {
-                printf("%ldL", a[j]);
-                if (j < asize/sizeof(a[0]) - 1)
-                {
-                    printf(", ");
-                }
-                else
-                {
-                    printf("]\n\033[0m");
-                }
-            }
-            printf("\tbut got:\n");
-            printf("\t\033[1;32m[");
-            for (int j = 0; j < bsize/sizeof(b[0]); j++)
-            {
-                if (j == i)
-                {
-                   printf("\033[1;31m%ldL\033[0m", b[j]); 
-                }
-                else
-                {
-                    printf("\033[1;32m%ldL", b[j]);
-                }
-                if (j < bsize/sizeof(b[0]) - 1)
-                {
-                    printf(", ");
-                }
-                else
-                {
-                    printf("]\n\033[0m");
-                }
-            }
-            printf("\n\033[0m");
+            unit_test_buffer_printf(&out, "\tAssertion expected p%g of \033[1;31m%s\033[0m to be at most"
+                " \033[1;31m%.3fus\033[0m but it was \033[1;31m%.3fus\033[0m over %lld calls"
+                " (max %.3fus).\n", percentile, histogram->name, max_microseconds, value / 1e3,
+                totals->total, totals->max / 1e3);
         }
+        event.detail = unit_test_buffer_detach(&out);
     }
-    else
+    free(totals);
+    unit_test_report(&event);
+}
+
+/*
+*   Reads from a stream made by unit_test_stream_file.
+*/
+static long long unit_test_stream_read_file(void *source, void *buffer, size_t size) {
+    FILE *file = source;
+    size_t got = fread(buffer, 1, size, file);
+    if (got == 0 && ferror(file))
     {
-        test->num_failed++;
-        printf(" \033[1;31mFAILED\n\033[0m");
-        printf("\n\t\033[1;37mExpanded Information:\n");
-        printf("\t\033[1;36mAssert Long Array Equals \033[1;31mFailed\033[0m"
-            " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-        printf("\n\t\033[1;31mLong arrays are of uneven length.\033[0m\n\n");
-        printf("\tAssertion expected:\n");
-        printf("\t\033[1;32m[");
-        for (int j = 0; j < asize/sizeof(a[0]); j++)
+        return -1;
+    }
+    return (long long) got;
+}
+
+/*
+*   Reads from a stream made by unit_test_stream_fd. The descriptor is kept
+*   in the source pointer itself.
+*/
+static long long unit_test_stream_read_fd(void *source, void *buffer, size_t size) {
+    int fd = (int) (intptr_t) source;
+    ssize_t got;
+    do
+    {
+        got = read(fd, buffer, size);
+    } while (got < 0 && errno == EINTR);
+    return got;
+}
+
+/*
+*   This function makes a stream which reads from an open FILE, for
+*   unit_test_assert_stream_equals. The FILE is read from its current
+*   position and is not closed.
+*
+*   @param *name - name of the stream, printed by failed assertions.
+*   @param *file - the FILE to read.
+*
+*   @return the stream.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_stream unit_test_stream_file(const char *name, FILE *file) {
+    assert(file != NULL);
+    struct unit_test_stream stream = {name, &unit_test_stream_read_file, file};
+    return stream;
+}
+
+/*
+*   This function makes a stream which reads from a file descriptor, such
+*   as a file, pipe or socket, for unit_test_assert_stream_equals. The
+*   descriptor is read from its current position and is not closed.
+*
+*   @param *name - name of the stream, printed by failed assertions.
+*   @param fd - the file descriptor to read.
+*
+*   @return the stream.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_stream unit_test_stream_fd(const char *name, int fd) {
+    assert(fd >= 0);
+    struct unit_test_stream stream = {name, &unit_test_stream_read_fd, (void *) (intptr_t) fd};
+    return stream;
+}
+
+/*
+*   This function makes a stream whose bytes come from a function, for
+*   unit_test_assert_stream_equals. It lets output be checked as it is
+*   produced, without writing it anywhere first.
+*
+*   @param *name - name of the stream, printed by failed assertions.
+*   @param *read - fills buffer with up to size bytes and returns how many
+*       it wrote, 0 at the end of the stream, or -1 with errno set if it
+*       failed. It is called from a thread of its own.
+*   @param *source - passed to read.
+*
+*   @return the stream.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+struct unit_test_stream unit_test_stream_callback(const char *name,
+    long long (*read)(void *source, void *buffer, size_t size), void *source) {
+    assert(read != NULL);
+    struct unit_test_stream stream = {name, read, source};
+    return stream;
+}
+
+/*
+*   One side of a streaming comparison. A reader thread fills the two
+*   buffers in turn while the other is being compared, so reading the next
+*   chunk overlaps comparing this one. Each chunk is filled completely
+*   unless the stream ends, so chunk n of both sides covers the same bytes.
+*   ready[i] is set by the reader once buffer i holds a chunk, and cleared
+*   by the comparison once it is done with it.
+*/
+struct unit_test_stream_side {
+    struct unit_test_stream *stream;
+    struct unit_test_stream_compare *compare;
+    char *buffers[2];
+    size_t lengths[2];
+    int ready[2];
+    int errors[2];
+    pthread_t thread;
+};
+
+struct unit_test_stream_compare {
+    size_t chunk;
+    int stop;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    struct unit_test_stream_side sides[2];
+};
+
+static void *unit_test_stream_reader(void *arg) {
+    struct unit_test_stream_side *side = arg;
+    struct unit_test_stream_compare *compare = side->compare;
+    for (int b = 0; ; b ^= 1)
+    {
+        pthread_mutex_lock(&compare->lock);
+        while (side->ready[b] && !compare->stop)
         {
-            printf("%ldL", a[j]);
-            if (j < asize/sizeof(a[0]) - 1)
-            {
-                printf(", ");
-            }
-            else
-            {
-                printf("] (Array Length: %d)\n\033[0m", asize/sizeof(a[0]));
-            }
+            pthread_cond_wait(&compare->wake, &compare->lock);
         }
-        printf("\tbut got:\n");
-        printf("\t\033\033[1;31m[");
-        for (int j = 0; j < bsize/sizeof(b[0]); j++)
+        int stop = compare->stop;
+        pthread_mutex_unlock(&compare->lock);
+        if (stop)
         {
-            printf("%ldL", b[j]);
-            
-            if (j < bsize/sizeof(b[0]) - 1)
-            {
-                printf(", ");
-            }
-            else
+            break;
+        }
+
+        size_t length = 0;
+        int error = 0;
+        while (length < compare->chunk)
+        {
+            long long got = side->stream->read(side->stream->source, side->buffers[b] + length,
+                compare->chunk - length);
+            if (got <= 0)
             {
-                printf("] \033[1;31m(Array Length: %d)\n\033[0m", bsize/sizeof(b[0]));
+                error = got < 0 ? (errno != 0 ? errno : EIO) : 0;
+                break;
             }
+            length += got;
         }
-        printf("\n\033[0m");
-        
-    }    
+
+        pthread_mutex_lock(&compare->lock);
+        side->lengths[b] = length;
+        side->errors[b] = error;
+        side->ready[b] = 1;
+        pthread_cond_broadcast(&compare->wake);
+        pthread_mutex_unlock(&compare->lock);
+        if (length < compare->chunk)
+        {
+            break;
+        }
+    }
+    return NULL;
 }
 
 /*
-*   This function takes two chars and determines if they both contain the same
-*   value.
+*   Formats up to 16 bytes of a chunk from offset as hex, the first of them
+*   in red.
+*/
+static void unit_test_stream_format_bytes(struct unit_test_buffer *out, const char *bytes, size_t offset,
+    size_t length) {
+    if (offset >= length)
+    {
+        unit_test_buffer_printf(out, "(end of stream)");
+        return;
+    }
+    for (size_t i = offset; i < length && i < offset + 16; i++)
+    {
+        unit_test_buffer_printf(out, i == offset ? "\033[1;31m%02x\033[0m " : "%02x ", (unsigned char) bytes[i]);
+    }
+}
+
+/*
+*   This function tests that two streams hold the same bytes, reading them
+*   a chunk at a time so that streams far larger than memory can be
+*   compared. Each stream is read by a thread of its own into two buffers
+*   of chunk bytes, so the next chunk is read while the last is compared,
+*   and at most four chunks are held in memory at once. A failure gives the
+*   offset of the first byte that differs, or at which one stream ended,
+*   and the bytes around it. The number of bytes compared and how fast is
+*   printed in the test's summary.
 *
-*   @param *test - the unit_test you wish to use to track the results. 
-*   @param a - the first char array you are comparing
-*   @param b - the second char array you are comparing
+*   @param *test - the unit_test you wish to use to track the results.
 *   @param *fname - file name. Use the macro __FILE_ for this field.
 *   @param lineno - line number. Use the macro __LINE__ for this field.
-*   @param asize - the size of array a.
-*   @param bsize - the size of array b.
+*   @param *expected - the stream holding the expected bytes.
+*   @param *actual - the stream to check.
+*   @param chunk - bytes per read, or 0 for 1 MiB.
 *
 *   @author Brennan Hurst
-*   @version 10/09/2021
+*   @version 10/18/2026
 */
-void unit_test_assert_char_array_equals(struct unit_test *test, const char *fname, int lineno, char *a, int asize, char *b, int bsize) {
-    assert(a != NULL);
-    assert(b != NULL);
+void unit_test_assert_stream_equals(struct unit_test *test, const char *fname, int lineno,
+    struct unit_test_stream *expected, struct unit_test_stream *actual, size_t chunk) {
     assert(test != NULL);
     assert(fname != NULL);
+    assert(expected != NULL && expected->read != NULL);
+    assert(actual != NULL && actual->read != NULL);
+    struct unit_test_stream_compare compare = {0};
+    compare.chunk = chunk > 0 ? chunk : UNIT_TEST_STREAM_CHUNK;
+    pthread_mutex_init(&compare.lock, NULL);
+    pthread_cond_init(&compare.wake, NULL);
+    struct unit_test_stream *streams[2] = {expected, actual};
+    for (int s = 0; s < 2; s++)
+    {
+        struct unit_test_stream_side *side = &compare.sides[s];
+        side->stream = streams[s];
+        side->compare = &compare;
+        side->buffers[0] = malloc(compare.chunk);
+        side->buffers[1] = malloc(compare.chunk);
+        assert(side->buffers[0] != NULL && side->buffers[1] != NULL);
+    }
+    double started = unit_test_now();
+    for (int s = 0; s < 2; s++)
+    {
+        int created = pthread_create(&compare.sides[s].thread, NULL, &unit_test_stream_reader, &compare.sides[s]);
+        assert(created == 0);
+    }
 
-    printf("%d - \033[1;37m%s: \033[1;36mAssert Char Array Equals\033[0m:", 
-             test->num_passed + test->num_failed, test->name);
-    if (asize == bsize) {
-        int i = 0;
-        for (; i < asize/sizeof(a[0]); i++)
+    struct unit_test_stream_side *a = &compare.sides[0];
+    struct unit_test_stream_side *b = &compare.sides[1];
+    struct unit_test_event event = {.test = test, .fname = fname, .lineno = lineno,
+        .kind = UNIT_TEST_KIND_STREAM, .passed = 0};
+    struct unit_test_buffer out = {0};
+    unsigned long long compared = 0;
+    for (int i = 0; ; i ^= 1)
+    {
+        pthread_mutex_lock(&compare.lock);
+        while (!a->ready[i] || !b->ready[i])
         {
-            if (a[i] != b[i]) break;
+            pthread_cond_wait(&compare.wake, &compare.lock);
         }
-        if (i == (asize/sizeof(a[0])))
+        pthread_mutex_unlock(&compare.lock);
+
+        size_t alength = a->lengths[i];
+        size_t blength = b->lengths[i];
+        size_t length = alength < blength ? alength : blength;
+        size_t at = length;
+        if (memcmp(a->buffers[i], b->buffers[i], length) != 0)
         {
-            test->num_passed++;
-            printf(" \033[1;32mPASSED\n\033[0m");
+            at = unit_test_array_mismatch(UNIT_TEST_KIND_CHAR, a->buffers[i], b->buffers[i], length);
         }
-        else
+        if (a->errors[i] != 0 || b->errors[i] != 0)
         {
-            test->num_failed++;
-            printf(" \033[1;31mFAILED\n\033[0m");
-            printf("\n\t\033[1;37mExpanded Information:\n");
-            printf("\t\033[1;36mAssert Char Array Equals \033[1;31mFailed\033[0m"
-                " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-            printf("\tAssertion expected:\n");
-            printf("\t\033[1;32m[");
-            for (int j = 0; j < asize/sizeof(a[0]); j++)
-            {
-                printf("'%c'", a[j]);
-                if (j < asize/sizeof(a[0]) - 1)
-                {
-                    printf(", ");
-                }
-                else
-                {
-                    printf("]\n\033[0m");
-                }
-            }
-            printf("\tbut got:\n");
-            printf("\t\033[1;32m[");
-            for (int j = 0; j < bsize/sizeof(b[0]); j++)
-            {
-                if (j == i)
-                {
-                   printf("\033[1;31m'%c'\033[0m", b[j]); 
-                }
-                else
-                {
-                    printf("\033[1;32m'%c'", b[j]);
-                }
-                if (j < bsize/sizeof(b[0]) - 1)
-                {
-                    printf(", ");
-                }
-                else
-                {
-                    printf("]\n\033[0m");
-                }
-            }
-            printf("\n\033[0m");
+            struct unit_test_stream_side *side = a->errors[i] != 0 ? a : b;
+            unit_test_buffer_printf(&out, "\tCould not read stream \033[1;31m%s\033[0m after"
+                " \033[1;31m%llu\033[0m bytes: %s.\n", side->stream->name, compared + side->lengths[i],
+                strerror(side->errors[i]));
+            compared += at;
+            break;
         }
-    }
-    else
-    {
-        test->num_failed++;
-        printf(" \033[1;31mFAILED\n\033[0m");
-        printf("\n\t\033[1;37mExpanded Information:\n");
-        printf("\t\033[1;36mAssert Char Array Equals \033[1;31mFailed\033[0m"
-            " in file \033[1;31m%s\033[0m at line \033[1;31m%d\033[0m.\n", fname, lineno);
-        printf("\n\t\033[1;31mChar arrays are of uneven length.\033[0m\n\n");
-        printf("\tAssertion expected:\n");
-        printf("\t\033[1;32m[");
-        for (int j = 0; j < asize/sizeof(a[0]); j++)
+        if (at < length || alength != blength)
         {
-            printf("'%c'", a[j]);
-            if (j < asize/sizeof(a[0]) - 1)
+            unit_test_buffer_printf(&out, "\tAssertion expected stream \033[1;31m%s\033[0m to equal"
+                " \033[1;31m%s\033[0m but they differ at offset \033[1;31m%llu\033[0m", actual->name,
+                expected->name, compared + at);
+            if (at == length)
             {
-                printf(", ");
-            }
-            else
-            {
-                printf("] (Array Length: %d)\n\033[0m", asize/sizeof(a[0]));
+                unit_test_buffer_printf(&out, ", where \033[1;31m%s\033[0m ends",
+                    alength < blength ? expected->name : actual->name);
             }
+            unit_test_buffer_printf(&out, ".\n\tExpected: ");
+            unit_test_stream_format_bytes(&out, a->buffers[i], at, alength);
+            unit_test_buffer_printf(&out, "\n\tActual:   ");
+            unit_test_stream_format_bytes(&out, b->buffers[i], at, blength);
+            unit_test_buffer_printf(&out, "\n");
+            compared += at;
+            break;
         }
-        printf("\tbut got:\n");
-        printf("\t\033\033[1;31m[");
-        for (int j = 0; j < bsize/sizeof(b[0]); j++)
+        compared += length;
+        if (length < compare.chunk)
         {
-            printf("'%c'", b[j]);
-            
-            if (j < bsize/sizeof(b[0]) - 1)
-            {
-                printf(", ");
-            }
-            else
-            {
-                printf("] \033[1;31m(Array Length: %d)\n\033[0m", bsize/sizeof(b[0]));
-            }
+            event.passed = 1;
+            break;
         }
-        printf("\n\033[0m");
-        
-    }    
+
+        pthread_mutex_lock(&compare.lock);
+        a->ready[i] = 0;
+        b->ready[i] = 0;
+        pthread_cond_broadcast(&compare.wake);
+        pthread_mutex_unlock(&compare.lock);
+    }
+
+    pthread_mutex_lock(&compare.lock);
+    compare.stop = 1;
+    pthread_cond_broadcast(&compare.wake);
+    pthread_mutex_unlock(&compare.lock);
+    for (int s = 0; s < 2; s++)
+    {
+        pthread_join(compare.sides[s].thread, NULL);
+        free(compare.sides[s].buffers[0]);
+        free(compare.sides[s].buffers[1]);
+    }
+    pthread_mutex_destroy(&compare.lock);
+    pthread_cond_destroy(&compare.wake);
+
+    struct unit_test_stream_result *result = calloc(1, sizeof(struct unit_test_stream_result));
+    assert(result != NULL);
+    result->expected = expected->name;
+    result->actual = actual->name;
+    result->bytes = compared;
+    result->seconds = unit_test_now() - started;
+    struct unit_test_stream_result **tail = &test->streams;
+    while (*tail != NULL)
+    {
+        tail = &(*tail)->next;
+    }
+    *tail = result;
+
+    if (!event.passed)
+    {
+        unit_test_buffer_printf(&out, "\tCompared \033[1;31m%llu\033[0m bytes.\n", compared);
+        event.detail = unit_test_buffer_detach(&out);
+    }
+    free(out.data);
+    unit_test_report(&event);
 }
@@ -0,0 +1,77 @@
+#include "../include/unit_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+*   Runs the tests in any number of test modules in one process. Each
+*   argument which is not an option is a shared object, or a directory of
+*   them, to load with unit_test_load_plugin; options are those understood
+*   by unit_test_parse_args. Every loaded test is run with
+*   unit_test_run_all and reported in a single total summary.
+*
+*       unit_test_runner [--jobs=N] [--history=FILE] ... MODULE.so|DIRECTORY...
+*
+*   With --watch=DIRS it keeps running, and reloads each module and reruns
+*   the affected tests whenever the module is rebuilt.
+*
+*   The exit status is 0 if every test passed, 1 if any failed, and 2 if
+*   the arguments were wrong or a module could not be loaded.
+*
+*   @author Brennan Hurst
+*   @version 10/18/2026
+*/
+int main(int argc, char **argv)
+{
+    char **options = calloc(argc + 1, sizeof(char *));
+    if (options == NULL)
+    {
+        return 2;
+    }
+    int option_count = 1;
+    int module_count = 0;
+    int status = 0;
+    options[0] = argv[0];
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--", 2) == 0)
+        {
+            options[option_count++] = argv[i];
+        }
+        else
+        {
+            module_count++;
+            if (unit_test_load_plugin(argv[i]) < 0)
+            {
+                status = 2;
+            }
+        }
+    }
+
+    struct unit_test_run run = {0};
+    if (unit_test_parse_args(option_count, options, &run) != 0 || module_count == 0)
+    {
+        fprintf(stderr, "usage: %s [options] MODULE.so|DIRECTORY...\n", argv[0]);
+        free(options);
+        return 2;
+    }
+    free(options);
+    printf("Loaded %d tests from %d modules.\n\n", test_count, module_count);
+
+    if (run.watch != NULL)
+    {
+        unit_test_watch(&run);
+        return 2;
+    }
+    unit_test_run_all(&run);
+    unit_test_print_total_summary();
+    for (int i = 0; i < test_count && status == 0; i++)
+    {
+        if (tests[i]->num_failed > 0 || tests[i]->status == UNIT_TEST_STATUS_FAILED
+            || tests[i]->status == UNIT_TEST_STATUS_ABORTED || tests[i]->status == UNIT_TEST_STATUS_CRASHED)
+        {
+            status = 1;
+        }
+    }
+    return status;
+}
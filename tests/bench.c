@@ -0,0 +1,224 @@
+#include "../include/unit_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+/*
+*   Measures the overhead of the library itself: how many passing
+*   assertions of each type it can record per second, how fast it compares
+*   arrays, what reporting a failure costs, how long recording a latency
+*   takes, and how fast tests can be registered. Run it with `make bench`
+*   before and after changing the library to see what the change cost.
+*/
+
+#define BENCH_ASSERTIONS 2000000
+#define BENCH_FAILURES 20000
+#define BENCH_REGISTRATIONS 200000
+#define BENCH_RECORDINGS 20000000
+#define BENCH_ARRAY_LENGTH (1 << 20)
+#define BENCH_ARRAY_PASSES 200
+
+static double bench_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void bench_print(const char *name, double value, const char *unit) {
+    printf("%-36s %14.2f %s\n", name, value, unit);
+}
+
+/*
+*   Results are printed as they happen, so standard output is sent to
+*   /dev/null while printing assertions are measured.
+*/
+static int bench_silence() {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    close(null);
+    return saved;
+}
+
+static void bench_restore(int saved) {
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+/*
+*   Passing assertions are measured in bulk mode, where they are only
+*   counted, apart from one run which prints each result as usual.
+*/
+static void bench_scalars(struct unit_test *test) {
+    int saved = bench_silence();
+    double started = bench_now();
+    for (int i = 0; i < BENCH_ASSERTIONS; i++)
+    {
+        unit_test_assert_int_equals(test, __FILE__, __LINE__, i, i);
+    }
+    double printed = BENCH_ASSERTIONS / (bench_now() - started) / 1e6;
+    bench_restore(saved);
+    bench_print("int equals (printed)", printed, "M assertions/sec");
+
+    unit_test_set_bulk_mode(3);
+    started = bench_now();
+    for (int i = 0; i < BENCH_ASSERTIONS; i++)
+    {
+        unit_test_assert_int_equals(test, __FILE__, __LINE__, i, i);
+    }
+    bench_print("int equals", BENCH_ASSERTIONS / (bench_now() - started) / 1e6, "M assertions/sec");
+
+    started = bench_now();
+    for (long i = 0; i < BENCH_ASSERTIONS; i++)
+    {
+        unit_test_assert_long_equals(test, __FILE__, __LINE__, i, i);
+    }
+    bench_print("long equals", BENCH_ASSERTIONS / (bench_now() - started) / 1e6, "M assertions/sec");
+
+    started = bench_now();
+    for (int i = 0; i < BENCH_ASSERTIONS; i++)
+    {
+        unit_test_assert_char_equals(test, __FILE__, __LINE__, (char) i, (char) i);
+    }
+    bench_print("char equals", BENCH_ASSERTIONS / (bench_now() - started) / 1e6, "M assertions/sec");
+
+    started = bench_now();
+    for (int i = 0; i < BENCH_ASSERTIONS; i++)
+    {
+        unit_test_assert_float_equals(test, __FILE__, __LINE__, (float) i, (float) i);
+    }
+    bench_print("float equals", BENCH_ASSERTIONS / (bench_now() - started) / 1e6, "M assertions/sec");
+
+    started = bench_now();
+    for (int i = 0; i < BENCH_ASSERTIONS; i++)
+    {
+        unit_test_assert_double_equals(test, __FILE__, __LINE__, (double) i, (double) i);
+    }
+    bench_print("double equals", BENCH_ASSERTIONS / (bench_now() - started) / 1e6, "M assertions/sec");
+
+    started = bench_now();
+    for (int i = 0; i < BENCH_ASSERTIONS; i++)
+    {
+        unit_test_assert_same_address(test, __FILE__, __LINE__, test, test);
+    }
+    bench_print("same address", BENCH_ASSERTIONS / (bench_now() - started) / 1e6, "M assertions/sec");
+
+    started = bench_now();
+    for (int i = 0; i < BENCH_ASSERTIONS; i++)
+    {
+        unit_test_assert_string_equals(test, __FILE__, __LINE__, "unit_test", "unit_test");
+    }
+    bench_print("string equals", BENCH_ASSERTIONS / (bench_now() - started) / 1e6, "M assertions/sec");
+    unit_test_set_bulk_mode(0);
+}
+
+static void bench_arrays(struct unit_test *test) {
+    unit_test_set_bulk_mode(3);
+    int *ints = calloc(BENCH_ARRAY_LENGTH, sizeof(int));
+    int *other_ints = calloc(BENCH_ARRAY_LENGTH, sizeof(int));
+    double *doubles = calloc(BENCH_ARRAY_LENGTH, sizeof(double));
+    double *other_doubles = calloc(BENCH_ARRAY_LENGTH, sizeof(double));
+    char *chars = calloc(BENCH_ARRAY_LENGTH, sizeof(char));
+    char *other_chars = calloc(BENCH_ARRAY_LENGTH, sizeof(char));
+    if (ints == NULL || other_ints == NULL || doubles == NULL || other_doubles == NULL
+        || chars == NULL || other_chars == NULL)
+    {
+        fprintf(stderr, "bench: out of memory\n");
+        exit(1);
+    }
+    int size = BENCH_ARRAY_LENGTH * sizeof(int);
+    double started = bench_now();
+    for (int i = 0; i < BENCH_ARRAY_PASSES; i++)
+    {
+        unit_test_assert_int_array_equals(test, __FILE__, __LINE__, ints, size, other_ints, size);
+    }
+    bench_print("int array compare", (double) size * BENCH_ARRAY_PASSES / (bench_now() - started) / 1e9,
+        "GB/s per array");
+
+    size = BENCH_ARRAY_LENGTH * sizeof(double);
+    started = bench_now();
+    for (int i = 0; i < BENCH_ARRAY_PASSES; i++)
+    {
+        unit_test_assert_double_array_equals(test, __FILE__, __LINE__, doubles, size, other_doubles, size);
+    }
+    bench_print("double array compare", (double) size * BENCH_ARRAY_PASSES / (bench_now() - started) / 1e9,
+        "GB/s per array");
+
+    size = BENCH_ARRAY_LENGTH * sizeof(char);
+    started = bench_now();
+    for (int i = 0; i < BENCH_ARRAY_PASSES; i++)
+    {
+        unit_test_assert_char_array_equals(test, __FILE__, __LINE__, chars, size, other_chars, size);
+    }
+    bench_print("char array compare", (double) size * BENCH_ARRAY_PASSES / (bench_now() - started) / 1e9,
+        "GB/s per array");
+    free(ints);
+    free(other_ints);
+    free(doubles);
+    free(other_doubles);
+    free(chars);
+    free(other_chars);
+    unit_test_set_bulk_mode(0);
+}
+
+static void bench_failures(struct unit_test *test) {
+    int saved = bench_silence();
+
+    double started = bench_now();
+    for (int i = 0; i < BENCH_FAILURES; i++)
+    {
+        unit_test_assert_int_equals(test, __FILE__, __LINE__, i, i + 1);
+    }
+    double scalar = (bench_now() - started) / BENCH_FAILURES;
+
+    int expected[16] = {0};
+    int actual[16] = {0};
+    actual[15] = 1;
+    started = bench_now();
+    for (int i = 0; i < BENCH_FAILURES; i++)
+    {
+        unit_test_assert_int_array_equals(test, __FILE__, __LINE__, expected, sizeof(expected),
+            actual, sizeof(actual));
+    }
+    double array = (bench_now() - started) / BENCH_FAILURES;
+    bench_restore(saved);
+    bench_print("int equals failure report", scalar * 1e6, "us/failure");
+    bench_print("int array failure report (16)", array * 1e6, "us/failure");
+}
+
+static void bench_histogram(struct unit_test *test) {
+    struct unit_test_histogram *histogram = unit_test_histogram_init(test, "bench");
+    double started = bench_now();
+    for (long long i = 0; i < BENCH_RECORDINGS; i++)
+    {
+        unit_test_histogram_record(histogram, i & 0xfffff);
+    }
+    bench_print("histogram record", (bench_now() - started) / BENCH_RECORDINGS * 1e9, "ns/record");
+}
+
+static void bench_registration() {
+    double started = bench_now();
+    for (int i = 0; i < BENCH_REGISTRATIONS; i++)
+    {
+        unit_test_init("bench registration");
+    }
+    bench_print("unit_test_init", BENCH_REGISTRATIONS / (bench_now() - started) / 1e6, "M tests/sec");
+}
+
+int main()
+{
+    struct unit_test *test = unit_test_init("Bench");
+    printf("\033[1;37m================== Library Overhead ==================\033[0m\n");
+    bench_scalars(test);
+    bench_arrays(test);
+    bench_failures(test);
+    bench_histogram(test);
+    bench_registration();
+    printf("\033[1;37m======================================================\033[0m\n");
+    return 0;
+}
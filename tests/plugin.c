@@ -0,0 +1,23 @@
+#include "../include/unit_test.h"
+
+/*
+*   An example test module for unit_test_runner. It is built as a shared
+*   object and leaves the library's functions to the runner.
+*/
+
+void test_plugin_arithmetic(struct unit_test *test)
+{
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 4, 2 + 2);
+    unit_test_assert_long_equals(test, __FILE__, __LINE__, 1L << 40, 1099511627776L);
+}
+
+void test_plugin_strings(struct unit_test *test)
+{
+    unit_test_assert_string_prefix(test, __FILE__, __LINE__, "unit_test", "unit_test_runner");
+}
+
+void unit_test_plugin()
+{
+    unit_test_register("Test Plugin Arithmetic", &test_plugin_arithmetic, NULL);
+    unit_test_register("Test Plugin Strings", &test_plugin_strings, NULL);
+}
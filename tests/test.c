@@ -1,5 +1,43 @@
 #include "../src/unit_test.c"
 
+/*
+*   Runs body in a child process with its standard output captured, so
+*   that tests which fail on purpose stay out of this program's results.
+*   Returns the output, which the caller frees.
+*/
+char *capture_output(void (*body)(void *arg), void *arg)
+{
+    FILE *output = tmpfile();
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0)
+    {
+        dup2(fileno(output), STDOUT_FILENO);
+        body(arg);
+        fflush(stdout);
+        _exit(0);
+    }
+    waitpid(child, NULL, 0);
+    off_t length = lseek(fileno(output), 0, SEEK_END);
+    char *text = calloc(length + 1, 1);
+    if (pread(fileno(output), text, length, 0) != length)
+    {
+        text[0] = '\0';
+    }
+    fclose(output);
+    return text;
+}
+
+int count_occurrences(const char *text, const char *needle)
+{
+    int count = 0;
+    for (const char *at = strstr(text, needle); at != NULL; at = strstr(at + 1, needle))
+    {
+        count++;
+    }
+    return count;
+}
+
 void test_unit_test_start(struct unit_test *test)
 {
     int a = 0;
@@ -36,6 +74,545 @@ void test_unit_test_arrays(struct unit_test *test)
     unit_test_assert_char_array_equals(test, __FILE__, __LINE__, chararray1, sizeof(chararray1), chararray2, sizeof(chararray2));
 }
 
+void *test_unit_test_threads_worker(void *arg)
+{
+    struct unit_test *test = arg;
+    for (int i = 0; i < 1000; i++)
+    {
+        unit_test_assert_int_equals(test, __FILE__, __LINE__, i, i);
+    }
+    return NULL;
+}
+
+void test_unit_test_threads(struct unit_test *test)
+{
+    struct unit_test *shared = unit_test_init("Test Threaded Assertions");
+    pthread_t threads[8];
+    for (int i = 0; i < 8; i++)
+    {
+        pthread_create(&threads[i], NULL, &test_unit_test_threads_worker, shared);
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    unit_test_merge(shared);
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 8000, shared->num_passed);
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 0, shared->num_failed);
+}
+
+long stress_counter = 0;
+
+void test_unit_test_stress_body(struct unit_test *test, int thread, long iteration)
+{
+    __atomic_add_fetch(&stress_counter, 1, __ATOMIC_RELAXED);
+}
+
+void test_unit_test_stress(struct unit_test *test)
+{
+    struct unit_test_stress options = {4, 10000, 0, 0, 1};
+    unit_test_stress(test, &test_unit_test_stress_body, &options);
+    unit_test_assert_long_equals(test, __FILE__, __LINE__, 40000L, stress_counter);
+    unit_test_assert_long_equals(test, __FILE__, __LINE__, 40000L, (long) test->stress->operations);
+}
+
+int fixture_builds = 0;
+struct unit_test_fixture *shared_fixture;
+
+void *test_unit_test_fixture_setup()
+{
+    fixture_builds++;
+    int *data = malloc(sizeof(int));
+    *data = 42;
+    return data;
+}
+
+void test_unit_test_fixture_teardown(void *data)
+{
+    free(data);
+}
+
+void test_unit_test_fixture(struct unit_test *test)
+{
+    int *data = unit_test_fixture_get(test, shared_fixture);
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 42, *data);
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 1, fixture_builds);
+}
+
+struct unit_test_fixture *snapshot_fixture;
+
+void test_unit_test_snapshot_build(void *base, size_t size)
+{
+    memset(base, 'a', size);
+}
+
+void test_unit_test_forked(struct unit_test *test)
+{
+    char *data = unit_test_fixture_get(test, snapshot_fixture);
+    unit_test_assert_char_equals(test, __FILE__, __LINE__, 'a', data[0]);
+    //each child writes to its copy, which the next child must not see
+    data[0] = 'b';
+    unit_test_assert_char_equals(test, __FILE__, __LINE__, 'b', data[0]);
+}
+
+void test_unit_test_async(struct unit_test *test)
+{
+    for (int i = 0; i < 100; i++)
+    {
+        unit_test_assert_int_equals(test, __FILE__, __LINE__, i, i);
+    }
+}
+
+void test_unit_test_bulk(struct unit_test *test)
+{
+    int data[100000];
+    for (int i = 0; i < 100000; i++)
+    {
+        data[i] = i;
+    }
+    for (int i = 0; i < 100000; i++)
+    {
+        unit_test_assert_int_equals(test, __FILE__, __LINE__, i, data[i]);
+    }
+}
+
+void test_unit_test_death_abort(void *arg)
+{
+    int *value = arg;
+    assert(*value >= 0);
+}
+
+void test_unit_test_death_exit(void *arg)
+{
+    fprintf(stderr, "invalid input: %s\n", (char *) arg);
+    exit(3);
+}
+
+void test_unit_test_death(struct unit_test *test)
+{
+    int value = -1;
+    unit_test_assert_death(test, __FILE__, __LINE__, &test_unit_test_death_abort, &value, sizeof(value),
+        SIGABRT, "Assertion");
+    unit_test_assert_exit_code(test, __FILE__, __LINE__, &test_unit_test_death_exit, "abc", 4,
+        3, "invalid input: abc");
+    value = 1;
+    unit_test_assert_exit_code(test, __FILE__, __LINE__, &test_unit_test_death_abort, &value, sizeof(value),
+        0, NULL);
+}
+
+void test_unit_test_crash_start(struct unit_test *test)
+{
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 1, 1);
+    *(volatile int *) NULL = 1;
+}
+
+void test_unit_test_crash_body(void *arg)
+{
+    //run in a death test child so that the crashed suite stays out of the results
+    freopen("/dev/null", "w", stdout);
+    unit_test_set_crash_recovery(1);
+    struct unit_test *crashed = unit_test_init("Test Crashed Suite");
+    unit_test_start(crashed, &test_unit_test_crash_start, NULL);
+    exit(crashed->status == UNIT_TEST_STATUS_CRASHED && crashed->num_failed == 1 ? 7 : 1);
+}
+
+void test_unit_test_crash(struct unit_test *test)
+{
+    unit_test_assert_exit_code(test, __FILE__, __LINE__, &test_unit_test_crash_body, NULL, 0, 7, NULL);
+}
+
+void test_unit_test_unordered(struct unit_test *test)
+{
+    int expected[1000];
+    int actual[1000];
+    for (int i = 0; i < 1000; i++)
+    {
+        expected[i] = i % 100 - 50;
+        actual[999 - i] = expected[i];
+    }
+    unit_test_assert_int_array_unordered_equals(test, __FILE__, __LINE__, expected, sizeof(expected),
+        actual, sizeof(actual));
+    unit_test_assert_int_array_subset(test, __FILE__, __LINE__, expected, sizeof(expected) / 2,
+        actual, sizeof(actual));
+
+    double doubles[4] = {-1.5, 0.0, 2.25, 1e10};
+    unit_test_assert_double_array_sorted(test, __FILE__, __LINE__, doubles, sizeof(doubles));
+
+    long indices[5] = {3, 0, 4, 1, 2};
+    unit_test_assert_long_array_permutation(test, __FILE__, __LINE__, indices, sizeof(indices));
+}
+
+void test_unit_test_unordered_failures_body(void *arg)
+{
+    struct unit_test *test = unit_test_init("Unordered Failures");
+    int expected[5] = {1, 2, 2, 3, 4};
+    int actual[5] = {2, 3, 5, 5, 6};
+    unit_test_assert_int_array_unordered_equals(test, __FILE__, __LINE__, expected, sizeof(expected),
+        actual, sizeof(actual));
+    int many[15];
+    for (int i = 0; i < 15; i++)
+    {
+        many[i] = i;
+    }
+    unit_test_assert_int_array_unordered_equals(test, __FILE__, __LINE__, many, sizeof(many), many, 0);
+    int subset[2] = {2, 9};
+    unit_test_assert_int_array_subset(test, __FILE__, __LINE__, subset, sizeof(subset), actual, sizeof(actual));
+    int unsorted[5] = {1, 3, 2, 5, 4};
+    unit_test_assert_int_array_sorted(test, __FILE__, __LINE__, unsorted, sizeof(unsorted));
+    long indices[4] = {0, 2, 2, 7};
+    unit_test_assert_long_array_permutation(test, __FILE__, __LINE__, indices, sizeof(indices));
+    unit_test_merge(test);
+    printf("failed %lld of %lld\n", test->num_failed, test->num_failed + test->num_passed);
+}
+
+void test_unit_test_unordered_failures(struct unit_test *test)
+{
+    char *output = capture_output(&test_unit_test_unordered_failures_body, NULL);
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output, "failed 5 of 5");
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output,
+        "Missing \033[1;31m3\033[0m elements:\033[1;31m 1, 2, 4\033[0m");
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output,
+        "Extra \033[1;31m3\033[0m elements:\033[1;31m 5 (x2), 6\033[0m");
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output,
+        "Missing \033[1;31m15\033[0m elements:\033[1;31m 0, 1, 2, 3, 4, 5, 6, 7, 8, 9"
+        " and 5 more distinct values\033[0m");
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output,
+        "Missing \033[1;31m1\033[0m element:\033[1;31m 9\033[0m");
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output,
+        "element \033[1;31m2\033[0m (\033[1;31m2\033[0m) is less than the element before it"
+        " (\033[1;31m3\033[0m).\n\t\033[1;31m2\033[0m of \033[1;31m5\033[0m elements");
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output,
+        "from 0 to 3 exactly once, but element \033[1;31m2\033[0m is \033[1;31m2\033[0m.\n"
+        "\t\033[1;31m1\033[0m values were out of range, \033[1;31m1\033[0m were repeated and"
+        " \033[1;31m2\033[0m were missing.");
+    //the subset check only lists what is missing, so only the first check has extras
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 1, count_occurrences(output, "Extra "));
+    free(output);
+}
+
+void test_unit_test_strings(struct unit_test *test)
+{
+    char *query = malloc(64);
+    strcpy(query, "SELECT id FROM users WHERE id = 1");
+    unit_test_assert_string_equals(test, __FILE__, __LINE__, "SELECT id FROM users WHERE id = 1", query);
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, query, "FROM users");
+    unit_test_assert_string_prefix(test, __FILE__, __LINE__, "SELECT", query);
+    free(query);
+}
+
+void test_unit_test_string_failures_body(void *arg)
+{
+    struct unit_test *test = unit_test_init("String Failures");
+    unit_test_assert_string_equals(test, __FILE__, __LINE__,
+        "line one\nline two\nline three\nline four\nline five\nline six\nline seven\nline eight\nline nine\n",
+        "line one\nline two\nline three\nline four\nline five\nline six\nline seven\nline EIGHT\nline nine\n");
+    unit_test_assert_string_equals(test, __FILE__, __LINE__,
+        "SELECT id, name, email FROM users WHERE id = 1 AND active = 1 ORDER BY name",
+        "SELECT id, name, email FROM users WHERE id = 2 AND active = 1 ORDER BY name");
+    //every line differs, so the diff needs more edits than it is allowed
+    char *a = calloc(UNIT_TEST_DIFF_MAX_EDITS, 8);
+    char *b = calloc(UNIT_TEST_DIFF_MAX_EDITS, 8);
+    for (int i = 0, alength = 0, blength = 0; i < UNIT_TEST_DIFF_MAX_EDITS / 2 + 1; i++)
+    {
+        alength += sprintf(a + alength, "a%d\n", i);
+        blength += sprintf(b + blength, "b%d\n", i);
+    }
+    unit_test_assert_string_equals(test, __FILE__, __LINE__, a, b);
+    free(a);
+    free(b);
+}
+
+void test_unit_test_string_failures(struct unit_test *test)
+{
+    char *output = capture_output(&test_unit_test_string_failures_body, NULL);
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output,
+        "\t\033[1;36m@@ line 5 of the first string, line 5 of the second @@\033[0m\n"
+        "\t      5 | line five\033[0m\n"
+        "\t      6 | line six\033[0m\n"
+        "\t      7 | line seven\033[0m\n"
+        "\t\033[1;31m-     8 | line eight\033[0m\n"
+        "\t\033[1;32m+     8 | line EIGHT\033[0m\n"
+        "\t  line \033[1;31m[-eight-]\033[0m\033[1;32m{+EIGHT+}\033[0m\n"
+        "\t      9 | line nine\033[0m\n");
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output,
+        "\t  ..., email FROM users WHERE id = \033[1;31m[-1-]\033[0m\033[1;32m{+2+}\033[0m"
+        " AND active = 1 ORDER BY name\n");
+    char expected[256];
+    snprintf(expected, sizeof(expected), "The strings differ in more than %d lines, starting at line 1;"
+        " showing only the first changed lines.\n\t\033[1;31m-     1 | a0", UNIT_TEST_DIFF_MAX_EDITS);
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output, expected);
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output, "\t\033[1;32m+     1 | b0\033[0m\n");
+    free(output);
+}
+
+void test_unit_test_fail_fast_start(struct unit_test *test)
+{
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 1, 1);
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 1, 2);
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 3, 3);
+}
+
+void test_unit_test_fail_fast_body(void *arg)
+{
+    //start counting failed tests from this child's own
+    unit_test_failed_suites = 0;
+    unit_test_set_fail_fast(1, 1);
+    struct unit_test *aborted = unit_test_init("Fail Fast Aborted");
+    unit_test_start(aborted, &test_unit_test_fail_fast_start, NULL);
+    struct unit_test *skipped = unit_test_init("Fail Fast Skipped");
+    unit_test_start(skipped, &test_unit_test_start, NULL);
+    struct unit_test *forked = unit_test_init("Fail Fast Forked");
+    unit_test_start_forked(forked, &test_unit_test_start, NULL);
+    unit_test_set_fail_fast(0, 0);
+    printf("aborted: status %d, %lld passed, %lld failed\n", aborted->status, aborted->num_passed,
+        aborted->num_failed);
+    printf("skipped: status %d %d, %lld passed\n", skipped->status, forked->status,
+        skipped->num_passed + forked->num_passed);
+    unit_test_print_total_summary();
+}
+
+void test_unit_test_fail_fast(struct unit_test *test)
+{
+    char *output = capture_output(&test_unit_test_fail_fast_body, NULL);
+    char expected[256];
+    snprintf(expected, sizeof(expected), "aborted: status %d, 1 passed, 1 failed", UNIT_TEST_STATUS_ABORTED);
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output, expected);
+    snprintf(expected, sizeof(expected), "skipped: status %d %d, 0 passed", UNIT_TEST_STATUS_SKIPPED,
+        UNIT_TEST_STATUS_SKIPPED);
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output, expected);
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output,
+        "Aborted Fail Fast Aborted after its first failure.");
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output,
+        "Skipping Fail Fast Forked: 1 tests have already failed.");
+    snprintf(expected, sizeof(expected), "# of Tests Aborted: \033[1;31m%*d", 31, 1);
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output, expected);
+    snprintf(expected, sizeof(expected), "# of Tests Skipped: \033[1;33m%*d", 31, 2);
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output, expected);
+    snprintf(expected, sizeof(expected), "# of Assertions Failing: \033[1;31m%*d", 26, 1);
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output, expected);
+    free(output);
+}
+
+void test_unit_test_registered(struct unit_test *test)
+{
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 1, test->tier);
+}
+
+char schedule_order[64];
+
+void test_unit_test_schedule_start(struct unit_test *test)
+{
+    strcat(schedule_order, test->name);
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 1, 1);
+}
+
+void test_unit_test_schedule_body(void *arg)
+{
+    struct unit_test *later = unit_test_register("A", &test_unit_test_schedule_start, NULL);
+    struct unit_test *slow = unit_test_register("B", &test_unit_test_schedule_start, NULL);
+    struct unit_test *quick = unit_test_register("C", &test_unit_test_schedule_start, NULL);
+    struct unit_test *huge = unit_test_register("D", &test_unit_test_schedule_start, NULL);
+    unit_test_set_schedule(later, 2, NULL, 0.001);
+    unit_test_set_schedule(slow, 1, NULL, 0.5);
+    unit_test_set_schedule(quick, 1, NULL, 0.001);
+    unit_test_set_schedule(huge, 1, NULL, 100);
+    struct unit_test_run run = {.budget = 5.0};
+    unit_test_run_all(&run);
+    printf("order %s, status %d\n", schedule_order, huge->status);
+}
+
+void test_unit_test_schedule(struct unit_test *test)
+{
+    char *output = capture_output(&test_unit_test_schedule_body, NULL);
+    char expected[64];
+    snprintf(expected, sizeof(expected), "order CBA, status %d", UNIT_TEST_STATUS_OUT_OF_TIME);
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output, expected);
+    unit_test_assert_string_contains(test, __FILE__, __LINE__, output, "1 tests did not fit in the 5.00s time budget.");
+    free(output);
+}
+
+void test_unit_test_repeat(struct unit_test *test)
+{
+    unsigned long long seed = unit_test_seed();
+    unit_test_assert_long_equals(test, __FILE__, __LINE__, (long) seed, (long) unit_test_seed());
+}
+
+int async_sockets[2];
+
+void test_unit_test_async_reader(struct unit_test *test)
+{
+    char received = 0;
+    int ready = unit_test_await_fd(async_sockets[1], POLLIN, 1.0);
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, POLLIN, ready & POLLIN);
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 1, (int) read(async_sockets[1], &received, 1));
+    unit_test_assert_char_equals(test, __FILE__, __LINE__, 'x', received);
+}
+
+void test_unit_test_async_writer(struct unit_test *test)
+{
+    unit_test_await_sleep(0.01);
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 1, (int) write(async_sockets[0], "x", 1));
+}
+
+struct unit_test_mock *fetch_mock;
+
+long long mock_fetch(long long key)
+{
+    return unit_test_mock_record(fetch_mock, key, 0, 0, 0);
+}
+
+void test_unit_test_mock(struct unit_test *test)
+{
+    fetch_mock = unit_test_mock_init("fetch", 16);
+    unit_test_mock_returns(fetch_mock, 42);
+    long long (*fetch)(long long key) = &mock_fetch;
+    long long cached_key = -1;
+    long long cached_value = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        if (cached_key != 7)
+        {
+            cached_value = fetch(7);
+            cached_key = 7;
+        }
+    }
+    long long args[1] = {7};
+    unit_test_assert_mock_calls(test, __FILE__, __LINE__, fetch_mock, 0, 1000 / 1000);
+    unit_test_assert_mock_called_with(test, __FILE__, __LINE__, fetch_mock, -1, args, 1);
+    unit_test_assert_long_equals(test, __FILE__, __LINE__, 42L, (long) cached_value);
+    unit_test_mock_free(fetch_mock);
+}
+
+volatile long benchmark_sink = 0;
+
+void test_unit_test_benchmark_body(struct unit_test *test, long iteration)
+{
+    for (long i = 0; i < 100; i++)
+    {
+        benchmark_sink += i ^ iteration;
+    }
+}
+
+void test_unit_test_benchmark(struct unit_test *test)
+{
+    struct unit_test_benchmark options = {"xor sum", 20, 1000, 2, 1, 0, UNIT_TEST_CACHE_WARM, 0};
+    unit_test_benchmark(test, &test_unit_test_benchmark_body, &options);
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 20, test->benchmarks->samples);
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 1, test->benchmarks->min <= test->benchmarks->median);
+}
+
+void popcount_generate(void *input, long long index, unsigned long long seed)
+{
+    unsigned long long x = (index + 1) * 0x9e3779b97f4a7c15ULL ^ seed;
+    *(long *) input = (long) (x ^ (x >> 29));
+}
+
+void popcount_reference(const void *inputs, void *outputs, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        unsigned long x = ((const unsigned long *) inputs)[i];
+        int bits = 0;
+        for (; x != 0; x >>= 1)
+        {
+            bits += x & 1;
+        }
+        ((int *) outputs)[i] = bits;
+    }
+}
+
+void popcount_candidate(const void *inputs, void *outputs, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        unsigned long x = ((const unsigned long *) inputs)[i];
+        x = x - ((x >> 1) & 0x5555555555555555UL);
+        x = (x & 0x3333333333333333UL) + ((x >> 2) & 0x3333333333333333UL);
+        x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fUL;
+        ((int *) outputs)[i] = (int) ((x * 0x0101010101010101UL) >> 56);
+    }
+}
+
+void test_unit_test_differential(struct unit_test *test)
+{
+    struct unit_test_differential options = {"popcount", UNIT_TEST_ELEMENT_LONG, 1, UNIT_TEST_ELEMENT_INT, 1,
+        &popcount_generate, &popcount_reference, &popcount_candidate, 100000, 0, 0, 42};
+    unit_test_assert_differential(test, __FILE__, __LINE__, &options);
+    unit_test_assert_long_equals(test, __FILE__, __LINE__, 100000L, (long) test->differentials->inputs);
+}
+
+void test_unit_test_histogram_operation(void *arg, long call)
+{
+    benchmark_sink += call;
+}
+
+void test_unit_test_histogram(struct unit_test *test)
+{
+    struct unit_test_histogram *histogram = unit_test_histogram_init(test, "1..1000us");
+    for (long long i = 1; i <= 1000; i++)
+    {
+        unit_test_histogram_record(histogram, i * 1000);
+    }
+    unit_test_assert_percentile(test, __FILE__, __LINE__, histogram, 50, 505);
+    unit_test_assert_percentile(test, __FILE__, __LINE__, histogram, 99, 1000);
+    unit_test_assert_percentile(test, __FILE__, __LINE__, histogram, 100, 1000);
+    unit_test_assert_long_equals(test, __FILE__, __LINE__, 255L, (long) unit_test_histogram_highest(
+        unit_test_histogram_index(255)));
+    unit_test_assert_long_equals(test, __FILE__, __LINE__, 1L << 39, (long) (unit_test_histogram_highest(
+        unit_test_histogram_index(1LL << 39)) & -(1L << 39)));
+    struct unit_test_histogram *measured = unit_test_histogram_init(test, "add");
+    unit_test_histogram_measure(measured, &test_unit_test_histogram_operation, NULL, 10000);
+    unit_test_assert_percentile(test, __FILE__, __LINE__, measured, 50, 1000);
+}
+
+struct stream_pattern {
+    long long position;
+    long long length;
+};
+
+long long stream_pattern_read(void *source, void *buffer, size_t size)
+{
+    struct stream_pattern *pattern = source;
+    size_t count = 0;
+    for (; count < size && pattern->position < pattern->length; count++, pattern->position++)
+    {
+        ((unsigned char *) buffer)[count] = (unsigned char) (pattern->position * 31 >> 3);
+    }
+    return (long long) count;
+}
+
+void test_unit_test_stream(struct unit_test *test)
+{
+    struct stream_pattern produced = {0, 3000000};
+    struct stream_pattern written = {0, 3000000};
+    FILE *file = tmpfile();
+    char chunk[4096];
+    long long length;
+    while ((length = stream_pattern_read(&written, chunk, sizeof(chunk))) > 0)
+    {
+        fwrite(chunk, 1, length, file);
+    }
+    rewind(file);
+    struct unit_test_stream expected = unit_test_stream_callback("pattern", &stream_pattern_read, &produced);
+    struct unit_test_stream actual = unit_test_stream_file("file", file);
+    unit_test_assert_stream_equals(test, __FILE__, __LINE__, &expected, &actual, 65536);
+    unit_test_assert_long_equals(test, __FILE__, __LINE__, 3000000L, (long) test->streams->bytes);
+
+    rewind(file);
+    struct unit_test_stream fd = unit_test_stream_fd("fd", fileno(file));
+    struct stream_pattern again = {0, 3000000};
+    expected = unit_test_stream_callback("pattern", &stream_pattern_read, &again);
+    unit_test_assert_stream_equals(test, __FILE__, __LINE__, &expected, &fd, 0);
+    fclose(file);
+}
+
+void test_unit_test_files(struct unit_test *test)
+{
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 1, 1);
+    unit_test_assert_int_equals(test, __FILE__, __LINE__, 1, test->file_count);
+    unit_test_assert_string_equals(test, __FILE__, __LINE__, __FILE__, test->files[0]);
+}
+
 void test_unit_test_inline()
 {
     int a = 1;
@@ -58,7 +635,103 @@ int main()
 
     struct unit_test *arraytest = unit_test_init("Test Unit Test Arrays");
     unit_test_start(arraytest, &test_unit_test_arrays, NULL);
+
+    struct unit_test *threadtest = unit_test_init("Test Unit Test Threads");
+    unit_test_start(threadtest, &test_unit_test_threads, NULL);
+
+    struct unit_test *stresstest = unit_test_init("Test Unit Test Stress");
+    unit_test_start(stresstest, &test_unit_test_stress, NULL);
+
+    shared_fixture = unit_test_fixture_init("Test Fixture", &test_unit_test_fixture_setup,
+        &test_unit_test_fixture_teardown);
+    struct unit_test *fixturetest1 = unit_test_init("Test Unit Test Fixture 1");
+    struct unit_test *fixturetest2 = unit_test_init("Test Unit Test Fixture 2");
+    unit_test_use_fixture(fixturetest1, shared_fixture);
+    unit_test_use_fixture(fixturetest2, shared_fixture);
+    unit_test_start(fixturetest1, &test_unit_test_fixture, NULL);
+    unit_test_start(fixturetest2, &test_unit_test_fixture, NULL);
+
+    snapshot_fixture = unit_test_fixture_init_snapshot("Test Snapshot", NULL, 4096,
+        &test_unit_test_snapshot_build);
+    struct unit_test *forkedtest1 = unit_test_init("Test Unit Test Forked 1");
+    struct unit_test *forkedtest2 = unit_test_init("Test Unit Test Forked 2");
+    unit_test_use_fixture(forkedtest1, snapshot_fixture);
+    unit_test_use_fixture(forkedtest2, snapshot_fixture);
+    unit_test_start_forked(forkedtest1, &test_unit_test_forked, NULL);
+    unit_test_start_forked(forkedtest2, &test_unit_test_forked, NULL);
+
+    unit_test_set_async_reporting(1);
+    struct unit_test *asynctest = unit_test_init("Test Unit Test Async");
+    unit_test_start(asynctest, &test_unit_test_async, NULL);
+    unit_test_set_async_reporting(0);
+
+    unit_test_set_bulk_mode(3);
+    struct unit_test *bulktest = unit_test_init("Test Unit Test Bulk");
+    unit_test_start(bulktest, &test_unit_test_bulk, NULL);
+    unit_test_set_bulk_mode(0);
+
+    struct unit_test *unorderedtest = unit_test_init("Test Unit Test Unordered");
+    unit_test_start(unorderedtest, &test_unit_test_unordered, NULL);
+
+    struct unit_test *unorderedfailurestest = unit_test_init("Test Unit Test Unordered Failures");
+    unit_test_start(unorderedfailurestest, &test_unit_test_unordered_failures, NULL);
+
+    struct unit_test *stringtest = unit_test_init("Test Unit Test Strings");
+    unit_test_start(stringtest, &test_unit_test_strings, NULL);
+
+    struct unit_test *stringfailurestest = unit_test_init("Test Unit Test String Failures");
+    unit_test_start(stringfailurestest, &test_unit_test_string_failures, NULL);
+
+    struct unit_test *deathtest = unit_test_init("Test Unit Test Death");
+    unit_test_start(deathtest, &test_unit_test_death, NULL);
+
+    struct unit_test *crashtest = unit_test_init("Test Unit Test Crash Recovery");
+    unit_test_start(crashtest, &test_unit_test_crash, NULL);
+
+    struct unit_test *failfasttest = unit_test_init("Test Unit Test Fail Fast");
+    unit_test_start(failfasttest, &test_unit_test_fail_fast, NULL);
     
+    struct unit_test *scheduletest = unit_test_init("Test Unit Test Schedule");
+    unit_test_start(scheduletest, &test_unit_test_schedule, NULL);
+
+    struct unit_test *registeredtest = unit_test_register("Test Unit Test Registered",
+        &test_unit_test_registered, NULL);
+    unit_test_set_schedule(registeredtest, 1, "core", 1.0);
+    struct unit_test_run run = {60.0, 1, "core", NULL, 2};
+    unit_test_run_all(&run);
+
+    struct unit_test *repeattest = unit_test_init("Test Unit Test Repeat");
+    unit_test_start(repeattest, &test_unit_test_repeat, NULL);
+    struct unit_test_repeat repeat = {200, 1, 2, 0};
+    unit_test_repeat(repeattest, &repeat);
+
+    socketpair(AF_UNIX, SOCK_STREAM, 0, async_sockets);
+    struct unit_test *readertest = unit_test_init("Test Unit Test Async Reader");
+    struct unit_test *writertest = unit_test_init("Test Unit Test Async Writer");
+    unit_test_start_async(readertest, &test_unit_test_async_reader, NULL, 2.0);
+    unit_test_start_async(writertest, &test_unit_test_async_writer, NULL, 2.0);
+    unit_test_run_async();
+    close(async_sockets[0]);
+    close(async_sockets[1]);
+
+    struct unit_test *mocktest = unit_test_init("Test Unit Test Mock");
+    unit_test_start(mocktest, &test_unit_test_mock, NULL);
+
+    struct unit_test *benchmarktest = unit_test_init("Test Unit Test Benchmark");
+    unit_test_start(benchmarktest, &test_unit_test_benchmark, NULL);
+
+    struct unit_test *histogramtest = unit_test_init("Test Unit Test Histogram");
+    unit_test_start(histogramtest, &test_unit_test_histogram, NULL);
+
+    struct unit_test *streamtest = unit_test_init("Test Unit Test Stream");
+    unit_test_start(streamtest, &test_unit_test_stream, NULL);
+
+    struct unit_test *filestest = unit_test_init("Test Unit Test Files");
+    unit_test_start(filestest, &test_unit_test_files, NULL);
+
+    struct unit_test *differentialtest = unit_test_init("Test Unit Test Differential");
+    unit_test_start(differentialtest, &test_unit_test_differential, NULL);
+
     unit_test_print_total_summary();
 
 }